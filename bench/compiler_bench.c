@@ -0,0 +1,473 @@
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ast.h"
+#include "lexer_scan.h"
+#include "logger.h"
+#include "refac_lexer.h"
+#include "refac_parser.h"
+#include "safer.h"
+#include "stdlib_table.h"
+
+/**
+ * Microbenchmarks of the compiler subsystems, run in isolation on the bundled samples and on the
+ * synthetic corpus of `jack_gen`.
+ *
+ * usage: compiler_bench [--iterations N] [--warmup N] [--filter name] [dir...]
+ *
+ * Every benchmark runs `warmup` untimed iterations and `iterations` timed ones, and reports the median
+ * and 95th percentile of an iteration together with the throughput at the median. Only the measured call
+ * is timed, the setup of every iteration (copying sources, lexing before parsing, ...) is not.
+ */
+
+#ifndef BENCH_CORPUS_DIR
+    #define BENCH_CORPUS_DIR "./jack_corpus"
+#endif
+
+#define BENCH_ARENA_PAGES 256
+#define LOOKUP_REPEAT 100
+#define LABELS_PER_ITERATION 10000
+#define EMITS_PER_ITERATION 10000
+
+static const char* label_prefixes[] = {"IF_TRUE", "IF_FALSE", "IF_END", "WHILE_START", "WHILE_END"};
+
+typedef struct {
+    const char* name;
+    size_t num_files;
+    char** paths;
+    char** sources;
+    size_t num_bytes;
+    size_t num_tokens;
+    size_t num_nodes;
+
+    // Parsed and analyzed once, shared by the lookup and codegen benchmarks
+    Arena* arena;
+    ASTPool** classes;
+    SymbolTable* global_table;
+    SymbolTable** lookup_tables;
+    Atom* lookup_names;
+    size_t num_lookups;
+} BenchInput;
+
+// Work done by one iteration, turned into throughput
+typedef struct {
+    size_t bytes;
+    size_t tokens;
+    size_t nodes;
+    size_t ops;
+} BenchWork;
+
+typedef double (*BenchFn)(BenchInput* input, BenchWork* work);
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*) a;
+    double y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+static int compare_strings(const void* a, const void* b) {
+    return strcmp(*(const char* const*) a, *(const char* const*) b);
+}
+
+static Atom class_name_of(const ASTPool* pool) {
+    return ast_node(pool, pool->root)->data.classDec.className;
+}
+
+// The lookup names are collected as atoms in the pointer slots of a vector
+static void push_name(vector names, Atom name) {
+    vector_push(names, (void*) (uintptr_t) name);
+}
+
+static Atom get_name(vector names, int index) {
+    return (Atom) (uintptr_t) vector_get(names, index);
+}
+
+/**
+ * @brief Load every .jack file of `dir`, in name order so runs are comparable.
+ */
+static BenchInput* load_input(const char* name, const char* dir) {
+    DIR* handle = opendir(dir);
+    if (!handle) {
+        fprintf(stderr, "compiler_bench: skipping '%s', cannot open it\n", dir);
+        return NULL;
+    }
+
+    vector paths = vector_create();
+    struct dirent* de;
+    while ((de = readdir(handle)) != NULL) {
+        size_t len = strlen(de->d_name);
+        if (len > 5 && strcmp(de->d_name + len - 5, ".jack") == 0) {
+            size_t path_len = strlen(dir) + len + 2;
+            char* path = safer_malloc(path_len);
+            snprintf(path, path_len, "%s/%s", dir, de->d_name);
+            vector_push(paths, path);
+        }
+    }
+    closedir(handle);
+
+    BenchInput* input = calloc(1, sizeof(BenchInput));
+    input->name = name;
+    input->num_files = vector_size(paths);
+    input->paths = safer_malloc(sizeof(char*) * (input->num_files + 1));
+    input->sources = safer_malloc(sizeof(char*) * (input->num_files + 1));
+    for (size_t i = 0; i < input->num_files; ++i) {
+        input->paths[i] = vector_get(paths, (int) i);
+    }
+    vector_destroy(paths);
+    qsort(input->paths, input->num_files, sizeof(char*), compare_strings);
+
+    for (size_t i = 0; i < input->num_files; ++i) {
+        input->sources[i] = read_file_into_string(input->paths[i]);
+        input->num_bytes += strlen(input->sources[i]);
+    }
+    return input;
+}
+
+/**
+ * @brief Parse, build and analyze the input once, and pick the names the lookup benchmark resolves :
+ * from every subroutine scope, its first local or argument, the first field of its class, and a class name.
+ */
+static void prepare_input(BenchInput* input) {
+    input->arena = init_arena(BENCH_ARENA_PAGES);
+    input->classes = safer_malloc(sizeof(ASTPool*) * (input->num_files + 1));
+    input->global_table = create_table(SCOPE_GLOBAL, NULL, input->arena);
+    add_stdlib_table(input->global_table, stdlib_classes, stdlib_num_classes);
+
+    size_t nodes_before = ast_nodes_created();
+    for (size_t i = 0; i < input->num_files; ++i) {
+        Lexer* lexer = init_lexer_from_string(input->paths[i], strdup(input->sources[i]), input->arena);
+        input->num_tokens += queue_size(lexer->queue);
+        Parser* parser = init_parser(lexer->queue, input->arena);
+        input->classes[i] = parse_class(parser);
+        destroy_lexer(lexer);
+    }
+    input->num_nodes = ast_nodes_created() - nodes_before;
+
+    ASTVisitor* visitor = init_ast_visitor(input->arena, BUILD, input->global_table);
+    for (size_t i = 0; i < input->num_files; ++i) {
+        ast_class_accept(visitor, input->classes[i]);
+    }
+    visitor->phase = ANALYZE;
+    for (size_t i = 0; i < input->num_files; ++i) {
+        ast_class_accept(visitor, input->classes[i]);
+    }
+    destroy_ast_visitor(visitor);
+    if (error_count() > 0) {
+        fprintf(stderr, "compiler_bench: '%s' has %d errors, codegen results are not representative\n",
+                input->name, error_count());
+        clear_errors();
+    }
+
+    vector tables = vector_create();
+    vector names = vector_create();
+    for (size_t i = 0; i < input->num_files; ++i) {
+        Atom class_name = class_name_of(input->classes[i]);
+        Symbol* class_symbol = symbol_table_lookup(input->global_table, class_name, LOOKUP_LOCAL);
+        SymbolTable* class_table = class_symbol->childTable;
+        for (int j = 0; j < vector_size(class_table->symbols); ++j) {
+            Symbol* symbol = vector_get(class_table->symbols, j);
+            if (!symbol->childTable) {
+                continue;
+            }
+            SymbolTable* sub_table = symbol->childTable;
+            if (vector_size(sub_table->symbols) > 0) {
+                vector_push(tables, sub_table);
+                push_name(names, ((Symbol*) vector_get(sub_table->symbols, 0))->name);
+            }
+            if (vector_size(class_table->symbols) > 0) {
+                vector_push(tables, sub_table);
+                push_name(names, ((Symbol*) vector_get(class_table->symbols, 0))->name);
+            }
+            vector_push(tables, sub_table);
+            push_name(names, class_name_of(input->classes[(i + j) % input->num_files]));
+        }
+    }
+
+    input->num_lookups = vector_size(names);
+    input->lookup_tables = safer_malloc(sizeof(SymbolTable*) * (input->num_lookups + 1));
+    input->lookup_names = safer_malloc(sizeof(Atom) * (input->num_lookups + 1));
+    for (size_t i = 0; i < input->num_lookups; ++i) {
+        input->lookup_tables[i] = vector_get(tables, (int) i);
+        input->lookup_names[i] = get_name(names, (int) i);
+    }
+    vector_destroy(tables);
+    vector_destroy(names);
+}
+
+static double bench_lex(BenchInput* input, BenchWork* work) {
+    Arena* arena = init_arena(BENCH_ARENA_PAGES);
+    char** copies = safer_malloc(sizeof(char*) * (input->num_files + 1));
+    Lexer** lexers = safer_malloc(sizeof(Lexer*) * (input->num_files + 1));
+    for (size_t i = 0; i < input->num_files; ++i) {
+        copies[i] = strdup(input->sources[i]);
+    }
+
+    double start = now_seconds();
+    for (size_t i = 0; i < input->num_files; ++i) {
+        lexers[i] = init_lexer_from_string(input->paths[i], copies[i], arena);
+    }
+    double elapsed = now_seconds() - start;
+
+    for (size_t i = 0; i < input->num_files; ++i) {
+        work->tokens += queue_size(lexers[i]->queue);
+        destroy_lexer(lexers[i]);
+    }
+    work->bytes = input->num_bytes;
+    free(lexers);
+    free(copies);
+    destroy_arena(arena);
+    return elapsed;
+}
+
+// The lexer with the scalar scan kernels, `lex` uses the widest ones the CPU has
+static double bench_lex_scalar(BenchInput* input, BenchWork* work) {
+    use_scan_kernel(SCAN_KERNEL_SCALAR);
+    double elapsed = bench_lex(input, work);
+    use_scan_kernel(best_scan_kernel());
+    return elapsed;
+}
+
+// The table driven reference lexer, `lex` runs the generated direct coded one
+static double bench_lex_table(BenchInput* input, BenchWork* work) {
+    use_lexer_mode(LEXER_MODE_TABLE);
+    double elapsed = bench_lex(input, work);
+    use_lexer_mode(LEXER_MODE_DIRECT);
+    return elapsed;
+}
+
+static double bench_parse(BenchInput* input, BenchWork* work) {
+    Arena* arena = init_arena(BENCH_ARENA_PAGES);
+    double elapsed = 0;
+    for (size_t i = 0; i < input->num_files; ++i) {
+        Lexer* lexer = init_lexer_from_string(input->paths[i], strdup(input->sources[i]), arena);
+        Parser* parser = init_parser(lexer->queue, arena);
+        work->tokens += queue_size(lexer->queue);
+
+        size_t nodes_before = ast_nodes_created();
+        double start = now_seconds();
+        (void) parse_class(parser);
+        elapsed += now_seconds() - start;
+        work->nodes += ast_nodes_created() - nodes_before;
+
+        destroy_lexer(lexer);
+    }
+    work->bytes = input->num_bytes;
+    destroy_arena(arena);
+    return elapsed;
+}
+
+static double bench_lookup(BenchInput* input, BenchWork* work) {
+    size_t found = 0;
+    double start = now_seconds();
+    for (int repeat = 0; repeat < LOOKUP_REPEAT; ++repeat) {
+        for (size_t i = 0; i < input->num_lookups; ++i) {
+            found += symbol_table_lookup(input->lookup_tables[i], input->lookup_names[i], LOOKUP_GLOBAL) != NULL;
+        }
+    }
+    double elapsed = now_seconds() - start;
+    if (found != input->num_lookups * LOOKUP_REPEAT) {
+        fprintf(stderr, "compiler_bench: %zu lookups failed\n", input->num_lookups * LOOKUP_REPEAT - found);
+    }
+    work->ops = input->num_lookups * LOOKUP_REPEAT;
+    return elapsed;
+}
+
+static double bench_labels(BenchInput* input, BenchWork* work) {
+    (void) input;
+    Arena* arena = init_arena(BENCH_ARENA_PAGES);
+    ASTVisitor* visitor = init_ast_visitor(arena, GENERATE, NULL);
+    size_t num_prefixes = sizeof(label_prefixes) / sizeof(label_prefixes[0]);
+
+    double start = now_seconds();
+    for (int i = 0; i < LABELS_PER_ITERATION; ++i) {
+        generate_unique_label(visitor, label_prefixes[i % num_prefixes]);
+    }
+    double elapsed = now_seconds() - start;
+
+    work->ops = LABELS_PER_ITERATION;
+    destroy_ast_visitor(visitor);
+    destroy_arena(arena);
+    return elapsed;
+}
+
+static double bench_emit(BenchInput* input, BenchWork* work) {
+    (void) input;
+    FILE* out = fopen("/dev/null", "w");
+    char label[] = "WHILE_START_0";
+    char function[] = "Bench.function";
+
+    double start = now_seconds();
+    for (int i = 0; i < EMITS_PER_ITERATION; ++i) {
+        write_function(out, function, i & 7);
+        write_push(out, SEG_ARG, i & 3);
+        write_push(out, SEG_CONST, i);
+        write_arithmetic(out, COM_ADD);
+        write_pop(out, SEG_LOCAL, i & 7);
+        write_label(out, label);
+        write_if(out, label);
+        write_goto(out, label);
+        write_call(out, function, 2);
+        write_return(out);
+    }
+    fflush(out);
+    double elapsed = now_seconds() - start;
+
+    work->ops = EMITS_PER_ITERATION * 10;
+    fclose(out);
+    return elapsed;
+}
+
+static double bench_codegen(BenchInput* input, BenchWork* work) {
+    FILE* out = fopen("/dev/null", "w");
+    double elapsed = 0;
+    for (size_t i = 0; i < input->num_files; ++i) {
+        Arena* arena = init_arena(BENCH_ARENA_PAGES);
+        ASTVisitor* visitor = init_ast_visitor(arena, GENERATE, input->global_table);
+        visitor->vmFile = out;
+
+        double start = now_seconds();
+        ast_class_accept(visitor, input->classes[i]);
+        fflush(out);
+        elapsed += now_seconds() - start;
+
+        destroy_ast_visitor(visitor);
+        destroy_arena(arena);
+    }
+    work->nodes = input->num_nodes;
+    fclose(out);
+    return elapsed;
+}
+
+static void print_rate(double amount, double seconds, const char* unit) {
+    if (amount <= 0 || seconds <= 0) {
+        printf(" %14s", "-");
+    } else {
+        printf(" %9.2f %-4s", amount / seconds / 1e6, unit);
+    }
+}
+
+static void run_benchmark(const char* name, BenchFn fn, BenchInput* input, int warmup, int iterations) {
+    BenchWork work = {0};
+    for (int i = 0; i < warmup; ++i) {
+        BenchWork ignored = {0};
+        fn(input, &ignored);
+    }
+
+    double* samples = safer_malloc(sizeof(double) * (size_t) iterations);
+    for (int i = 0; i < iterations; ++i) {
+        memset(&work, 0, sizeof(work));
+        samples[i] = fn(input, &work);
+    }
+    qsort(samples, (size_t) iterations, sizeof(double), compare_doubles);
+    double median = samples[iterations / 2];
+    double p95 = samples[(size_t) ((iterations - 1) * 0.95)];
+
+    printf("%-10s %-10s %11.3f %11.3f", name, input->name, median * 1e3, p95 * 1e3);
+    print_rate((double) work.bytes, median, "MB/s");
+    print_rate((double) work.tokens, median, "Mt/s");
+    print_rate((double) work.nodes, median, "Mn/s");
+    print_rate((double) work.ops, median, "Mop/s");
+    printf("\n");
+    free(samples);
+}
+
+static void print_usage(const char* prog) {
+    fprintf(stderr, "usage: %s [--iterations N] [--warmup N] [--filter name] [dir...]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    int iterations = 20;
+    int warmup = 3;
+    const char* filter = NULL;
+    vector inputs = vector_create();
+
+    initialize_eq_classes();
+    initialize_logger_arena();
+    current_log_level = LOG_LEVEL_ERROR;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (argv[i][0] != '-') {
+            BenchInput* input = load_input(get_filename_from_path(argv[i]), argv[i]);
+            if (input) {
+                vector_push(inputs, input);
+            }
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    if (vector_size(inputs) == 0) {
+        const char* names[] = {"Pong", "Square"};
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+            char dir[1024];
+            snprintf(dir, sizeof(dir), "%s/%s", JACK_FILES_DIR, names[i]);
+            BenchInput* input = load_input(names[i], dir);
+            if (input) {
+                vector_push(inputs, input);
+            }
+        }
+        BenchInput* corpus = load_input("synthetic", BENCH_CORPUS_DIR);
+        if (corpus) {
+            vector_push(inputs, corpus);
+        }
+    }
+
+    struct {
+        const char* name;
+        BenchFn fn;
+        bool per_input;
+    } benchmarks[] = {
+        {"lex", bench_lex, true},
+        {"lex-scalar", bench_lex_scalar, true},
+        {"lex-table", bench_lex_table, true},
+        {"parse", bench_parse, true},
+        {"lookup", bench_lookup, true},
+        {"codegen", bench_codegen, true},
+        // Do not read the input, run once
+        {"label", bench_labels, false},
+        {"emit", bench_emit, false},
+    };
+    size_t num_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+    printf("# scan kernels : %s\n", scan_kernel_name(best_scan_kernel()));
+    printf("%-10s %-10s %11s %11s %14s %14s %14s %14s\n", "bench", "input", "median(ms)", "p95(ms)", "bytes",
+           "tokens", "nodes", "ops");
+    for (int i = 0; i < vector_size(inputs); ++i) {
+        BenchInput* input = vector_get(inputs, i);
+        prepare_input(input);
+        printf("# %s : %zu files, %zu bytes, %zu tokens, %zu nodes\n", input->name, input->num_files,
+               input->num_bytes, input->num_tokens, input->num_nodes);
+        for (size_t b = 0; b < num_benchmarks; ++b) {
+            if (benchmarks[b].per_input && (!filter || strstr(benchmarks[b].name, filter))) {
+                run_benchmark(benchmarks[b].name, benchmarks[b].fn, input, warmup, iterations);
+            }
+        }
+    }
+
+    BenchInput no_input = {.name = "-"};
+    printf("# code generator helpers, independent of the inputs\n");
+    for (size_t b = 0; b < num_benchmarks; ++b) {
+        if (!benchmarks[b].per_input && (!filter || strstr(benchmarks[b].name, filter))) {
+            run_benchmark(benchmarks[b].name, benchmarks[b].fn, &no_input, warmup, iterations);
+        }
+    }
+    return EXIT_SUCCESS;
+}
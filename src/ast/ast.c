@@ -95,7 +95,8 @@ ASTVisitor* init_ast_visitor(Arena* arena, Phase initialPhase, SymbolTable* glob
 
     visitor->currentTable = globalTable;
     visitor->phase = initialPhase;
-    visitor->currentClassName = NULL;
+    visitor->currentClassName = ATOM_NONE;
+    visitor->pool = NULL;
     visitor->vmFile = NULL;
     visitor->arena = arena;
     visitor->labelCounters = vector_create();
@@ -103,280 +104,26 @@ ASTVisitor* init_ast_visitor(Arena* arena, Phase initialPhase, SymbolTable* glob
     return visitor;
 }
 
-ASTNode* init_ast_node(ASTNodeType type, Arena* arena) {
-    ASTNode* node = (ASTNode*) arena_alloc(arena, sizeof(ASTNode));
-    node->nodeType = type;
-
-    switch (type) {
-        case NODE_PROGRAM:
-            node->data.program = (ProgramNode*) arena_alloc(arena,sizeof(ProgramNode));
-            node->data.program->classes = vector_create();
-            break;
-        case NODE_CLASS:
-            node->data.classDec = (ClassNode*) arena_alloc(arena,sizeof(ClassNode));
-            node->data.classDec->className = NULL;
-            node->data.classDec->classVarDecs = vector_create();
-            node->data.classDec->subroutineDecs = vector_create();
-            break;
-        case NODE_CLASS_VAR_DEC:
-            node->data.classVarDec = (ClassVarDecNode*) arena_alloc(arena,sizeof(ClassVarDecNode));
-            node->data.classVarDec->classVarModifier = CVAR_NONE;
-            node->data.classVarDec->varType = NULL;
-            node->data.classVarDec->varNames = vector_create();
-            break;
-        case NODE_SUBROUTINE_DEC:
-            node->data.subroutineDec = (SubroutineDecNode*) arena_alloc(arena,sizeof(SubroutineDecNode));
-            node->data.subroutineDec->subroutineType = SUB_NONE;
-            node->data.subroutineDec->returnType = NULL;
-            node->data.subroutineDec->subroutineName = NULL;
-            node->data.subroutineDec->parameters = NULL;
-            node->data.subroutineDec->body = NULL;
-            break;
-        case NODE_PARAMETER_LIST:
-            node->data.parameterList =  (ParameterListNode*) arena_alloc(arena,sizeof(ParameterListNode));
-            node->data.parameterList->parameterTypes = vector_create();
-            node->data.parameterList->parameterNames = vector_create();
-            break;
-        case NODE_SUBROUTINE_BODY:
-            node->data.subroutineBody = (SubroutineBodyNode*) arena_alloc(arena,sizeof(SubroutineBodyNode));
-            node->data.subroutineBody->varDecs = vector_create();
-            node->data.subroutineBody->statements = NULL;
-            break;
-        case NODE_VAR_DEC:
-            node->data.varDec = (VarDecNode*) arena_alloc(arena,sizeof(VarDecNode));
-            node->data.varDec->varType = NULL;
-            node->data.varDec->varNames = vector_create();
-            break;
-        case NODE_STATEMENTS:
-            node->data.statements = (StatementsNode*) arena_alloc(arena,sizeof(StatementsNode));
-            node->data.statements->statements = vector_create();
-            break;
-        case NODE_STATEMENT:
-            node->data.statement = (StatementNode*) arena_alloc(arena,sizeof(StatementNode));
-            node->data.statement->statementType = STMT_NONE;
-            node->data.statement->data.letStatement = NULL;
-            node->data.statement->data.ifStatement = NULL;
-            node->data.statement->data.whileStatement = NULL;
-            node->data.statement->data.doStatement = NULL;
-            node->data.statement->data.returnStatement = NULL;
-            break;
-        case NODE_LET_STATEMENT:
-            node->data.letStatement = (LetStatementNode*) arena_alloc(arena,sizeof(LetStatementNode));
-            node->data.letStatement->varName = NULL;
-            node->data.letStatement->indexExpression = NULL;
-            node->data.letStatement->rightExpression = NULL;
-            break;
-        case NODE_IF_STATEMENT:
-            node->data.ifStatement = (IfStatementNode*) arena_alloc(arena,sizeof(IfStatementNode));
-            node->data.ifStatement->condition = NULL;
-            node->data.ifStatement->ifBranch = NULL;
-            node->data.ifStatement->elseBranch = NULL;
-            break;
-        case NODE_WHILE_STATEMENT:
-            node->data.whileStatement = (WhileStatementNode*) arena_alloc(arena,sizeof(WhileStatementNode));
-            node->data.whileStatement->condition = NULL;
-            node->data.whileStatement->body = NULL;
-            break;
-        case NODE_DO_STATEMENT:
-            node->data.doStatement = (DoStatementNode*) arena_alloc(arena,sizeof(DoStatementNode));
-            node->data.doStatement->subroutineCall = NULL;
-            break;
-        case NODE_RETURN_STATEMENT:
-            node->data.returnStatement = (ReturnStatementNode*) arena_alloc(arena,sizeof(ReturnStatementNode));
-            node->data.returnStatement->expression = NULL;
-            break;
-        case NODE_SUBROUTINE_CALL:
-            node->data.subroutineCall = (SubroutineCallNode*) arena_alloc(arena,sizeof(SubroutineCallNode));
-            node->data.subroutineCall->caller = NULL;
-            node->data.subroutineCall->subroutineName = NULL;
-            node->data.subroutineCall->arguments = vector_create();
-            node->data.subroutineCall->type = (Type*) arena_alloc(arena, sizeof (Type));
-            break;
-        case NODE_EXPRESSION:
-            node->data.expression = (ExpressionNode*) arena_alloc(arena,sizeof(ExpressionNode));
-            node->data.expression->term = NULL;
-            node->data.expression->operations = vector_create();
-            node->data.expression->type = (Type*) arena_alloc(arena, sizeof (Type));
-            break;
-        case NODE_TERM:
-            node->data.term = (TermNode*) arena_alloc(arena,sizeof(TermNode));
-            node->data.term->termType = TRM_NONE;
-            node->data.term->type = (Type*) arena_alloc(arena, sizeof (Type));
-            break;
-        case NODE_OPERATION:
-            node->data.operation =  (Operation*) arena_alloc(arena,sizeof(Operation));
-            node->data.operation->op = 0;
-            node->data.operation->term = NULL;
-            break;
-        case NODE_VAR_TERM:
-            node->data.varTerm = (VarTerm*) arena_alloc(arena,sizeof(VarTerm));
-            node->data.varTerm->className = NULL;
-            node->data.varTerm->varName = NULL;
-            node->data.varTerm->type = (Type*) arena_alloc(arena, sizeof (Type));
-            break;
-        default:
-            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_UNKNOWN_NODE_TYPE, __FILE__, __LINE__,
-                            "['%s'] : Unknown node type: %d\n", __func__, type);
-            return NULL;
+/**
+ * The visitor itself lives in its arena, only the label counter list is heap allocated.
+ */
+void destroy_ast_visitor(ASTVisitor* visitor) {
+    if (visitor != NULL) {
+        vector_destroy(visitor->labelCounters);
     }
-    return node;
 }
 
-
-void destroy_ast_node(ASTNode* node) {
-    if (node != NULL) {
-        switch (node->nodeType) {
-            case NODE_PROGRAM:
-                for (int i  = 0 ; i < vector_size(node->data.program->classes); ++i) {
-                    destroy_ast_node((ASTNode*) vector_get(node->data.program->classes, i));
-                }
-                vector_destroy(node->data.program->classes);
-                break;
-            case NODE_CLASS:
-                for (int i = 0; i < vector_size(node->data.classDec->classVarDecs); ++i) {
-                    destroy_ast_node((ASTNode*)vector_get(node->data.classDec->classVarDecs, i));
-                }
-                vector_destroy(node->data.classDec->classVarDecs);
-
-                for (int i = 0; i < vector_size(node->data.classDec->subroutineDecs); ++i) {
-                    destroy_ast_node((ASTNode*)vector_get(node->data.classDec->subroutineDecs, i));
-                }
-                vector_destroy(node->data.classDec->subroutineDecs);
-                break;
-            case NODE_CLASS_VAR_DEC:
-                vector_destroy(node->data.classVarDec->varNames);
-                break;
-            case NODE_SUBROUTINE_DEC:
-                destroy_ast_node(node->data.subroutineDec->parameters);
-                destroy_ast_node(node->data.subroutineDec->body);
-                break;
-            case NODE_PARAMETER_LIST:
-                vector_destroy(node->data.parameterList->parameterTypes);
-                vector_destroy(node->data.parameterList->parameterNames);
-                break;
-            case NODE_SUBROUTINE_BODY:
-                for (int i = 0; i < vector_size(node->data.subroutineBody->varDecs); ++i) {
-                    destroy_ast_node((ASTNode*)vector_get(node->data.subroutineBody->varDecs, i));
-                }
-                vector_destroy(node->data.subroutineBody->varDecs);
-                destroy_ast_node(node->data.subroutineBody->statements);
-                break;
-            case NODE_VAR_DEC:
-                vector_destroy(node->data.varDec->varNames);
-                break;
-            case NODE_STATEMENTS:
-                for (int i = 0; i < vector_size(node->data.statements->statements); ++i) {
-                    destroy_ast_node((ASTNode*)vector_get(node->data.statements->statements, i));
-                }
-                vector_destroy(node->data.statements->statements);
-                break;
-            case NODE_STATEMENT:
-                switch (node->data.statement->statementType) {
-                    case LET:
-                        destroy_ast_node(node->data.statement->data.letStatement);
-                        break;
-                    case IF:
-                        destroy_ast_node(node->data.statement->data.ifStatement);
-                        break;
-                    case WHILE:
-                        destroy_ast_node(node->data.statement->data.whileStatement);
-                        break;
-                    case DO:
-                        destroy_ast_node(node->data.statement->data.doStatement);
-                        break;
-                    case RETURN:
-                        destroy_ast_node(node->data.statement->data.returnStatement);
-                        break;
-                    default:
-                        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_UNKNOWN_NODE_TYPE, __FILE__, __LINE__,
-                            "['%s'] : Unknown node type: %d\n", __func__, node->nodeType);
-                        break;
-                }
-                break;
-            case NODE_LET_STATEMENT:
-                destroy_ast_node(node->data.letStatement->indexExpression);
-                destroy_ast_node(node->data.letStatement->rightExpression);
-                break;
-
-            case NODE_IF_STATEMENT:
-                destroy_ast_node(node->data.ifStatement->condition);
-                destroy_ast_node(node->data.ifStatement->ifBranch);
-                destroy_ast_node(node->data.ifStatement->elseBranch);
-                break;
-
-            case NODE_WHILE_STATEMENT:
-                destroy_ast_node(node->data.whileStatement->condition);
-                destroy_ast_node(node->data.whileStatement->body);
-                break;
-
-            case NODE_DO_STATEMENT:
-                destroy_ast_node(node->data.doStatement->subroutineCall);
-                break;
-
-            case NODE_RETURN_STATEMENT:
-                destroy_ast_node(node->data.returnStatement->expression);
-                break;
-
-            case NODE_SUBROUTINE_CALL:
-                for (int i = 0; i < vector_size(node->data.subroutineCall->arguments); ++i) {
-                    destroy_ast_node((ASTNode*)vector_get(node->data.subroutineCall->arguments, i));
-                }
-                vector_destroy(node->data.subroutineCall->arguments);
-                break;
-
-            case NODE_EXPRESSION:
-                destroy_ast_node(node->data.expression->term);
-                for (int i = 0; i < vector_size(node->data.expression->operations); ++i) {
-                    destroy_ast_node((ASTNode*)vector_get(node->data.expression->operations, i));
-                }
-                vector_destroy(node->data.expression->operations);
-                break;
-
-            case NODE_TERM:
-                switch (node->data.term->termType) {
-                    case INTEGER_CONSTANT:
-                        break;
-                    case STRING_CONSTANT:
-                        // string is arena allocated
-                        break;
-                    case KEYWORD_CONSTANT:
-                       // arena allocated
-                        break;
-                    case VAR_TERM:
-                        destroy_ast_node(node->data.term->data.varTerm);
-                        break;
-                    case ARRAY_ACCESS:
-                        destroy_ast_node(node->data.term->data.arrayAccess.index);
-                        break;
-                    case SUBROUTINE_CALL:
-                        destroy_ast_node(node->data.term->data.subroutineCall);
-                        break;
-                    case EXPRESSION:
-                        destroy_ast_node(node->data.term->data.expression);
-                        break;
-                    case UNARY_OP:
-                        destroy_ast_node(node->data.term->data.unaryOp.term);
-                        break;
-                    default:
-                        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_UNKNOWN_NODE_TYPE, __FILE__, __LINE__,
-                            "['%s'] : Unknown node type: %d\n", __func__, node->nodeType);
-                        break;
-                }
-                break;
-            case NODE_OPERATION:
-                destroy_ast_node(node->data.operation->term);
-                break;
-
-            case NODE_VAR_TERM:
-                // char* are arena allocated
-                break;
-
-            default:
-                log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_UNKNOWN_NODE_TYPE, __FILE__, __LINE__,
-                            "['%s'] : Unknown node type: %d\n", __func__, node->nodeType);
-                break;
-        }
-    }
+/**
+ * @brief The root of the program, holding the pools of its classes. It is not part of any pool, it and its
+ * class list live in `arena`.
+ */
+ASTNode* init_program_node(Arena* arena) {
+    ASTNode* node = arena_alloc(arena, sizeof(ASTNode));
+    memset(node, 0, sizeof(ASTNode));
+    node->nodeType = NODE_PROGRAM;
+    node->data.program.classes = arena_alloc(arena, sizeof(SmallVec));
+    init_small_vec(node->data.program.classes, sizeof(ASTPool*), arena);
+    return node;
 }
 
 void execute_build_function(ASTVisitor* visitor, ASTNode* node) {
@@ -456,7 +203,11 @@ void execute_generator_function(ASTVisitor* visitor, ASTNode* node) {
     }
 }
 
-void ast_node_accept(ASTVisitor *visitor, ASTNode *node) {
+/**
+ * @brief Visit node `id` of the pool of the class being visited.
+ */
+void ast_node_accept(ASTVisitor *visitor, NodeId id) {
+    ASTNode *node = visitor && visitor->pool ? ast_node(visitor->pool, id) : NULL;
     if (!visitor || !node) {
         log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
                             "['%s'] : Null visitor or node provided", __func__);
@@ -478,6 +229,14 @@ void ast_node_accept(ASTVisitor *visitor, ASTNode *node) {
     }
 }
 
+/**
+ * @brief Visit the class held by `pool`, its nodes are resolved in that pool.
+ */
+void ast_class_accept(ASTVisitor *visitor, ASTPool *pool) {
+    visitor->pool = pool;
+    ast_node_accept(visitor, pool->root);
+}
+
 void push_table(ASTVisitor* visitor, SymbolTable* table) {
     visitor->currentTable = table;
 }
@@ -492,50 +251,50 @@ void pop_table(ASTVisitor* visitor) {
 }
 
 void build_program_node(ASTVisitor* visitor, ASTNode* node) {
-    ProgramNode* programNode = node->data.program;
+    ProgramNode* programNode = &node->data.program;
 
-    for(int i = 0; i < vector_size(programNode->classes); i++) {
-        ASTNode* classNode = (ASTNode*) vector_get(programNode->classes, i);
-        ast_node_accept(visitor, classNode);
+    for(uint32_t i = 0; i < programNode->classes->size; i++) {
+        ast_class_accept(visitor, program_class(node, i));
     }
 }
 
 void build_class_node(ASTVisitor* visitor, ASTNode* node) {
     SymbolTable* classTable = create_table(SCOPE_CLASS, visitor->currentTable, visitor->arena);
-    Symbol* classSymbol = symbol_table_add(visitor->currentTable, node->data.classDec->className,
-                                           node->data.classDec->className, KIND_CLASS);
+    Symbol* classSymbol = symbol_table_add(visitor->currentTable, node->data.classDec.className,
+                                           node->data.classDec.className, KIND_CLASS);
     classSymbol->childTable = classTable;
 
     push_table(visitor, classTable);
 
-    for (int i = 0; i < vector_size(node->data.classDec->classVarDecs); i++) {
-        ASTNode* classVarDecNode =  (ASTNode*) vector_get(node->data.classDec->classVarDecs, i);
+    for (uint32_t i = 0; i < node->data.classDec.classVarDecs.count; i++) {
+        NodeId classVarDecNode = ast_child(visitor->pool, node->data.classDec.classVarDecs, i);
         ast_node_accept(visitor, classVarDecNode);
     }
-    for (int i = 0; i < vector_size(node->data.classDec->subroutineDecs); i++) {
-        ASTNode* subroutineDecNode = (ASTNode*) vector_get(node->data.classDec->subroutineDecs, i);
+    for (uint32_t i = 0; i < node->data.classDec.subroutineDecs.count; i++) {
+        NodeId subroutineDecNode = ast_child(visitor->pool, node->data.classDec.subroutineDecs, i);
         ast_node_accept(visitor, subroutineDecNode);
     }
     pop_table(visitor);
 }
 
 void build_class_var_dec_node(ASTVisitor* visitor, ASTNode* node) {
-    for (int i = 0; i < vector_size(node->data.classVarDec->varNames); i++) {
-        char* varName = (char*) vector_get(node->data.classVarDec->varNames, i);
+    for (uint32_t i = 0; i < node->data.classVarDec.varNames.count; i++) {
+        Atom varName = ast_name(visitor->pool, node->data.classVarDec.varNames, i);
         if (symbol_table_lookup(visitor->currentTable, varName, LOOKUP_LOCAL)) {
-            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_REDECLARED_SYMBOL, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Variable %s is already declared in this scope", __func__, varName);
+            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_REDECLARED_SYMBOL, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Variable %s is already declared in this scope", __func__,
+                                  atom_str(varName));
         }
-        switch (node->data.classVarDec->classVarModifier) {
+        switch (node->data.classVarDec.classVarModifier) {
             case STATIC:
-                (void) symbol_table_add(visitor->currentTable, varName, node->data.classVarDec->varType, KIND_STATIC);
+                (void) symbol_table_add(visitor->currentTable, varName, node->data.classVarDec.varType, KIND_STATIC);
                 break;
             case FIELD:
-                (void) symbol_table_add(visitor->currentTable, varName, node->data.classVarDec->varType, KIND_FIELD);
+                (void) symbol_table_add(visitor->currentTable, varName, node->data.classVarDec.varType, KIND_FIELD);
                 break;
             default:
-                log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Invalid class var modifier", __func__);
+                log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Invalid class var modifier", __func__);
         }
     }
 }
@@ -544,146 +303,150 @@ void build_subroutine_dec_node(ASTVisitor* visitor, ASTNode* node) {
     SymbolTable* subroutineTable;
     Symbol* subSymbol;
 
-    switch(node->data.subroutineDec->subroutineType) {
+    switch(node->data.subroutineDec.subroutineType) {
         case CONSTRUCTOR:
             subroutineTable = create_table(SCOPE_CONSTRUCTOR, visitor->currentTable, visitor->arena);
-            subSymbol = symbol_table_add(visitor->currentTable, node->data.subroutineDec->subroutineName,
-                node->data.subroutineDec->returnType, KIND_CONSTRUCTOR);
+            subSymbol = symbol_table_add(visitor->currentTable, node->data.subroutineDec.subroutineName,
+                node->data.subroutineDec.returnType, KIND_CONSTRUCTOR);
             break;
         case METHOD:
             subroutineTable = create_table(SCOPE_METHOD, visitor->currentTable, visitor->arena);
-            subSymbol =symbol_table_add(visitor->currentTable, node->data.subroutineDec->subroutineName,
-                node->data.subroutineDec->returnType, KIND_METHOD);
+            subSymbol =symbol_table_add(visitor->currentTable, node->data.subroutineDec.subroutineName,
+                node->data.subroutineDec.returnType, KIND_METHOD);
             break;
         case FUNCTION:
             subroutineTable = create_table(SCOPE_FUNCTION, visitor->currentTable, visitor->arena);
-            subSymbol = symbol_table_add(visitor->currentTable, node->data.subroutineDec->subroutineName,
-                node->data.subroutineDec->returnType, KIND_FUNCTION);
+            subSymbol = symbol_table_add(visitor->currentTable, node->data.subroutineDec.subroutineName,
+                node->data.subroutineDec.returnType, KIND_FUNCTION);
             break;
         default:
-            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_SUBROUTINE, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Invalid subroutine type", __func__);
+            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_SUBROUTINE, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Invalid subroutine type", __func__);
             exit(EXIT_FAILURE);
     }
 
     subSymbol->childTable = subroutineTable;
     push_table(visitor, subroutineTable);
-    ast_node_accept(visitor, node->data.subroutineDec->parameters);
-    ast_node_accept(visitor, node->data.subroutineDec->body);
+    ast_node_accept(visitor, node->data.subroutineDec.parameters);
+    ast_node_accept(visitor, node->data.subroutineDec.body);
     pop_table(visitor);
 }
 
 void build_parameter_list_node(ASTVisitor* visitor, ASTNode* node) {
-    for(int i = 0; i < vector_size(node->data.parameterList->parameterTypes); i++) {
-        const char* parameterType = (char*) vector_get(node->data.parameterList->parameterTypes, i);
-        const char* parameterName = (char*) vector_get(node->data.parameterList->parameterNames, i);
+    for (uint32_t i = 0; i < num_parameters(&node->data.parameterList); i++) {
+        Atom parameterType = parameter_type(visitor->pool, &node->data.parameterList, i);
+        Atom parameterName = parameter_name(visitor->pool, &node->data.parameterList, i);
         (void) symbol_table_add(visitor->currentTable, parameterName, parameterType, KIND_ARG);
     }
 }
 
 
 void build_subroutine_body_node(ASTVisitor* visitor, ASTNode* node) {
-    for (int i = 0; i < vector_size(node->data.subroutineBody->varDecs); i++) {
-        ASTNode* varDecNode = vector_get(node->data.subroutineBody->varDecs, i);
+    for (uint32_t i = 0; i < node->data.subroutineBody.varDecs.count; i++) {
+        NodeId varDecNode = ast_child(visitor->pool, node->data.subroutineBody.varDecs, i);
         ast_node_accept(visitor, varDecNode);
     }
 }
 
 void build_var_dec_node(ASTVisitor* visitor, ASTNode* node) {
-    for (int i = 0; i < vector_size(node->data.varDec->varNames); i++) {
-        char* varName = (char*) vector_get(node->data.varDec->varNames, i);
-        (void) symbol_table_add(visitor->currentTable, varName, node->data.varDec->varType, KIND_VAR);
+    for (uint32_t i = 0; i < node->data.varDec.varNames.count; i++) {
+        Atom varName = ast_name(visitor->pool, node->data.varDec.varNames, i);
+        (void) symbol_table_add(visitor->currentTable, varName, node->data.varDec.varType, KIND_VAR);
     }
 }
 
 void analyze_program_node(ASTVisitor* visitor, ASTNode* node) {
-    ProgramNode* programNode = node->data.program;
+    ProgramNode* programNode = &node->data.program;
 
-    for(int i = 0; i < vector_size(programNode->classes); i++) {
-        ASTNode* classNode = (ASTNode*) vector_get(programNode->classes, i);
-        ast_node_accept(visitor, classNode);
+    for(uint32_t i = 0; i < programNode->classes->size; i++) {
+        ast_class_accept(visitor, program_class(node, i));
     }
 }
 
 void analyze_class_node(ASTVisitor* visitor, ASTNode* node) {
-    visitor->currentClassName = node->data.classDec->className;
+    visitor->currentClassName = node->data.classDec.className;
 
-    Symbol* classSymbol = symbol_table_lookup(visitor->currentTable, node->data.classDec->className
+    Symbol* classSymbol = symbol_table_lookup(visitor->currentTable, node->data.classDec.className
                                                 , LOOKUP_LOCAL);
     if (!classSymbol || classSymbol->kind != KIND_CLASS) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_KIND , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Undefined class >  '%s'", __func__, node->data.classDec->className );
+        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_KIND , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Undefined class >  '%s'", __func__,
+                              atom_str(node->data.classDec.className));
         return;
     }
 
     push_table(visitor, classSymbol->childTable);
 
-    for (int i = 0; i < vector_size(node->data.classDec->classVarDecs); i++) {
-        ASTNode* classVarDecNode =  (ASTNode*) vector_get(node->data.classDec->classVarDecs, i);
+    for (uint32_t i = 0; i < node->data.classDec.classVarDecs.count; i++) {
+        NodeId classVarDecNode = ast_child(visitor->pool, node->data.classDec.classVarDecs, i);
         ast_node_accept(visitor, classVarDecNode);
     }
 
-    for (int i = 0; i < vector_size(node->data.classDec->subroutineDecs); i++) {
-        ASTNode* subroutineDecNode = (ASTNode*) vector_get(node->data.classDec->subroutineDecs, i);
+    for (uint32_t i = 0; i < node->data.classDec.subroutineDecs.count; i++) {
+        NodeId subroutineDecNode = ast_child(visitor->pool, node->data.classDec.subroutineDecs, i);
         ast_node_accept(visitor, subroutineDecNode);
     }
 
     // Return to the parent scope
     pop_table(visitor);
-    visitor->currentClassName = NULL;
+    visitor->currentClassName = ATOM_NONE;
 }
 
 void analyze_class_var_dec_node(ASTVisitor* visitor, ASTNode* node) {
-    for (int i = 0; i < vector_size(node->data.classVarDec->varNames); i++) {
-        char* varName = (char*) vector_get(node->data.classVarDec->varNames, i);
+    for (uint32_t i = 0; i < node->data.classVarDec.varNames.count; i++) {
+        Atom varName = ast_name(visitor->pool, node->data.classVarDec.varNames, i);
         Symbol* varSymbol = symbol_table_lookup(visitor->currentTable, varName, LOOKUP_GLOBAL);
         if(!type_is_valid(visitor, varSymbol->type)) {
-            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Invalid type %s", __func__, varSymbol->type->userDefinedType );
+            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Invalid type %s", __func__,
+                              atom_str(varSymbol->type->userDefinedType));
         }
     }
 }
 
 void analyze_subroutine_dec_node(ASTVisitor* visitor, ASTNode* node) {
     Symbol* subSymbol = symbol_table_lookup(visitor->currentTable,
-                                            node->data.subroutineDec->subroutineName, LOOKUP_LOCAL);
+                                            node->data.subroutineDec.subroutineName, LOOKUP_LOCAL);
     if(!subSymbol || (subSymbol->kind != KIND_METHOD && subSymbol->kind != KIND_CONSTRUCTOR
             && subSymbol->kind != KIND_FUNCTION)) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_KIND , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Undefined subroutine > '%s'", __func__, node->data.subroutineDec->subroutineName );
+        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_KIND , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Undefined subroutine > '%s'", __func__,
+                              atom_str(node->data.subroutineDec.subroutineName));
         return;
     }
 
     push_table(visitor, subSymbol->childTable);
-    ast_node_accept(visitor, node->data.subroutineDec->parameters);
-    ast_node_accept(visitor, node->data.subroutineDec->body);
+    ast_node_accept(visitor, node->data.subroutineDec.parameters);
+    ast_node_accept(visitor, node->data.subroutineDec.body);
     pop_table(visitor);
 }
 
 void analyze_parameter_list_node(ASTVisitor* visitor, ASTNode* node) {
-    for(int i = 0; i < vector_size(node->data.parameterList->parameterTypes); i++) {
-        char* paramName = (char*) vector_get(node->data.parameterList->parameterNames, i);
+    for (uint32_t i = 0; i < num_parameters(&node->data.parameterList); i++) {
+        Atom paramName = parameter_name(visitor->pool, &node->data.parameterList, i);
         Symbol* paramSymbol = symbol_table_lookup(visitor->currentTable, paramName, LOOKUP_GLOBAL);
         if(!type_is_valid(visitor, paramSymbol->type)) {
-            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Invalid type ['%s'] for this parameter > '%s'", __func__,
-                              paramSymbol->type->userDefinedType, paramName);
+            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Invalid type ['%s'] for this parameter > '%s'", __func__,
+                              atom_str(paramSymbol->type->userDefinedType), atom_str(paramName));
         }
     }
 }
 
 void analyze_subroutine_body_node(ASTVisitor* visitor, ASTNode* node) {
-    for (int i = 0; i < vector_size(node->data.subroutineBody->varDecs); i++) {
-        ASTNode* varDecNode = (ASTNode*) vector_get(node->data.subroutineBody->varDecs, i);
-        char* varName = (char*) vector_get(varDecNode->data.varDec->varNames, i);
-        Symbol* varSymbol = symbol_table_lookup(visitor->currentTable, varName, LOOKUP_LOCAL);
-        if (!type_is_valid(visitor, varSymbol->type)) {
-            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Invalid type ['%s'] for this variable > '%s'", __func__,
-                              varSymbol->type->userDefinedType, varName);
+    for (uint32_t i = 0; i < node->data.subroutineBody.varDecs.count; i++) {
+        ASTNode* varDecNode = ast_node(visitor->pool, ast_child(visitor->pool, node->data.subroutineBody.varDecs, i));
+        for (uint32_t j = 0; j < varDecNode->data.varDec.varNames.count; j++) {
+            Atom varName = ast_name(visitor->pool, varDecNode->data.varDec.varNames, j);
+            Symbol* varSymbol = symbol_table_lookup(visitor->currentTable, varName, LOOKUP_LOCAL);
+            if (!type_is_valid(visitor, varSymbol->type)) {
+                log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Invalid type ['%s'] for this variable > '%s'", __func__,
+                                  atom_str(varSymbol->type->userDefinedType), atom_str(varName));
+            }
         }
     }
-    ast_node_accept(visitor, node->data.subroutineBody->statements);
+    ast_node_accept(visitor, node->data.subroutineBody.statements);
 }
 
 // Var Dec analysis done in subroutine dec
@@ -692,75 +455,76 @@ void analyze_var_dec_node(ASTVisitor* visitor, ASTNode* node) {
 }
 
 void analyze_statements_node(ASTVisitor* visitor, ASTNode* node) {
-    for(int i = 0; i < vector_size(node->data.statements->statements); i++) {
-        ASTNode* stmtNode = (ASTNode*) vector_get(node->data.statements->statements, i);
+    for (uint32_t i = 0; i < node->data.statements.statements.count; i++) {
+        NodeId stmtNode = ast_child(visitor->pool, node->data.statements.statements, i);
         ast_node_accept(visitor, stmtNode);
     }
 }
 
 void analyze_statement_node(ASTVisitor* visitor, ASTNode* node) {
 
-    switch (node->data.statement->statementType) {
+    switch (node->data.statement.statementType) {
         case LET:
-            ast_node_accept(visitor, node->data.statement->data.letStatement);
+            ast_node_accept(visitor, node->data.statement.data.letStatement);
             break;
         case IF:
-            ast_node_accept(visitor, node->data.statement->data.ifStatement);
+            ast_node_accept(visitor, node->data.statement.data.ifStatement);
             break;
         case WHILE:
-            ast_node_accept(visitor, node->data.statement->data.whileStatement);
+            ast_node_accept(visitor, node->data.statement.data.whileStatement);
             break;
         case DO:
-            ast_node_accept(visitor, node->data.statement->data.doStatement);
+            ast_node_accept(visitor, node->data.statement.data.doStatement);
             break;
         case RETURN:
-            ast_node_accept(visitor, node->data.statement->data.returnStatement);
+            ast_node_accept(visitor, node->data.statement.data.returnStatement);
             break;
         default:
-            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_STATEMENT , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Invalid statement", __func__);
+            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_STATEMENT , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Invalid statement", __func__);
     }
 }
 
 void analyze_let_statement_node(ASTVisitor* visitor, ASTNode* node) {
 
-    LetStatementNode* letStmtNode = node->data.letStatement;
-    char* varName = letStmtNode->varName;
+    LetStatementNode* letStmtNode = &node->data.letStatement;
+    Atom varName = letStmtNode->varName;
     Symbol* varSymbol = symbol_table_lookup(visitor->currentTable, varName, LOOKUP_CLASS);
 
     if(!varSymbol) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_UNDECLARED_SYMBOL , node->filename, node->line,
-                              node->byte_offset, "['%s'] : This variable is undeclared > '%s'", __func__, varName);
+        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_UNDECLARED_SYMBOL , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : This variable is undeclared > '%s'", __func__,
+                              atom_str(varName));
         return;
     }
 
     if(letStmtNode->indexExpression) {
         ast_node_accept(visitor, letStmtNode->indexExpression);
-        Type* indexExprType = letStmtNode->indexExpression->data.expression->type;
+        Type* indexExprType = &ast_node(visitor->pool, letStmtNode->indexExpression)->data.expression.type;
         if(indexExprType->userDefinedType != TYPE_INT) {
-             log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_EXPRESSION , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Array index must be an integer.", __func__);
+             log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_EXPRESSION , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Array index must be an integer.", __func__);
         }
 
         //TODO -  May need to confirm varName is an array
     }
 
     ast_node_accept(visitor, letStmtNode->rightExpression);
-    Type* rightExprType =  letStmtNode->rightExpression->data.expression->type;
+    Type* rightExprType = &ast_node(visitor->pool, letStmtNode->rightExpression)->data.expression.type;
     if(!types_are_equal(rightExprType, varSymbol->type)) {
-         log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Type mismatch in assignment", __func__);
+         log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Type mismatch in assignment", __func__);
     }
 }
 
 void analyze_if_statement_node(ASTVisitor* visitor, ASTNode* node) {
-    IfStatementNode* ifStmtNode = node->data.ifStatement;
+    IfStatementNode* ifStmtNode = &node->data.ifStatement;
 
     ast_node_accept(visitor, ifStmtNode->condition);
-    Type* conditionType = ifStmtNode->condition->data.expression->type;
+    Type* conditionType = &ast_node(visitor->pool, ifStmtNode->condition)->data.expression.type;
     if (conditionType->basicType != TYPE_BOOLEAN) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, node->filename, node->line,
-                              node->byte_offset, "['%s'] : Condition must evaluate to a bool type", __func__);
+        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Condition must evaluate to a bool type", __func__);
     }
 
     ast_node_accept(visitor, ifStmtNode->ifBranch);
@@ -771,14 +535,14 @@ void analyze_if_statement_node(ASTVisitor* visitor, ASTNode* node) {
 }
 
 void analyze_while_statement_node(ASTVisitor* visitor, ASTNode* node) {
-    WhileStatementNode* whileStmtNode = node->data.whileStatement;
+    WhileStatementNode* whileStmtNode = &node->data.whileStatement;
 
     ast_node_accept(visitor, whileStmtNode->condition);
-    Type* conditionType = whileStmtNode->condition->data.expression->type;
+    Type* conditionType = &ast_node(visitor->pool, whileStmtNode->condition)->data.expression.type;
 
     if (conditionType->basicType != TYPE_BOOLEAN) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, node->filename, node->line,
-                              node->byte_offset, "['%s'] : Condition must evaluate to a bool", __func__);
+        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Condition must evaluate to a bool", __func__);
     }
 
     ast_node_accept(visitor, whileStmtNode->body);
@@ -786,7 +550,7 @@ void analyze_while_statement_node(ASTVisitor* visitor, ASTNode* node) {
 
 
 void analyze_do_statement_node(ASTVisitor* visitor, ASTNode* node) {
-    DoStatementNode* doStmtNode = node->data.doStatement;
+    DoStatementNode* doStmtNode = &node->data.doStatement;
 
     // Analyze the subroutine call
     ast_node_accept(visitor, doStmtNode->subroutineCall);
@@ -804,80 +568,80 @@ void analyze_return_statement_node(ASTVisitor* visitor, ASTNode* node) {
     }
 
     if(!subSymbol) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_NULL_POINTER, node->filename, node->line,
-                              node->byte_offset, "['%s'] : Could not find subroutine symbol in parent table", __func__);
+        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_NULL_POINTER, visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Could not find subroutine symbol in parent table", __func__);
         return;
     }
 
     Type* subroutineType = subSymbol->type;
-    ReturnStatementNode* returnStmt = node->data.returnStatement;
+    ReturnStatementNode* returnStmt = &node->data.returnStatement;
     if (returnStmt->expression) {
         ast_node_accept(visitor, returnStmt->expression);
-        if(!types_are_equal(subroutineType, returnStmt->expression->data.expression->type)) {
-            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Return type > '%s', mismatch with subroutine return type '%s'",
-                                  __func__, type_to_str(returnStmt->expression->data.expression->type), type_to_str(subroutineType));
+        Type* returnType = &ast_node(visitor->pool, returnStmt->expression)->data.expression.type;
+        if(!types_are_equal(subroutineType, returnType)) {
+            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Return type > '%s', mismatch with subroutine return type '%s'",
+                                  __func__, type_to_str(returnType), type_to_str(subroutineType));
         }
     } else {
         // When return format is just 'return;', subroutine type should be void
         if (subroutineType->basicType != TYPE_VOID) {
-            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Expected subroutine return type > '%s', but no return value provided.",  __func__, type_to_str(subroutineType));
+            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Expected subroutine return type > '%s', but no return value provided.",  __func__, type_to_str(subroutineType));
         }
     }
 }
 
 void analyze_term_node(ASTVisitor* visitor, ASTNode* node) {
-    TermNode* termNode = node->data.term;
-    char* keyword = termNode->data.keywordValue;
+    TermNode* termNode = &node->data.term;
+    Atom keyword = termNode->data.keywordValue;
 
     switch (termNode->termType)
     {
         case INTEGER_CONSTANT:
-            termNode->type->basicType = TYPE_INT;
-            termNode->type->userDefinedType = NULL;
+            termNode->type.basicType = TYPE_INT;
+            termNode->type.userDefinedType = ATOM_NONE;
             break;
         case STRING_CONSTANT:
-            termNode->type->basicType = TYPE_STRING;
-            termNode->type->userDefinedType = NULL;
+            termNode->type.basicType = TYPE_STRING;
+            termNode->type.userDefinedType = ATOM_NONE;
             break;
         case KEYWORD_CONSTANT:
-            if (strcmp(keyword, "true") == 0 || strcmp(keyword, "false") == 0) {
-                termNode->type->basicType = TYPE_BOOLEAN;
-                termNode->type->userDefinedType = NULL;
-            } else if (strcmp(keyword, "null") == 0) {
-                termNode->type->basicType = TYPE_NULL;
-                termNode->type->userDefinedType = NULL;
-            } else if (strcmp(keyword, "this") == 0) {
-                termNode->type->basicType = TYPE_USER_DEFINED;
-                termNode->type->userDefinedType = visitor->currentClassName; // Assuming you have this field in ASTVisitor
+            if (keyword == ATOM_TRUE || keyword == ATOM_FALSE) {
+                termNode->type.basicType = TYPE_BOOLEAN;
+                termNode->type.userDefinedType = ATOM_NONE;
+            } else if (keyword == ATOM_NULL) {
+                termNode->type.basicType = TYPE_NULL;
+                termNode->type.userDefinedType = ATOM_NONE;
+            } else if (keyword == ATOM_THIS) {
+                termNode->type.basicType = TYPE_USER_DEFINED;
+                termNode->type.userDefinedType = visitor->currentClassName; // Assuming you have this field in ASTVisitor
             } else {
-                log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TERM, node->filename, node->line,
-                                      node->byte_offset, "['%s'] : Invalid keyword constant.",  __func__ );
+                log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TERM, visitor->pool->filename, node->line,
+                                      ast_byte_offset(node), "['%s'] : Invalid keyword constant.",  __func__ );
             }
             break;
         case VAR_TERM:
             ast_node_accept(visitor, termNode->data.varTerm);
-            termNode->type = termNode->data.varTerm->data.varTerm->type;
+            termNode->type = ast_node(visitor->pool, termNode->data.varTerm)->data.varTerm.type;
             break;
         case SUBROUTINE_CALL:
             ast_node_accept(visitor, termNode->data.subroutineCall);
-            termNode->type = termNode->data.subroutineCall->data.subroutineCall->type;
+            termNode->type = ast_node(visitor->pool, termNode->data.subroutineCall)->data.subroutineCall.type;
             break;
         case EXPRESSION:
             ast_node_accept(visitor, termNode->data.expression);
-            termNode->type = termNode->data.expression->data.expression->type;
+            termNode->type = ast_node(visitor->pool, termNode->data.expression)->data.expression.type;
             break;
         case UNARY_OP:
             analyze_unary_op_node(visitor,node);
-            termNode->type = termNode->data.unaryOp.term->data.term->type;
+            termNode->type = ast_node(visitor->pool, termNode->data.unaryOp.term)->data.term.type;
             break;
         case ARRAY_ACCESS:
             analyze_array_access_node(visitor, node);
-            termNode->type = termNode->data.arrayAccess.type;
         default:
-            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TERM, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Invalid term type",  __func__);
+            log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TERM, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Invalid term type",  __func__);
     }
 }
 
@@ -927,74 +691,71 @@ bool types_are_equal(Type* type1, Type* type2) {
     }
 
     if (type1->userDefinedType) {
-        return strcmp(type1->userDefinedType, type2->userDefinedType) == 0;
+        return type1->userDefinedType == type2->userDefinedType;
     }
 
     return true;
 }
 
 void analyze_expression_node(ASTVisitor* visitor, ASTNode* node) {
-    ast_node_accept(visitor, node->data.expression->term);
+    ast_node_accept(visitor, node->data.expression.term);
 
-    Type* resultType = node->data.expression->type;
-    *resultType = *(node->data.expression->term->data.term->type);
+    Type* resultType = &node->data.expression.type;
+    *resultType = ast_node(visitor->pool, node->data.expression.term)->data.term.type;
 
-    for (int i = 0; i < vector_size(node->data.expression->operations); i++) {
-        ASTNode *opNode = (ASTNode *) vector_get(node->data.expression->operations, i);
+    for (uint32_t i = 0; i < node->data.expression.operations.count; i++) {
+        ASTNode* opNode = ast_node(visitor->pool, ast_child(visitor->pool, node->data.expression.operations, i));
 
-        ast_node_accept(visitor, opNode->data.operation->term);
-        Type* nextType = opNode->data.operation->term->data.term->type;
+        ast_node_accept(visitor, opNode->data.operation.term);
+        Type* nextType = &ast_node(visitor->pool, opNode->data.operation.term)->data.term.type;
 
-        switch (opNode->data.operation->op) {
+        switch (opNode->data.operation.op) {
             case '+':
             case '-':
             case '*':
             case '/': // arithmetic
                 if (!type_arithmetic_compat(resultType, nextType)) {
 
-                    log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Invalid types for arithmetic operations > ['%s', '%s']",
+                    log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Invalid types for arithmetic operations > ['%s', '%s']",
                                   __func__, type_to_str(resultType), type_to_str(nextType));
                 }
                 resultType->basicType = TYPE_INT;
-                resultType->userDefinedType = NULL;
+                resultType->userDefinedType = ATOM_NONE;
                 break;
             case '>':
             case '<':
             case '=':
                 if (!type_comparison_compat(resultType, nextType)) {
-                      log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Invalid types for comparison operations > ['%s', '%s']",
+                      log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Invalid types for comparison operations > ['%s', '%s']",
                                   __func__, type_to_str(resultType), type_to_str(nextType));
                 }
                 resultType->basicType = TYPE_BOOLEAN;
-                resultType->userDefinedType = NULL;
+                resultType->userDefinedType = ATOM_NONE;
                 break;
             case '&':
             case '|':
                 if (!type_is_boolean(resultType) || !type_is_boolean(nextType)) {
-                      log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Invalid types for boolean operations > ['%s', '%s']",
+                      log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Invalid types for boolean operations > ['%s', '%s']",
                                   __func__, type_to_str(resultType), type_to_str(nextType));
                 }
                 resultType->basicType = TYPE_BOOLEAN;
-                resultType->userDefinedType = NULL;
+                resultType->userDefinedType = ATOM_NONE;
                 break;
             default:
-                  log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_OPERATION, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Invalid operation",
+                  log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_OPERATION, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Invalid operation",
                                   __func__);
                 break;
         }
     }
-
-    // Assign the resultant type of the expression to the node itself
-    node->data.expression->type = resultType;
 }
 
 
 void analyze_subroutine_call_node(ASTVisitor* visitor, ASTNode* node){
-    SubroutineCallNode * subCall =  node->data.subroutineCall;
+    SubroutineCallNode * subCall = &node->data.subroutineCall;
 
     Symbol* subSymbol = NULL;
 
@@ -1003,9 +764,9 @@ void analyze_subroutine_call_node(ASTVisitor* visitor, ASTNode* node){
 
         // If it's not a global, it might be an object in the class scope.
         if (!callerSymbol) {
-              log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_UNDECLARED_SYMBOL, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Caller class is undeclared > '%s'",
-                                  __func__, subCall->caller);
+              log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_UNDECLARED_SYMBOL, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Caller class is undeclared > '%s'",
+                                  __func__, atom_str(subCall->caller));
             return;
         }
 
@@ -1031,58 +792,59 @@ void analyze_subroutine_call_node(ASTVisitor* visitor, ASTNode* node){
 
     if (!subSymbol || !(subSymbol->kind == KIND_FUNCTION ||
         subSymbol->kind == KIND_CONSTRUCTOR || subSymbol->kind == KIND_METHOD)) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_EXPRESSION, node->filename, node->line,
-                              node->byte_offset, "['%s'] : Subroutine > '%s', has not been declared yet ",
-                              __func__, subCall->subroutineName);
+        log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_EXPRESSION, visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Subroutine > '%s', has not been declared yet ",
+                              __func__, atom_str(subCall->subroutineName));
         return;
     }
 
-    subCall->type = subSymbol->type;
+    subCall->type = *subSymbol->type;
 
     SymbolTable* subroutineTable = subSymbol->childTable;
     vector args = get_symbols_of_kind(subroutineTable, KIND_ARG);
 
     //Check Arguments
-    for(int i = 0; i < vector_size(subCall->arguments); i++) {
-        ASTNode* arg = vector_get(subCall->arguments, i);
+    for (uint32_t i = 0; i < subCall->arguments.count; i++) {
+        NodeId arg = ast_child(visitor->pool, subCall->arguments, i);
         ast_node_accept(visitor, arg);
-        Type* argType = arg->data.expression->term->data.term->type;
+        Type* argType = &ast_node(visitor->pool, ast_node(visitor->pool, arg)->data.expression.term)->data.term.type;
         Symbol* expectedArgSymbol = vector_get(args, i);
 
 
          // Special case for Memory.deAlloc
-        if (strcmp(subCall->subroutineName, "deAlloc") == 0 && strcmp(subCall->caller, "Memory") == 0) {
+        if (subCall->subroutineName == ATOM_DEALLOC && subCall->caller == ATOM_MEMORY) {
             // Bypass type check for Memory.deAlloc
             continue;
         }
 
         if(!types_are_equal(expectedArgSymbol->type, argType)) {
-             log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, node->filename, node->line,
-                                  node->byte_offset, "['%s'] : Argument type > '%s', mismatch with subroutine argument type '%s'",
+             log_error_with_offset(ERROR_PHASE_SEMANTIC, ERROR_SEMANTIC_INVALID_TYPE, visitor->pool->filename, node->line,
+                                  ast_byte_offset(node), "['%s'] : Argument type > '%s', mismatch with subroutine argument type '%s'",
                                   __func__, type_to_str(argType), type_to_str(expectedArgSymbol->type));
         }
     }
 }
 
 void analyze_var_term_node(ASTVisitor* visitor, ASTNode* node) {
-    VarTerm* term = node->data.varTerm;
+    VarTerm* term = &node->data.varTerm;
     //!  TODO - Change from varname to something inlcuding classname as well
     Symbol* termSymbol = symbol_table_lookup(visitor->currentTable, term->varName, LOOKUP_CLASS);
     if (!termSymbol) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_UNDECLARED_SYMBOL , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Undefined variable >  '%s'", __func__, term->varName);
+        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_UNDECLARED_SYMBOL , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Undefined variable >  '%s'", __func__,
+                              atom_str(term->varName));
         return;
     }
 
-    term->type = termSymbol->type;
+    term->type = *termSymbol->type;
 
     if (term->className) {
         Symbol* classSymbol = symbol_table_lookup(visitor->currentTable, term->className, LOOKUP_GLOBAL);
         Symbol* attributeOrMethod = symbol_table_lookup(classSymbol->childTable, term->varName, LOOKUP_LOCAL);
         if (!attributeOrMethod) {
-            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TERM , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Variable > '%s', is not a valid attribute or method of class > '%s'"
-                              , __func__, term->varName, term->className);
+            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TERM , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Variable > '%s', is not a valid attribute or method of class > '%s'"
+                              , __func__, atom_str(term->varName), atom_str(term->className));
             return;
         }
     }
@@ -1090,43 +852,43 @@ void analyze_var_term_node(ASTVisitor* visitor, ASTNode* node) {
 
 void analyze_unary_op_node(ASTVisitor* visitor, ASTNode* node) {
 
-    ASTNode* unaryOpTerm = node->data.term->data.unaryOp.term;
+    NodeId unaryOpTerm = node->data.term.data.unaryOp.term;
     ast_node_accept(visitor, unaryOpTerm);
-    char op = node->data.term->data.unaryOp.unaryOp;
-    Type* type = unaryOpTerm->data.term->type;
+    char op = node->data.term.data.unaryOp.unaryOp;
+    Type* type = &ast_node(visitor->pool, unaryOpTerm)->data.term.type;
 
     if (op == '~') {
         if (!type_is_boolean(type)) {
-            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Expected boolean got > '%s' instead.", __func__, type_to_str(type));
+            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Expected boolean got > '%s' instead.", __func__, type_to_str(type));
         }
     } else if (op == '-') {
         if (type->basicType != TYPE_INT) {
-            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Expected boolean got > '%s' instead.", __func__, type_to_str(type));
+            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_TYPE , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Expected boolean got > '%s' instead.", __func__, type_to_str(type));
         }
     } else {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_OPERATION , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Invalid unary operation", __func__);
+        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_OPERATION , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Invalid unary operation", __func__);
     }
 }
 
 void analyze_array_access_node(ASTVisitor* visitor, ASTNode* node) {
 
-    ASTNode* indexNode = node->data.term->data.arrayAccess.index;
+    NodeId indexNode = node->data.term.data.arrayAccess.index;
     ast_node_accept(visitor, indexNode);
 
     Symbol* arrSymbol = symbol_table_lookup(visitor->currentTable
-                        ,node->data.term->data.arrayAccess.arrayName, LOOKUP_CLASS);
+                        ,node->data.term.data.arrayAccess.arrayName, LOOKUP_CLASS);
 
     if (!arrSymbol) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_UNDECLARED_SYMBOL , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Array > '%s' is undeclared", __func__,
-                              node->data.term->data.arrayAccess.arrayName);
+        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_UNDECLARED_SYMBOL , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Array > '%s' is undeclared", __func__,
+                              atom_str(node->data.term.data.arrayAccess.arrayName));
         return;
     }
 
-    node->data.term->data.arrayAccess.type = arrSymbol->type;
+    node->data.term.type = *arrSymbol->type;
 
     // TODO - check whether index is valid
 }
@@ -1135,30 +897,31 @@ void generate_program_node(ASTVisitor* visitor, ASTNode* node) {
 
 }
 void generate_class_node(ASTVisitor* visitor, ASTNode* node) {
-    visitor->currentClassName = node->data.classDec->className;
+    visitor->currentClassName = node->data.classDec.className;
 
-    Symbol* classSymbol = symbol_table_lookup(visitor->currentTable, node->data.classDec->className
+    Symbol* classSymbol = symbol_table_lookup(visitor->currentTable, node->data.classDec.className
                                                 , LOOKUP_LOCAL);
     if (!classSymbol || classSymbol->kind != KIND_CLASS) {
-        log_error_with_offset(ERROR_PHASE_CODEGEN,ERROR_SEMANTIC_INVALID_KIND , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Undefined class >  '%s'", __func__, node->data.classDec->className );
+        log_error_with_offset(ERROR_PHASE_CODEGEN,ERROR_SEMANTIC_INVALID_KIND , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Undefined class >  '%s'", __func__,
+                              atom_str(node->data.classDec.className));
         return;
     }
 
     push_table(visitor, classSymbol->childTable);
 
-    for (int i = 0; i < vector_size(node->data.classDec->classVarDecs); i++) {
-        ASTNode* classVarDecNode = (ASTNode*) vector_get(node->data.classDec->classVarDecs, i);
+    for (uint32_t i = 0; i < node->data.classDec.classVarDecs.count; i++) {
+        NodeId classVarDecNode = ast_child(visitor->pool, node->data.classDec.classVarDecs, i);
         ast_node_accept(visitor, classVarDecNode);
     }
 
-    for (int i = 0; i < vector_size(node->data.classDec->subroutineDecs); i++) {
-        ASTNode* subroutineDecNode = (ASTNode*) vector_get(node->data.classDec->subroutineDecs, i);
+    for (uint32_t i = 0; i < node->data.classDec.subroutineDecs.count; i++) {
+        NodeId subroutineDecNode = ast_child(visitor->pool, node->data.classDec.subroutineDecs, i);
         ast_node_accept(visitor, subroutineDecNode);
     }
 
     pop_table(visitor);
-    visitor->currentClassName = NULL;
+    visitor->currentClassName = ATOM_NONE;
 }
 
 void generate_class_var_dec_node(ASTVisitor* visitor, ASTNode* node) {
@@ -1169,19 +932,21 @@ void generate_class_var_dec_node(ASTVisitor* visitor, ASTNode* node) {
 
 void generate_sub_dec_node(ASTVisitor* visitor, ASTNode* node) {
 
-    Symbol* subSymbol = symbol_table_lookup(visitor->currentTable, node->data.subroutineDec->subroutineName, LOOKUP_LOCAL);
+    Symbol* subSymbol = symbol_table_lookup(visitor->currentTable, node->data.subroutineDec.subroutineName, LOOKUP_LOCAL);
     if (!subSymbol || (subSymbol->kind != KIND_METHOD && subSymbol->kind != KIND_CONSTRUCTOR && subSymbol->kind != KIND_FUNCTION)) {
-        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_KIND , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Undefined subroutine > '%s'", __func__, node->data.subroutineDec->subroutineName );
+        log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_KIND , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Undefined subroutine > '%s'", __func__,
+                              atom_str(node->data.subroutineDec.subroutineName));
         return;
     }
 
-    char* functionLabel = arena_sprintf(visitor->arena, "%s.%s", visitor->currentClassName, node->data.subroutineDec->subroutineName);
+    char* functionLabel = arena_sprintf(visitor->arena, "%s.%s", atom_str(visitor->currentClassName),
+                                        atom_str(node->data.subroutineDec.subroutineName));
     vector localSymbols = get_symbols_of_kind(subSymbol->childTable, KIND_VAR);
     int numLocals = vector_size(localSymbols);
     write_function(visitor->vmFile, functionLabel, numLocals);
 
-    if (node->data.subroutineDec->subroutineType == CONSTRUCTOR) {
+    if (node->data.subroutineDec.subroutineType == CONSTRUCTOR) {
         vector fieldSymbols = get_symbols_of_kind(subSymbol->table, KIND_FIELD);
         int numFields = vector_size(fieldSymbols);
         write_push(visitor->vmFile, SEG_CONST, numFields);
@@ -1189,14 +954,14 @@ void generate_sub_dec_node(ASTVisitor* visitor, ASTNode* node) {
         write_pop(visitor->vmFile, SEG_POINTER, 0);  // set the `this` pointer
     }
 
-    if (node->data.subroutineDec->subroutineType == METHOD) {
+    if (node->data.subroutineDec.subroutineType == METHOD) {
         write_push(visitor->vmFile, SEG_ARG, 0);
         write_pop(visitor->vmFile, SEG_POINTER, 0);  // set the `this` pointer
     }
 
     // manage scopes
     push_table(visitor, subSymbol->childTable);
-    ast_node_accept(visitor, node->data.subroutineDec->body);
+    ast_node_accept(visitor, node->data.subroutineDec.body);
     pop_table(visitor);
 }
 
@@ -1207,39 +972,39 @@ void generate_param_list_node(ASTVisitor* visitor, ASTNode* node) {
 }
 
 void generate_sub_body_node(ASTVisitor* visitor, ASTNode* node) {
-    ast_node_accept(visitor, node->data.subroutineBody->statements);
+    ast_node_accept(visitor, node->data.subroutineBody.statements);
 }
 void generate_stmts_node(ASTVisitor* visitor, ASTNode* node) {
-    for(int i = 0; i < vector_size(node->data.statements->statements); i++) {
-        ASTNode* stmtNode = (ASTNode*) vector_get(node->data.statements->statements, i);
+    for (uint32_t i = 0; i < node->data.statements.statements.count; i++) {
+        NodeId stmtNode = ast_child(visitor->pool, node->data.statements.statements, i);
         ast_node_accept(visitor, stmtNode);
     }
 }
 void generate_stmt_node(ASTVisitor* visitor, ASTNode* node) {
-    switch (node->data.statement->statementType) {
+    switch (node->data.statement.statementType) {
         case LET:
-            ast_node_accept(visitor, node->data.statement->data.letStatement);
+            ast_node_accept(visitor, node->data.statement.data.letStatement);
             break;
         case IF:
-            ast_node_accept(visitor, node->data.statement->data.ifStatement);
+            ast_node_accept(visitor, node->data.statement.data.ifStatement);
             break;
         case WHILE:
-            ast_node_accept(visitor, node->data.statement->data.whileStatement);
+            ast_node_accept(visitor, node->data.statement.data.whileStatement);
             break;
         case DO:
-            ast_node_accept(visitor, node->data.statement->data.doStatement);
+            ast_node_accept(visitor, node->data.statement.data.doStatement);
             break;
         case RETURN:
-            ast_node_accept(visitor, node->data.statement->data.returnStatement);
+            ast_node_accept(visitor, node->data.statement.data.returnStatement);
             break;
         default:
-            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_STATEMENT , node->filename, node->line,
-                              node->byte_offset, "['%s'] : Invalid statement", __func__);
+            log_error_with_offset(ERROR_PHASE_SEMANTIC,ERROR_SEMANTIC_INVALID_STATEMENT , visitor->pool->filename, node->line,
+                              ast_byte_offset(node), "['%s'] : Invalid statement", __func__);
     }
 }
 
 void generate_let_node(ASTVisitor* visitor, ASTNode* node) {
-    LetStatementNode* letStmtNode = node->data.letStatement;
+    LetStatementNode* letStmtNode = &node->data.letStatement;
     Symbol* varSymbol = symbol_table_lookup(visitor->currentTable, letStmtNode->varName, LOOKUP_CLASS);
 
     ast_node_accept(visitor, letStmtNode->rightExpression);
@@ -1265,20 +1030,20 @@ void generate_if_node(ASTVisitor* visitor, ASTNode* node) {
     char* endLabel = generate_unique_label(visitor, "IF_END");
 
     // Generate code for the condition expression
-    ast_node_accept(visitor, node->data.ifStatement->condition);
+    ast_node_accept(visitor, node->data.ifStatement.condition);
 
     write_arithmetic(visitor->vmFile, COM_NOT);
     write_if(visitor->vmFile, falseLabel);
 
     // IF true part
     write_label(visitor->vmFile, trueLabel);
-    ast_node_accept(visitor, node->data.ifStatement->ifBranch);
+    ast_node_accept(visitor, node->data.ifStatement.ifBranch);
     write_goto(visitor->vmFile, endLabel);
 
     // IF false part (if exists)
     write_label(visitor->vmFile, falseLabel);
-    if (node->data.ifStatement->elseBranch) {
-        ast_node_accept(visitor, node->data.ifStatement->elseBranch);
+    if (node->data.ifStatement.elseBranch) {
+        ast_node_accept(visitor, node->data.ifStatement.elseBranch);
     }
 
     write_label(visitor->vmFile, endLabel);
@@ -1289,26 +1054,26 @@ void generate_while_node(ASTVisitor* visitor, ASTNode* node) {
     char* loopEndLabel = generate_unique_label(visitor, "WHILE_END");
 
     write_label(visitor->vmFile, loopStartLabel);
-    ast_node_accept(visitor, node->data.whileStatement->condition);
+    ast_node_accept(visitor, node->data.whileStatement.condition);
     write_arithmetic(visitor->vmFile, COM_NOT);
     write_if(visitor->vmFile, loopEndLabel);
 
-    ast_node_accept(visitor, node->data.whileStatement->body);
+    ast_node_accept(visitor, node->data.whileStatement.body);
     write_goto(visitor->vmFile, loopStartLabel);
     write_label(visitor->vmFile, loopEndLabel);
 }
 
 void generate_do_node(ASTVisitor* visitor, ASTNode* node) {
 
-    ast_node_accept(visitor, node->data.doStatement->subroutineCall);
+    ast_node_accept(visitor, node->data.doStatement.subroutineCall);
 
     write_pop(visitor->vmFile, SEG_TEMP, 0);
 
 }
 void generate_return_node(ASTVisitor* visitor, ASTNode* node) {
 
-    if (node->data.returnStatement->expression) {
-        ast_node_accept(visitor, node->data.returnStatement->expression);
+    if (node->data.returnStatement.expression) {
+        ast_node_accept(visitor, node->data.returnStatement.expression);
     } else {
         write_push(visitor->vmFile, SEG_CONST, 0);
     }
@@ -1318,10 +1083,10 @@ void generate_return_node(ASTVisitor* visitor, ASTNode* node) {
 
 void generate_sub_call_node(ASTVisitor* visitor, ASTNode* node) {
 
-    SubroutineCallNode* subCall = node->data.subroutineCall;
-    int nArgs = vector_size(subCall->arguments);
+    SubroutineCallNode* subCall = &node->data.subroutineCall;
+    int nArgs = (int) subCall->arguments.count;
 
-    char* actualCaller = subCall->caller;
+    Atom actualCaller = subCall->caller;
     if (subCall->caller) {
         Symbol* callerSymbol = symbol_table_lookup(visitor->currentTable, subCall->caller, LOOKUP_GLOBAL);
         if (!callerSymbol) {
@@ -1358,19 +1123,20 @@ void generate_sub_call_node(ASTVisitor* visitor, ASTNode* node) {
         }
     }
 
-    for (int i = 0; i < vector_size(subCall->arguments); i++) {
-        ASTNode* arg = vector_get(subCall->arguments, i);
+    for (uint32_t i = 0; i < subCall->arguments.count; i++) {
+        NodeId arg = ast_child(visitor->pool, subCall->arguments, i);
         ast_node_accept(visitor, arg);
     }
 
     char* callName;
     if (actualCaller) {
-        callName = arena_sprintf(visitor->arena, "%s.%s", actualCaller, subCall->subroutineName);
+        callName = arena_sprintf(visitor->arena, "%s.%s", atom_str(actualCaller), atom_str(subCall->subroutineName));
     } else {
-        callName = arena_sprintf(visitor->arena, "%s.%s", visitor->currentClassName, subCall->subroutineName);
+        callName = arena_sprintf(visitor->arena, "%s.%s", atom_str(visitor->currentClassName),
+                                 atom_str(subCall->subroutineName));
     }
 
-    if(strcmp(node->filename, "/home/tomisin/Projects/compiler/src/jack_files/Pong/PongGame.jack") == 0) {
+    if(strcmp(visitor->pool->filename, "/home/tomisin/Projects/compiler/src/jack_files/Pong/PongGame.jack") == 0) {
         log_message(LOG_LEVEL_INFO, ERROR_NONE, "['%s'] : call name > %s\n" , __func__, callName);
     }
     write_call(visitor->vmFile, callName, nArgs);
@@ -1378,14 +1144,14 @@ void generate_sub_call_node(ASTVisitor* visitor, ASTNode* node) {
 }
 void generate_expression_node(ASTVisitor* visitor, ASTNode* node) {
 
-    ast_node_accept(visitor, node->data.expression->term);
+    ast_node_accept(visitor, node->data.expression.term);
 
-    for (int i = 0; i < vector_size(node->data.expression->operations); ++i) {
+    for (uint32_t i = 0; i < node->data.expression.operations.count; ++i) {
 
-        ASTNode* opNode = (ASTNode*) vector_get((node->data.expression->operations), i);
-        ast_node_accept(visitor, opNode->data.operation->term);
+        ASTNode* opNode = ast_node(visitor->pool, ast_child(visitor->pool, node->data.expression.operations, i));
+        ast_node_accept(visitor, opNode->data.operation.term);
 
-        char op = opNode->data.operation->op;
+        char op = opNode->data.operation.op;
         switch (op) {
             case '+': write_arithmetic(visitor->vmFile, COM_ADD); break;
             case '-': write_arithmetic(visitor->vmFile, COM_SUB); break;
@@ -1402,7 +1168,7 @@ void generate_expression_node(ASTVisitor* visitor, ASTNode* node) {
 
 }
 void generate_term_node(ASTVisitor* visitor, ASTNode* node) {
-    TermNode* termNode = node->data.term;
+    TermNode* termNode = &node->data.term;
     switch (termNode->termType) {
         case INTEGER_CONSTANT:
             write_push(visitor->vmFile, SEG_CONST, termNode->data.intValue);
@@ -1421,14 +1187,14 @@ void generate_term_node(ASTVisitor* visitor, ASTNode* node) {
             break;
         case KEYWORD_CONSTANT:
             // True -> -1, else 0
-            write_push(visitor->vmFile, SEG_CONST, (strcmp(termNode->data.keywordValue, "true") == 0) ? -1 : 0);
-            if (strcmp(termNode->data.keywordValue, "this") == 0) {
+            write_push(visitor->vmFile, SEG_CONST, termNode->data.keywordValue == ATOM_TRUE ? -1 : 0);
+            if (termNode->data.keywordValue == ATOM_THIS) {
                 write_pop(visitor->vmFile, SEG_POINTER, 0);
             }
             break;
         case VAR_TERM:
             {
-                Symbol* varSymbol = symbol_table_lookup(visitor->currentTable, termNode->data.varTerm->data.varTerm->varName, LOOKUP_CLASS);
+                Symbol* varSymbol = symbol_table_lookup(visitor->currentTable, ast_node(visitor->pool, termNode->data.varTerm)->data.varTerm.varName, LOOKUP_CLASS);
                 write_push(visitor->vmFile, kind_to_segment(varSymbol->kind), varSymbol->index);
             }
             break;
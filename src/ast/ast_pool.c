@@ -0,0 +1,115 @@
+#include "ast.h"
+#include <string.h>
+#include "arena.h"
+
+// Nodes created by the calling thread, parsers run one per thread so the difference around a parse is its node count
+static _Thread_local size_t nodes_created = 0;
+
+size_t ast_nodes_created() {
+    return nodes_created;
+}
+
+static void add_chunk(ASTPool* pool) {
+    ASTNode* chunk = arena_alloc(pool->arena, sizeof(ASTNode) * AST_CHUNK_SIZE);
+    small_vec_push(&pool->chunks, &chunk);
+}
+
+/**
+ * @brief An empty pool for the nodes of the class in `filename`. The pool, its nodes and its lists all live in
+ * `arena`, nothing is malloc'd while the class is parsed and nothing needs to be freed but the arena.
+ */
+ASTPool* init_ast_pool(const char* filename, Arena* arena) {
+    ASTPool* pool = arena_alloc(arena, sizeof(ASTPool));
+    pool->arena = arena;
+    pool->filename = arena_strdup(arena, filename);
+    pool->root = NODE_NONE;
+
+    init_small_vec(&pool->chunks, sizeof(ASTNode*), arena);
+    init_small_vec(&pool->items, sizeof(uint32_t), arena);
+    init_small_vec(&pool->scratch, sizeof(uint32_t), arena);
+
+    // Slot 0 is NODE_NONE
+    add_chunk(pool);
+    pool->num_nodes = 1;
+    return pool;
+}
+
+/**
+ * @brief A new node of `type` with every field zero : no children, empty lists, ATOM_NONE names and the
+ * *_NONE kinds.
+ */
+NodeId ast_new_node(ASTPool* pool, ASTNodeType type) {
+    if (type == NODE_PROGRAM || type > NODE_VAR_TERM) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_UNKNOWN_NODE_TYPE, __FILE__, __LINE__,
+                            "['%s'] : Unknown node type: %d\n", __func__, type);
+        return NODE_NONE;
+    }
+
+    NodeId id = pool->num_nodes;
+    if ((id & (AST_CHUNK_SIZE - 1)) == 0) {
+        add_chunk(pool);
+    }
+    pool->num_nodes++;
+    nodes_created++;
+
+    ASTNode* node = ast_node(pool, id);
+    memset(node, 0, sizeof(ASTNode));
+    node->nodeType = type;
+    return id;
+}
+
+/**
+ * @brief Start a list, its entries are pushed with `ast_list_push` and it ends with `ast_list_end(pool, mark)`.
+ * @return the mark of the list
+ */
+uint32_t ast_list_begin(const ASTPool* pool) {
+    return pool->scratch.size;
+}
+
+void ast_list_push(ASTPool* pool, uint32_t item) {
+    small_vec_push(&pool->scratch, &item);
+}
+
+static NodeList append_items(ASTPool* pool, uint32_t from, uint32_t to) {
+    NodeList list = {pool->items.size, 0};
+    if (small_vec_append(&pool->items, small_vec_at(&pool->scratch, from), to - from)) {
+        list.count = to - from;
+    }
+    return list;
+}
+
+static uint32_t scratch_entry(const ASTPool* pool, uint32_t index) {
+    return ((const uint32_t*) pool->scratch.data)[index];
+}
+
+/**
+ * @brief Move the entries pushed since `mark` into the items of the pool.
+ */
+NodeList ast_list_end(ASTPool* pool, uint32_t mark) {
+    NodeList list = append_items(pool, mark, pool->scratch.size);
+    small_vec_truncate(&pool->scratch, mark);
+    return list;
+}
+
+/**
+ * @brief End the list of nodes started at `mark` as two lists, the nodes of `type` and the others, each in the
+ * order they were pushed. The members of a class are parsed in one loop but kept apart.
+ */
+void ast_list_split(ASTPool* pool, uint32_t mark, ASTNodeType type, NodeList* matching, NodeList* others) {
+    uint32_t end = pool->scratch.size;
+    for (uint32_t i = mark; i < end; ++i) {
+        if (ast_node(pool, scratch_entry(pool, i))->nodeType == type) {
+            ast_list_push(pool, scratch_entry(pool, i));
+        }
+    }
+    *matching = append_items(pool, end, pool->scratch.size);
+    small_vec_truncate(&pool->scratch, end);
+
+    for (uint32_t i = mark; i < end; ++i) {
+        if (ast_node(pool, scratch_entry(pool, i))->nodeType != type) {
+            ast_list_push(pool, scratch_entry(pool, i));
+        }
+    }
+    *others = append_items(pool, end, pool->scratch.size);
+    small_vec_truncate(&pool->scratch, mark);
+}
@@ -46,7 +46,7 @@ void printSpaces(FILE* file, int depth) {
 }
 
 
-void printTermNode(FILE* file, struct TermNode* termNode, int depth) {
+void printTermNode(FILE* file, const ASTPool* pool, struct TermNode* termNode, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "TermNode\n");
     printSpaces(file, depth);
@@ -58,31 +58,31 @@ void printTermNode(FILE* file, struct TermNode* termNode, int depth) {
         writeToFile(file, "├─ String Constant: %s\n", termNode->data.stringValue);
         break;
     case KEYWORD_CONSTANT:
-        writeToFile(file, "├─ Keyword Constant: %s\n", termNode->data.keywordValue);
+        writeToFile(file, "├─ Keyword Constant: %s\n", atom_str(termNode->data.keywordValue));
         break;
     case VAR_TERM:
         writeToFile(file, "├─ VarTerm:\n");
-        printVarTerm(file, &termNode->data.varTerm, depth+1);
+        printVarTerm(file, &ast_node(pool, termNode->data.varTerm)->data.varTerm, depth+1);
         break;
     case ARRAY_ACCESS:
         writeToFile(file, "├─ Array Access:\n");
-        writeToFile(file, "│  ├─ Array Name: %s\n", termNode->data.arrayAccess.arrayName);
+        writeToFile(file, "│  ├─ Array Name: %s\n", atom_str(termNode->data.arrayAccess.arrayName));
         writeToFile(file, "│  └─ Index Expression:\n");
-        printExpressionNode(file, termNode->data.arrayAccess.index, depth+2);
+        printExpressionNode(file, pool, &ast_node(pool, termNode->data.arrayAccess.index)->data.expression, depth+2);
         break;
     case SUBROUTINE_CALL:
         writeToFile(file, "├─ Subroutine Call: ");
-        printSubroutineCallNode(file, termNode->data.subroutineCall, depth+1);
+        printSubroutineCallNode(file, pool, &ast_node(pool, termNode->data.subroutineCall)->data.subroutineCall, depth+1);
         break;
     case EXPRESSION:
         writeToFile(file, "├─ Expression: ");
-        printExpressionNode(file, termNode->data.expression, depth+1);
+        printExpressionNode(file, pool, &ast_node(pool, termNode->data.expression)->data.expression, depth+1);
         break;
     case UNARY_OP:
         writeToFile(file, "├─ Unary Operation:\n");
         writeToFile(file, "│  ├─ Unary Operator: %c\n", termNode->data.unaryOp.unaryOp);
         writeToFile(file, "│  └─ Term:\n");
-        printTermNode(file, termNode->data.unaryOp.term, depth+2);
+        printTermNode(file, pool, &ast_node(pool, termNode->data.unaryOp.term)->data.term, depth+2);
         break;
     default:
         writeToFile(file, "├─ No Term\n");
@@ -97,14 +97,14 @@ void printVarTerm(FILE* file, struct VarTerm* varTerm, int depth) {
     writeToFile(file, "VarTerm\n");
 
     printSpaces(file, depth+1);
-    writeToFile(file, "├─ className: %s\n", varTerm->className ? varTerm->className : "NULL");
+    writeToFile(file, "├─ className: %s\n", varTerm->className ? atom_str(varTerm->className) : "NULL");
 
     printSpaces(file, depth+1);
-    writeToFile(file, "└─ varName: %s\n", varTerm->varName);
+    writeToFile(file, "└─ varName: %s\n", atom_str(varTerm->varName));
 }
 
 
-void printOperation(FILE* file, struct Operation* operation, int depth) {
+void printOperation(FILE* file, const ASTPool* pool, struct Operation* operation, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "Operation\n");
 
@@ -113,23 +113,23 @@ void printOperation(FILE* file, struct Operation* operation, int depth) {
 
     printSpaces(file, depth+1);
     writeToFile(file, "└─ term:\n");
-    printTermNode(file, operation->term, depth+2);
+    printTermNode(file, pool, &ast_node(pool, operation->term)->data.term, depth+2);
 }
 
 
-void printExpressionNode(FILE* file, struct ExpressionNode* node, int depth) {
+void printExpressionNode(FILE* file, const ASTPool* pool, struct ExpressionNode* node, int depth) {
     writeToFile(file, "ExpressionNode\n");
 
     printSpaces(file, depth+1);
     writeToFile(file, "├─ term:\n");
-    printTermNode(file, node->term, depth+2);
+    printTermNode(file, pool, &ast_node(pool, node->term)->data.term, depth+2);
 
     printSpaces(file, depth+1);
     writeToFile(file, "└─ operations:\n");
-    if (node->operations != NULL) {
-        for (int i = 0; i < vector_size(node->operations); i++) {
-            Operation* operation = (Operation*)vector_get(node->operations, i);
-            printOperation(file, operation, depth+2);
+    if (node->operations.count > 0) {
+        for (uint32_t i = 0; i < node->operations.count; i++) {
+            Operation* operation = &ast_node(pool, ast_child(pool, node->operations, i))->data.operation;
+            printOperation(file, pool, operation, depth+2);
         }
     } else {
         printSpaces(file, depth+2);
@@ -138,21 +138,21 @@ void printExpressionNode(FILE* file, struct ExpressionNode* node, int depth) {
 }
 
 
-void printSubroutineCallNode(FILE* file, struct SubroutineCallNode* node, int depth) {
+void printSubroutineCallNode(FILE* file, const ASTPool* pool, struct SubroutineCallNode* node, int depth) {
     writeToFile(file, "SubroutineCallNode\n");
 
     printSpaces(file, depth+1);
-    writeToFile(file, "├─ caller: %s\n", node->caller ? node->caller : "NULL");
+    writeToFile(file, "├─ caller: %s\n", node->caller ? atom_str(node->caller) : "NULL");
 
     printSpaces(file, depth+1);
-    writeToFile(file, "├─ subroutineName: %s\n", node->subroutineName);
+    writeToFile(file, "├─ subroutineName: %s\n", atom_str(node->subroutineName));
 
     printSpaces(file, depth+1);
     writeToFile(file, "└─ arguments: \n");
-    if (node->arguments != NULL) {
-        for (int i = 0; i < vector_size(node->arguments); i++) {
-            ExpressionNode* argument = (ExpressionNode*)vector_get(node->arguments, i);
-            printExpressionNode(file, argument, depth+2);
+    if (node->arguments.count > 0) {
+        for (uint32_t i = 0; i < node->arguments.count; i++) {
+            ExpressionNode* argument = &ast_node(pool, ast_child(pool, node->arguments, i))->data.expression;
+            printExpressionNode(file, pool, argument, depth+2);
         }
     } else {
         printSpaces(file, depth+2);
@@ -161,85 +161,85 @@ void printSubroutineCallNode(FILE* file, struct SubroutineCallNode* node, int de
 }
 
 
-void printDoStatementNode(FILE* file, struct DoStatementNode* node, int depth) {
+void printDoStatementNode(FILE* file, const ASTPool* pool, struct DoStatementNode* node, int depth) {
     writeToFile(file, "DoStatementNode\n");
 
     printSpaces(file, depth+1);
     writeToFile(file, "└─ subroutineCall: ");
-    printSubroutineCallNode(file, node->subroutineCall, depth+2);
+    printSubroutineCallNode(file, pool, &ast_node(pool, node->subroutineCall)->data.subroutineCall, depth+2);
 }
 
 
-void printReturnStatementNode(FILE* file, struct ReturnStatementNode* node, int depth) {
+void printReturnStatementNode(FILE* file, const ASTPool* pool, struct ReturnStatementNode* node, int depth) {
     writeToFile(file, "ReturnStatementNode\n");
 
     printSpaces(file, depth+1);
     writeToFile(file, "└─ expression: ");
-    if (node->expression != NULL) {
-        printExpressionNode(file, node->expression, depth+2);
+    if (node->expression != NODE_NONE) {
+        printExpressionNode(file, pool, &ast_node(pool, node->expression)->data.expression, depth+2);
     } else {
         writeToFile(file, "NULL\n");
     }
 }
 
 
-void printWhileStatementNode(FILE* file, struct WhileStatementNode* node, int depth) {
+void printWhileStatementNode(FILE* file, const ASTPool* pool, struct WhileStatementNode* node, int depth) {
     writeToFile(file, "WhileStatementNode\n");
 
     printSpaces(file, depth+1);
     writeToFile(file, "├─ condition: ");
-    printExpressionNode(file, node->condition, depth+2);
+    printExpressionNode(file, pool, &ast_node(pool, node->condition)->data.expression, depth+2);
 
     printSpaces(file, depth+1);
     writeToFile(file, "└─ body: ");
-    printStatementsNode(file, node->body, depth+2);
+    printStatementsNode(file, pool, &ast_node(pool, node->body)->data.statements, depth+2);
 }
 
 
-void printIfStatementNode(FILE* file, struct IfStatementNode* node, int depth) {
+void printIfStatementNode(FILE* file, const ASTPool* pool, struct IfStatementNode* node, int depth) {
     writeToFile(file, "IfStatementNode\n");
 
     printSpaces(file, depth+1);
     writeToFile(file, "├─ condition: ");
-    printExpressionNode(file, node->condition, depth+2);
+    printExpressionNode(file, pool, &ast_node(pool, node->condition)->data.expression, depth+2);
 
     printSpaces(file, depth+1);
     writeToFile(file, "├─ ifBranch: \n");
-    printStatementsNode(file, node->ifBranch, depth+2);
+    printStatementsNode(file, pool, &ast_node(pool, node->ifBranch)->data.statements, depth+2);
 
     printSpaces(file, depth+1);
     writeToFile(file, "└─ elseBranch: \n");
-    if (node->elseBranch != NULL) {
-        printStatementsNode(file, node->elseBranch, depth+2);
+    if (node->elseBranch != NODE_NONE) {
+        printStatementsNode(file, pool, &ast_node(pool, node->elseBranch)->data.statements, depth+2);
     } else {
         writeToFile(file, "NULL\n");
     }
 }
 
 
-void printLetStatementNode(FILE* file, struct LetStatementNode* node, int depth) {
+void printLetStatementNode(FILE* file, const ASTPool* pool, struct LetStatementNode* node, int depth) {
     writeToFile(file, "LetStatementNode\n");
 
     printSpaces(file, depth+1);
     writeToFile(file, "├─ varName: ");
-    writeToFile(file, node->varName);
+    writeToFile(file, atom_str(node->varName));
     writeToFile(file, "\n");
 
     printSpaces(file, depth+1);
     writeToFile(file, "├─ indexExpression: ");
-    if (node->indexExpression != NULL) {
-        printExpressionNode(file, node->indexExpression, depth+2);
+    if (node->indexExpression != NODE_NONE) {
+        printExpressionNode(file, pool, &ast_node(pool, node->indexExpression)->data.expression, depth+2);
     } else {
         writeToFile(file, "NULL\n");
     }
 
     printSpaces(file, depth+1);
     writeToFile(file, "└─ rightExpression: ");
-    printExpressionNode(file, node->rightExpression, depth+2);
+    printExpressionNode(file, pool, &ast_node(pool, node->rightExpression)->data.expression, depth+2);
 }
 
 
-void printStatementNode(FILE* file, struct StatementNode* node, int depth) {
+void printStatementNode(FILE* file, const ASTPool* pool, struct StatementNode* node, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "StatementNode\n");
 
@@ -271,19 +271,19 @@ void printStatementNode(FILE* file, struct StatementNode* node, int depth) {
     writeToFile(file, "└─ Data: ");
     switch (node->statementType) {
         case LET:
-            printLetStatementNode(file, node->data.letStatement, depth+2);
+            printLetStatementNode(file, pool, &ast_node(pool, node->data.letStatement)->data.letStatement, depth+2);
             break;
         case IF:
-            printIfStatementNode(file, node->data.ifStatement, depth+2);
+            printIfStatementNode(file, pool, &ast_node(pool, node->data.ifStatement)->data.ifStatement, depth+2);
             break;
         case WHILE:
-            printWhileStatementNode(file, node->data.whileStatement, depth+2);
+            printWhileStatementNode(file, pool, &ast_node(pool, node->data.whileStatement)->data.whileStatement, depth+2);
             break;
         case DO:
-            printDoStatementNode(file, node->data.doStatement, depth+2);
+            printDoStatementNode(file, pool, &ast_node(pool, node->data.doStatement)->data.doStatement, depth+2);
             break;
         case RETURN:
-            printReturnStatementNode(file, node->data.returnStatement, depth+2);
+            printReturnStatementNode(file, pool, &ast_node(pool, node->data.returnStatement)->data.returnStatement, depth+2);
             break;
         default:
             break;
@@ -291,18 +291,17 @@ void printStatementNode(FILE* file, struct StatementNode* node, int depth) {
 }
 
 
-void printVarDecNode(FILE* file, struct VarDecNode* node, int depth) {
+void printVarDecNode(FILE* file, const ASTPool* pool, struct VarDecNode* node, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "VarDecNode\n");
 
     printSpaces(file, depth+1);
     writeToFile(file, "├─ Type: ");
-    writeToFile(file, node->varType);
+    writeToFile(file, atom_str(node->varType));
     writeToFile(file, "\n");
 
-    int size = vector_size(node->varNames);
-    for (int i = 0; i < size; ++i) {
-        char* name = (char*) vector_get(node->varNames, i);
+    for (uint32_t i = 0; i < node->varNames.count; ++i) {
+        const char* name = atom_str(ast_name(pool, node->varNames, i));
         printSpaces(file, depth+1);
         writeToFile(file, "└─ Name: ");
         writeToFile(file, name);
@@ -310,26 +309,24 @@ void printVarDecNode(FILE* file, struct VarDecNode* node, int depth) {
     }
 }
 
-void printStatementsNode(FILE* file, struct StatementsNode* node, int depth) {
+void printStatementsNode(FILE* file, const ASTPool* pool, struct StatementsNode* node, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "StatementsNode\n");
 
-    int size = vector_size(node->statements);
-    for (int i = 0; i < size; ++i) {
-        StatementNode* statement = (StatementNode*) vector_get(node->statements, i);
-        printStatementNode(file, statement, depth+1);
+    for (uint32_t i = 0; i < node->statements.count; ++i) {
+        StatementNode* statement = &ast_node(pool, ast_child(pool, node->statements, i))->data.statement;
+        printStatementNode(file, pool, statement, depth+1);
     }
 }
 
 
-void printParameterListNode(FILE* file, struct ParameterListNode* node, int depth) {
+void printParameterListNode(FILE* file, const ASTPool* pool, struct ParameterListNode* node, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "ParameterListNode\n");
 
-    int size = vector_size(node->parameterTypes);
-    for (int i = 0; i < size; ++i) {
-        char* type = (char*) vector_get(node->parameterTypes, i);
-        char* name = (char*) vector_get(node->parameterNames, i);
+    for (uint32_t i = 0; i < num_parameters(node); ++i) {
+        const char* type = atom_str(parameter_type(pool, node, i));
+        const char* name = atom_str(parameter_name(pool, node, i));
         printSpaces(file, depth+1);
         writeToFile(file, "├─ Type: ");
         writeToFile(file, type);
@@ -341,20 +338,19 @@ void printParameterListNode(FILE* file, struct ParameterListNode* node, int dept
     }
 }
 
-void printSubroutineBodyNode(FILE* file, struct SubroutineBodyNode* node, int depth) {
+void printSubroutineBodyNode(FILE* file, const ASTPool* pool, struct SubroutineBodyNode* node, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "SubroutineBodyNode\n");
 
-    int size = vector_size(node->varDecs);
-    for (int i = 0; i < size; ++i) {
-        VarDecNode* varDec = (VarDecNode*) vector_get(node->varDecs, i);
-        printVarDecNode(file, varDec, depth+1);
+    for (uint32_t i = 0; i < node->varDecs.count; ++i) {
+        VarDecNode* varDec = &ast_node(pool, ast_child(pool, node->varDecs, i))->data.varDec;
+        printVarDecNode(file, pool, varDec, depth+1);
     }
-    printStatementsNode(file, node->statements, depth+1);
+    printStatementsNode(file, pool, &ast_node(pool, node->statements)->data.statements, depth+1);
 }
 
 
-void printClassVarDecNode(FILE* file, struct ClassVarDecNode* node, int depth) {
+void printClassVarDecNode(FILE* file, const ASTPool* pool, struct ClassVarDecNode* node, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "├─ classVarModifier: ");
     switch (node->classVarModifier) {
@@ -365,17 +361,17 @@ void printClassVarDecNode(FILE* file, struct ClassVarDecNode* node, int depth) {
     writeToFile(file, "\n");
     printSpaces(file, depth);
     writeToFile(file, "├─ varType: ");
-    writeToFile(file, node->varType);
+    writeToFile(file, atom_str(node->varType));
     writeToFile(file, "\n");
-    for (int i = 0; i < vector_size(node->varNames); i++) {
+    for (uint32_t i = 0; i < node->varNames.count; i++) {
         printSpaces(file, depth);
         writeToFile(file, "├─ varName: ");
-        writeToFile(file, (char*)vector_get(node->varNames, i));
+        writeToFile(file, atom_str(ast_name(pool, node->varNames, i)));
         writeToFile(file, "\n");
     }
 }
 
-void printSubroutineDecNode(FILE* file, struct SubroutineDecNode* node, int depth) {
+void printSubroutineDecNode(FILE* file, const ASTPool* pool, struct SubroutineDecNode* node, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "├─ subroutineType: ");
     switch (node->subroutineType) {
@@ -388,60 +384,61 @@ void printSubroutineDecNode(FILE* file, struct SubroutineDecNode* node, int dept
     
     printSpaces(file, depth);
     writeToFile(file, "├─ returnType: ");
-    writeToFile(file, node->returnType);
+    writeToFile(file, atom_str(node->returnType));
     writeToFile(file, "\n");
     
     printSpaces(file, depth);
     writeToFile(file, "├─ subroutineName: ");
-    writeToFile(file, node->subroutineName);
+    writeToFile(file, atom_str(node->subroutineName));
     writeToFile(file, "\n");
     
     // Print the parameters if present
-    if (node->parameters != NULL) {
+    if (node->parameters != NODE_NONE) {
         printSpaces(file, depth);
         writeToFile(file, "├─ Parameters\n");
-        printParameterListNode(file, node->parameters, depth + 1);
+        printParameterListNode(file, pool, &ast_node(pool, node->parameters)->data.parameterList, depth + 1);
     }
     
     // Print the body if present
-    if (node->body != NULL) {
+    if (node->body != NODE_NONE) {
         printSpaces(file, depth);
         writeToFile(file, "├─ SubroutineBody\n");
-        printSubroutineBodyNode(file, node->body, depth + 1);
+        printSubroutineBodyNode(file, pool, &ast_node(pool, node->body)->data.subroutineBody, depth + 1);
     }
     
     // Continue for other fields and child nodes...
 }
 
-void printClassNode(FILE* file, struct ClassNode* node, int depth) {
+void printClassNode(FILE* file, const ASTPool* pool, struct ClassNode* node, int depth) {
     printSpaces(file, depth);
     writeToFile(file, "├─ className: ");
-    writeToFile(file, node->className);
+    writeToFile(file, atom_str(node->className));
     writeToFile(file, "\n");
     
-    for (int i = 0; i < vector_size(node->classVarDecs); i++) {
+    for (uint32_t i = 0; i < node->classVarDecs.count; i++) {
         printSpaces(file, depth);
         writeToFile(file, "├─ ClassVarDecNode\n");
-        printClassVarDecNode(file, (struct ClassVarDecNode*)vector_get(node->classVarDecs, i), depth + 1);
+        printClassVarDecNode(file, pool, &ast_node(pool, ast_child(pool, node->classVarDecs, i))->data.classVarDec, depth + 1);
     }
     
-    for (int i = 0; i < vector_size(node->subroutineDecs); i++) {
+    for (uint32_t i = 0; i < node->subroutineDecs.count; i++) {
         printSpaces(file, depth);
         writeToFile(file, "├─ SubroutineDecNode\n");
-        printSubroutineDecNode(file, (struct SubroutineDecNode*)vector_get(node->subroutineDecs, i), depth + 1);
+        printSubroutineDecNode(file, pool, &ast_node(pool, ast_child(pool, node->subroutineDecs, i))->data.subroutineDec, depth + 1);
     }
 }
 
 void printProgramNode(FILE* file, struct ProgramNode* node, int depth) {
     writeToFile(file, "ProgramNode\n");
-    for (int i = 0; i < vector_size(node->classes); i++) {
+    for (uint32_t i = 0; i < node->classes->size; i++) {
+        const ASTPool* pool = *(ASTPool**) small_vec_at(node->classes, i);
         printSpaces(file, depth);
         writeToFile(file, "├─ ClassNode\n");
-        printClassNode(file, (struct ClassNode*)vector_get(node->classes, i), depth + 1);
+        printClassNode(file, pool, &ast_node(pool, pool->root)->data.classDec, depth + 1);
     }
 }
 
-void print_class(ClassNode* node) {
+void print_class(const ASTPool* pool) {
     buffer = safer_malloc(BUFFER_SIZE * sizeof(char));
     FILE* file = fopen("ast.txt", "w");
     if (file == NULL) {
@@ -454,7 +451,7 @@ void print_class(ClassNode* node) {
     } else {
         perror("getcwd() error");
     }
-    printClassNode(file, node, 0);
+    printClassNode(file, pool, &ast_node(pool, pool->root)->data.classDec, 0);
     flushBuffer(file);
     fclose(file);
     free(buffer);
@@ -0,0 +1,647 @@
+#include "class_cache.h"
+#include "logger.h"
+#include "safer.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+typedef struct {
+    const char* jack_path;
+    const char* vm_path;
+    char* cache_path;
+    uint64_t source_hash;
+    bool has_entry;      // an entry for the current source was loaded and the .vm file exists
+    bool stale;          // the entry exists but the interface of a dependency changed
+    bool from_ast;       // interface and references were taken from a freshly parsed class
+    uint64_t key;        // key the cached .vm was generated with
+    char* class_name;
+    char* interface;     // serialized interface, see `write_interface`
+    uint64_t interface_hash;
+    vector references;   // sorted, unique class names mentioned by the class
+} CacheEntry;
+
+struct ClassCache {
+    size_t num_files;
+    CacheEntry* entries;
+    uint64_t stdlib_hash;
+};
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} StringBuilder;
+
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t len) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint64_t hash_string(uint64_t hash, const char* str) {
+    // Include the terminator so that ("ab", "c") and ("a", "bc") differ
+    return hash_bytes(hash, str, strlen(str) + 1);
+}
+
+static void sb_append(StringBuilder* sb, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    if (sb->len + needed + 1 > sb->cap) {
+        size_t cap = sb->cap ? sb->cap : 256;
+        while (sb->len + needed + 1 > cap) {
+            cap *= 2;
+        }
+        sb->data = realloc(sb->data, cap);
+        if (!sb->data) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                                "['%s'] : Could not grow the string builder", __func__);
+            return;
+        }
+        sb->cap = cap;
+    }
+
+    va_start(args, format);
+    vsnprintf(sb->data + sb->len, needed + 1, format, args);
+    va_end(args);
+    sb->len += needed;
+}
+
+/**
+ * Read a whole file, NULL if it does not exist. Unlike `read_file_into_string`
+ * a missing file is not an error here, it only means there is nothing cached.
+ */
+static char* read_optional_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    char* buffer = safer_malloc(size + 1);
+    size_t read = fread(buffer, 1, size, file);
+    fclose(file);
+    buffer[read] = '\0';
+    if (length) {
+        *length = read;
+    }
+    return buffer;
+}
+
+static char* cache_path_for(const char* jack_path) {
+    const char* slash = strrchr(jack_path, '/');
+    const char* base = slash ? slash + 1 : jack_path;
+    int dir_len = slash ? (int) (slash - jack_path) : 1;
+    const char* dir = slash ? jack_path : ".";
+
+    size_t len = strlen(jack_path) + strlen(CLASS_CACHE_DIR) + 16;
+    char* path = safer_malloc(len);
+    snprintf(path, len, "%.*s/%s/%s.cache", dir_len, dir, CLASS_CACHE_DIR, base);
+    return path;
+}
+
+static void free_references(CacheEntry* entry) {
+    if (entry->references) {
+        for (int i = 0; i < vector_size(entry->references); ++i) {
+            free(vector_get(entry->references, i));
+        }
+        vector_destroy(entry->references);
+        entry->references = NULL;
+    }
+}
+
+static int compare_strings(const void* a, const void* b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+
+/**
+ * Sort the references and drop duplicates, so they can be binary searched and are stored once.
+ */
+static void normalize_references(vector references) {
+    int size = vector_size(references);
+    if (size == 0) {
+        return;
+    }
+
+    char** names = safer_malloc(sizeof(char*) * size);
+    for (int i = 0; i < size; ++i) {
+        names[i] = vector_get(references, i);
+    }
+    qsort(names, size, sizeof(char*), compare_strings);
+
+    while (vector_size(references) > 0) {
+        vector_pop(references);
+    }
+    for (int i = 0; i < size; ++i) {
+        if (vector_size(references) > 0 && strcmp(vector_get(references, vector_size(references) - 1), names[i]) == 0) {
+            free(names[i]);
+        } else {
+            vector_push(references, names[i]);
+        }
+    }
+    free(names);
+}
+
+/**
+ * Parse a cache entry. Returns false if the file is missing, from another cache version or was written
+ * for a different source, in which case the class has to be compiled.
+ */
+static bool load_entry(CacheEntry* entry) {
+    char* content = read_optional_file(entry->cache_path, NULL);
+    if (!content) {
+        return false;
+    }
+
+    char* save = NULL;
+    char* line = strtok_r(content, "\n", &save);
+    int version = 0;
+    unsigned long long source_hash = 0;
+    unsigned long long key = 0;
+    int num_references = 0;
+    bool ok = line && sscanf(line, "jackcache %d", &version) == 1 && version == CLASS_CACHE_VERSION;
+
+    ok = ok && (line = strtok_r(NULL, "\n", &save)) && sscanf(line, "source %llx", &source_hash) == 1
+            && source_hash == entry->source_hash;
+    ok = ok && (line = strtok_r(NULL, "\n", &save)) && sscanf(line, "key %llx", &key) == 1;
+    ok = ok && (line = strtok_r(NULL, "\n", &save)) && sscanf(line, "references %d", &num_references) == 1;
+
+    vector references = vector_create();
+    for (int i = 0; ok && i < num_references; ++i) {
+        ok = (line = strtok_r(NULL, "\n", &save)) != NULL;
+        if (ok) {
+            vector_push(references, strdup(line));
+        }
+    }
+
+    // The interface is the rest of the file, kept verbatim so it hashes the same as when it was written
+    ok = ok && (line = strtok_r(NULL, "\n", &save)) && strcmp(line, "interface") == 0;
+    char* interface = ok ? save : NULL;
+    char class_name[256];
+    ok = ok && interface && sscanf(interface, "class %255s", class_name) == 1;
+
+    if (!ok) {
+        for (int i = 0; i < vector_size(references); ++i) {
+            free(vector_get(references, i));
+        }
+        vector_destroy(references);
+        free(content);
+        return false;
+    }
+
+    entry->key = key;
+    entry->references = references;
+    entry->interface = strdup(interface);
+    entry->interface_hash = hash_string(FNV_OFFSET_BASIS, entry->interface);
+    entry->class_name = strdup(class_name);
+    free(content);
+    return true;
+}
+
+/**
+ * @brief Hash every source and load the cache entries that are still valid for it.
+ *
+ * @param jack_files - paths of the .jack files, the cache lives in a `.jackcache/` directory next to each of them
+ * @param jack_vm_files - the .vm file generated for each .jack file
+ * @param stdlib_hash - hash of the OS class signatures, every key depends on them
+ */
+ClassCache* init_class_cache(vector jack_files, vector jack_vm_files, uint64_t stdlib_hash) {
+    ClassCache* cache = safer_malloc(sizeof(ClassCache));
+    cache->num_files = vector_size(jack_files);
+    cache->entries = calloc(cache->num_files ? cache->num_files : 1, sizeof(CacheEntry));
+    cache->stdlib_hash = stdlib_hash;
+
+    size_t reused = 0;
+    for (size_t i = 0; i < cache->num_files; ++i) {
+        CacheEntry* entry = &cache->entries[i];
+        entry->jack_path = vector_get(jack_files, i);
+        entry->vm_path = vector_get(jack_vm_files, i);
+        entry->cache_path = cache_path_for(entry->jack_path);
+
+        size_t length = 0;
+        char* source = read_optional_file(entry->jack_path, &length);
+        entry->source_hash = source ? hash_bytes(FNV_OFFSET_BASIS, source, length) : 0;
+        free(source);
+
+        entry->has_entry = source && access(entry->vm_path, F_OK) == 0 && load_entry(entry);
+        reused += entry->has_entry;
+    }
+
+    log_message(LOG_LEVEL_INFO, ERROR_NONE, "Class cache : %zu of %zu sources unchanged\n", reused, cache->num_files);
+    return cache;
+}
+
+bool class_cache_needs_parse(const ClassCache* cache, size_t index) {
+    const CacheEntry* entry = &cache->entries[index];
+    return !entry->has_entry || entry->stale;
+}
+
+static void write_interface(StringBuilder* sb, const ASTPool* pool) {
+    ClassNode* class_dec = &ast_node(pool, pool->root)->data.classDec;
+    sb_append(sb, "class %s\n", atom_str(class_dec->className));
+
+    for (uint32_t i = 0; i < class_dec->classVarDecs.count; ++i) {
+        ClassVarDecNode* var_dec = &ast_node(pool, ast_child(pool, class_dec->classVarDecs, i))->data.classVarDec;
+        const char* modifier = var_dec->classVarModifier == STATIC ? "static" : "field";
+        for (uint32_t j = 0; j < var_dec->varNames.count; ++j) {
+            sb_append(sb, "%s %s %s\n", modifier, atom_str(var_dec->varType),
+                      atom_str(ast_name(pool, var_dec->varNames, j)));
+        }
+    }
+
+    for (uint32_t i = 0; i < class_dec->subroutineDecs.count; ++i) {
+        SubroutineDecNode* sub_dec = &ast_node(pool, ast_child(pool, class_dec->subroutineDecs, i))->data.subroutineDec;
+        const char* kind = sub_dec->subroutineType == CONSTRUCTOR ? "constructor"
+                         : sub_dec->subroutineType == METHOD ? "method" : "function";
+        sb_append(sb, "%s %s %s\n", kind, atom_str(sub_dec->returnType), atom_str(sub_dec->subroutineName));
+
+        ParameterListNode* params = &ast_node(pool, sub_dec->parameters)->data.parameterList;
+        for (uint32_t j = 0; j < num_parameters(params); ++j) {
+            sb_append(sb, "arg %s %s\n", atom_str(parameter_type(pool, params, j)),
+                      atom_str(parameter_name(pool, params, j)));
+        }
+    }
+}
+
+/**
+ * @brief Serialized interface of a parsed class, see `write_interface`. The caller frees the string.
+ */
+char* class_interface(const ASTPool* pool) {
+    StringBuilder sb = {0};
+    write_interface(&sb, pool);
+    return sb.data;
+}
+
+static void add_reference(vector references, Atom name) {
+    if (name != ATOM_NONE) {
+        vector_push(references, strdup(atom_str(name)));
+    }
+}
+
+static void collect_list_references(const ASTPool* pool, NodeList list, vector references);
+
+/**
+ * Collect every name in an expression tree that can refer to another class : callers of
+ * subroutine calls and the class part of `Class.member` terms.
+ */
+static void collect_references(const ASTPool* pool, NodeId id, vector references) {
+    ASTNode* node = ast_node(pool, id);
+    if (!node) {
+        return;
+    }
+
+    switch (node->nodeType) {
+        case NODE_STATEMENTS:
+            collect_list_references(pool, node->data.statements.statements, references);
+            break;
+        case NODE_STATEMENT:
+            switch (node->data.statement.statementType) {
+                case LET:
+                    collect_references(pool, node->data.statement.data.letStatement, references);
+                    break;
+                case IF:
+                    collect_references(pool, node->data.statement.data.ifStatement, references);
+                    break;
+                case WHILE:
+                    collect_references(pool, node->data.statement.data.whileStatement, references);
+                    break;
+                case DO:
+                    collect_references(pool, node->data.statement.data.doStatement, references);
+                    break;
+                case RETURN:
+                    collect_references(pool, node->data.statement.data.returnStatement, references);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case NODE_LET_STATEMENT:
+            collect_references(pool, node->data.letStatement.indexExpression, references);
+            collect_references(pool, node->data.letStatement.rightExpression, references);
+            break;
+        case NODE_IF_STATEMENT:
+            collect_references(pool, node->data.ifStatement.condition, references);
+            collect_references(pool, node->data.ifStatement.ifBranch, references);
+            collect_references(pool, node->data.ifStatement.elseBranch, references);
+            break;
+        case NODE_WHILE_STATEMENT:
+            collect_references(pool, node->data.whileStatement.condition, references);
+            collect_references(pool, node->data.whileStatement.body, references);
+            break;
+        case NODE_DO_STATEMENT:
+            collect_references(pool, node->data.doStatement.subroutineCall, references);
+            break;
+        case NODE_RETURN_STATEMENT:
+            collect_references(pool, node->data.returnStatement.expression, references);
+            break;
+        case NODE_SUBROUTINE_CALL:
+            add_reference(references, node->data.subroutineCall.caller);
+            collect_list_references(pool, node->data.subroutineCall.arguments, references);
+            break;
+        case NODE_EXPRESSION:
+            collect_references(pool, node->data.expression.term, references);
+            collect_list_references(pool, node->data.expression.operations, references);
+            break;
+        case NODE_OPERATION:
+            collect_references(pool, node->data.operation.term, references);
+            break;
+        case NODE_TERM:
+            switch (node->data.term.termType) {
+                case VAR_TERM:
+                    collect_references(pool, node->data.term.data.varTerm, references);
+                    break;
+                case ARRAY_ACCESS:
+                    collect_references(pool, node->data.term.data.arrayAccess.index, references);
+                    break;
+                case SUBROUTINE_CALL:
+                    collect_references(pool, node->data.term.data.subroutineCall, references);
+                    break;
+                case EXPRESSION:
+                    collect_references(pool, node->data.term.data.expression, references);
+                    break;
+                case UNARY_OP:
+                    collect_references(pool, node->data.term.data.unaryOp.term, references);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case NODE_VAR_TERM:
+            add_reference(references, node->data.varTerm.className);
+            break;
+        default:
+            break;
+    }
+}
+
+static void collect_list_references(const ASTPool* pool, NodeList list, vector references) {
+    for (uint32_t i = 0; i < list.count; ++i) {
+        collect_references(pool, ast_child(pool, list, i), references);
+    }
+}
+
+/**
+ * The class names a class mentions : every declared type and every caller. Only names of other user
+ * classes end up as dependencies, the OS classes are covered by the stdlib hash.
+ */
+static vector class_references(const ASTPool* pool) {
+    vector references = vector_create();
+    ClassNode* class_dec = &ast_node(pool, pool->root)->data.classDec;
+
+    for (uint32_t i = 0; i < class_dec->classVarDecs.count; ++i) {
+        add_reference(references, ast_node(pool, ast_child(pool, class_dec->classVarDecs, i))->data.classVarDec.varType);
+    }
+
+    for (uint32_t i = 0; i < class_dec->subroutineDecs.count; ++i) {
+        SubroutineDecNode* sub_dec = &ast_node(pool, ast_child(pool, class_dec->subroutineDecs, i))->data.subroutineDec;
+        add_reference(references, sub_dec->returnType);
+
+        ParameterListNode* params = &ast_node(pool, sub_dec->parameters)->data.parameterList;
+        for (uint32_t j = 0; j < num_parameters(params); ++j) {
+            add_reference(references, parameter_type(pool, params, j));
+        }
+
+        SubroutineBodyNode* body = &ast_node(pool, sub_dec->body)->data.subroutineBody;
+        for (uint32_t j = 0; j < body->varDecs.count; ++j) {
+            add_reference(references, ast_node(pool, ast_child(pool, body->varDecs, j))->data.varDec.varType);
+        }
+        collect_references(pool, body->statements, references);
+    }
+
+    normalize_references(references);
+    return references;
+}
+
+static void fill_entry_from_ast(CacheEntry* entry, const ASTPool* pool) {
+    free(entry->interface);
+    free(entry->class_name);
+    free_references(entry);
+
+    entry->interface = class_interface(pool);
+    entry->interface_hash = hash_string(FNV_OFFSET_BASIS, entry->interface);
+    entry->class_name = strdup(atom_str(ast_node(pool, pool->root)->data.classDec.className));
+    entry->references = class_references(pool);
+    entry->from_ast = true;
+}
+
+typedef struct {
+    const char* name;
+    size_t index;
+} ClassName;
+
+static int compare_class_names(const void* a, const void* b) {
+    return strcmp(((const ClassName*) a)->name, ((const ClassName*) b)->name);
+}
+
+/**
+ * Sorted (name, file index) pairs of every class whose interface is known.
+ */
+static ClassName* sorted_class_names(const ClassCache* cache, size_t* count) {
+    ClassName* names = safer_malloc(sizeof(ClassName) * (cache->num_files ? cache->num_files : 1));
+    *count = 0;
+    for (size_t i = 0; i < cache->num_files; ++i) {
+        if (cache->entries[i].class_name) {
+            names[(*count)++] = (ClassName) {cache->entries[i].class_name, i};
+        }
+    }
+    qsort(names, *count, sizeof(ClassName), compare_class_names);
+    return names;
+}
+
+/**
+ * key = H(version, stdlib, source, (name, interface hash) of every dependency in name order)
+ */
+static uint64_t compute_key(const ClassCache* cache, size_t index, const ClassName* names, size_t num_names) {
+    const CacheEntry* entry = &cache->entries[index];
+    uint64_t key = hash_bytes(FNV_OFFSET_BASIS, &(int) {CLASS_CACHE_VERSION}, sizeof(int));
+    key = hash_bytes(key, &cache->stdlib_hash, sizeof(uint64_t));
+    key = hash_bytes(key, &entry->source_hash, sizeof(uint64_t));
+
+    // References are sorted, so the dependencies are visited in name order
+    for (int i = 0; i < vector_size(entry->references); ++i) {
+        ClassName probe = {vector_get(entry->references, i), 0};
+        const ClassName* found = bsearch(&probe, names, num_names, sizeof(ClassName), compare_class_names);
+        if (found && found->index != index) {
+            const CacheEntry* dependency = &cache->entries[found->index];
+            key = hash_string(key, dependency->class_name);
+            key = hash_bytes(key, &dependency->interface_hash, sizeof(uint64_t));
+        }
+    }
+    return key;
+}
+
+/**
+ * @brief Once every changed class is parsed, check the cached classes against the current interfaces
+ * of their dependencies. Cached classes whose key no longer matches are marked stale.
+ *
+ * @param classes - the parsed class for every file index, NULL for classes taken from the cache
+ * @return the number of classes that became stale and still have to be parsed
+ */
+size_t class_cache_resolve(ClassCache* cache, ASTPool** classes) {
+    for (size_t i = 0; i < cache->num_files; ++i) {
+        if (classes[i] && !cache->entries[i].from_ast) {
+            fill_entry_from_ast(&cache->entries[i], classes[i]);
+        }
+    }
+
+    size_t num_names = 0;
+    ClassName* names = sorted_class_names(cache, &num_names);
+
+    size_t stale = 0;
+    for (size_t i = 0; i < cache->num_files; ++i) {
+        CacheEntry* entry = &cache->entries[i];
+        if (!classes[i] && entry->has_entry && compute_key(cache, i, names, num_names) != entry->key) {
+            entry->stale = true;
+            stale++;
+        }
+    }
+
+    free(names);
+    log_message(LOG_LEVEL_INFO, ERROR_NONE, "Class cache : %zu cached classes invalidated by their dependencies\n", stale);
+    return stale;
+}
+
+/**
+ * @brief Add the symbols of a serialized class interface to the global table, the same symbols the BUILD pass
+ * would add for the class. Every table and symbol of the class, including its entry in the global table,
+ * is allocated from `arena`.
+ */
+void add_class_interface(SymbolTable* global_table, const char* class_interface, Arena* arena) {
+    char* interface = strdup(class_interface);
+    Arena* global_arena = global_table->arena;
+    global_table->arena = arena;
+    SymbolTable* class_table = NULL;
+    SymbolTable* sub_table = NULL;
+
+    char* save = NULL;
+    for (char* line = strtok_r(interface, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        char what[16], type[256], name[256];
+        if (sscanf(line, "class %255s", name) == 1) {
+            class_table = create_table(SCOPE_CLASS, global_table, arena);
+            symbol_table_add(global_table, intern_str(name), intern_str(name), KIND_CLASS)->childTable = class_table;
+        } else if (class_table && sscanf(line, "%15s %255s %255s", what, type, name) == 3) {
+            Atom name_atom = intern_str(name);
+            Atom type_atom = intern_str(type);
+            if (strcmp(what, "static") == 0) {
+                symbol_table_add(class_table, name_atom, type_atom, KIND_STATIC);
+            } else if (strcmp(what, "field") == 0) {
+                symbol_table_add(class_table, name_atom, type_atom, KIND_FIELD);
+            } else if (strcmp(what, "arg") == 0 && sub_table) {
+                symbol_table_add(sub_table, name_atom, type_atom, KIND_ARG);
+            } else {
+                Kind kind = strcmp(what, "constructor") == 0 ? KIND_CONSTRUCTOR
+                          : strcmp(what, "method") == 0 ? KIND_METHOD : KIND_FUNCTION;
+                Scope scope = kind == KIND_CONSTRUCTOR ? SCOPE_CONSTRUCTOR
+                            : kind == KIND_METHOD ? SCOPE_METHOD : SCOPE_FUNCTION;
+                sub_table = create_table(scope, class_table, arena);
+                symbol_table_add(class_table, name_atom, type_atom, kind)->childTable = sub_table;
+            }
+        }
+    }
+
+    global_table->arena = global_arena;
+    free(interface);
+}
+
+void class_cache_add_interface(const ClassCache* cache, size_t index, SymbolTable* global_table) {
+    add_class_interface(global_table, cache->entries[index].interface, global_table->arena);
+}
+
+static void ensure_cache_dir(const char* cache_path) {
+    char* dir = strdup(cache_path);
+    char* slash = strrchr(dir, '/');
+    if (slash) {
+        *slash = '\0';
+        if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+            log_message(LOG_LEVEL_WARNING, ERROR_OPEN_DIRECTORY, "Could not create cache directory '%s'\n", dir);
+        }
+    }
+    free(dir);
+}
+
+static void store_entry(const CacheEntry* entry, uint64_t key) {
+    ensure_cache_dir(entry->cache_path);
+
+    size_t tmp_len = strlen(entry->cache_path) + 5;
+    char* tmp_path = safer_malloc(tmp_len);
+    snprintf(tmp_path, tmp_len, "%s.tmp", entry->cache_path);
+
+    FILE* file = fopen(tmp_path, "w");
+    if (!file) {
+        log_message(LOG_LEVEL_WARNING, ERROR_FILE_OPEN, "Could not write cache entry '%s'\n", tmp_path);
+        free(tmp_path);
+        return;
+    }
+
+    fprintf(file, "jackcache %d\n", CLASS_CACHE_VERSION);
+    fprintf(file, "source %016llx\n", (unsigned long long) entry->source_hash);
+    fprintf(file, "key %016llx\n", (unsigned long long) key);
+    fprintf(file, "references %d\n", vector_size(entry->references));
+    for (int i = 0; i < vector_size(entry->references); ++i) {
+        fprintf(file, "%s\n", (char*) vector_get(entry->references, i));
+    }
+    fprintf(file, "interface\n%s", entry->interface);
+
+    // Readers only ever see a complete entry
+    if (fclose(file) != 0 || rename(tmp_path, entry->cache_path) != 0) {
+        log_message(LOG_LEVEL_WARNING, ERROR_FILE_WRITE, "Could not write cache entry '%s'\n", entry->cache_path);
+        remove(tmp_path);
+    }
+    free(tmp_path);
+}
+
+/**
+ * @brief Record the classes compiled in this run. Must only be called after their .vm files were generated
+ * without errors.
+ */
+void class_cache_store(ClassCache* cache, ASTPool** classes) {
+    for (size_t i = 0; i < cache->num_files; ++i) {
+        if (classes[i] && !cache->entries[i].from_ast) {
+            fill_entry_from_ast(&cache->entries[i], classes[i]);
+        }
+    }
+
+    size_t num_names = 0;
+    ClassName* names = sorted_class_names(cache, &num_names);
+
+    for (size_t i = 0; i < cache->num_files; ++i) {
+        if (classes[i]) {
+            store_entry(&cache->entries[i], compute_key(cache, i, names, num_names));
+        }
+    }
+
+    free(names);
+}
+
+void destroy_class_cache(ClassCache* cache) {
+    if (!cache) {
+        return;
+    }
+
+    for (size_t i = 0; i < cache->num_files; ++i) {
+        CacheEntry* entry = &cache->entries[i];
+        free(entry->cache_path);
+        free(entry->class_name);
+        free(entry->interface);
+        free_references(entry);
+    }
+    free(cache->entries);
+    free(cache);
+}
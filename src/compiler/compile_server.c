@@ -0,0 +1,401 @@
+#include "compile_server.h"
+#include "class_cache.h"
+#include "logger.h"
+#include "safer.h"
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define REQUEST_ARENA_PAGES 128
+#define RESIDENT_ARENA_PAGES 4
+
+/**
+ * A class compiled by an earlier request, kept as the symbols of its interface.
+ */
+typedef struct {
+    char* class_name;
+    char* jack_path;
+    char* interface;
+    Arena* arena;    // owns the class symbol and all of its tables
+    Symbol* symbol;  // entry in the global table
+} ResidentClass;
+
+typedef struct {
+    CompilerState* state;
+    vector residents;
+    int listen_fd;
+    int results;  // in the process compiling a request, where the interfaces of its classes are sent
+} CompileServer;
+
+static ResidentClass* init_resident(const char* class_name, const char* jack_path, char* interface) {
+    ResidentClass* resident = safer_malloc(sizeof(ResidentClass));
+    resident->class_name = strdup(class_name);
+    resident->jack_path = strdup(jack_path);
+    resident->interface = interface;
+    resident->arena = NULL;
+    resident->symbol = NULL;
+    return resident;
+}
+
+static void destroy_resident(ResidentClass* resident) {
+    if (resident->arena) {
+        destroy_arena(resident->arena);
+    }
+    free(resident->class_name);
+    free(resident->jack_path);
+    free(resident->interface);
+    free(resident);
+}
+
+static void detach_symbol(SymbolTable* global_table, Symbol* symbol) {
+    for (int i = 0; i < vector_size(global_table->symbols); ++i) {
+        if (vector_get(global_table->symbols, i) == symbol) {
+            vector_remove(global_table->symbols, i);
+            return;
+        }
+    }
+}
+
+static bool write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= (size_t) n;
+    }
+    return true;
+}
+
+/**
+ * @brief Send the class to the server as its name, its file and its interface, each terminated by a '\0'.
+ */
+static void on_class_compiled(void* ctx, size_t file_index, ASTPool* class_pool) {
+    CompileServer* server = ctx;
+    const char* class_name = atom_str(ast_node(class_pool, class_pool->root)->data.classDec.className);
+    const char* jack_path = vector_get(server->state->jack_files, file_index);
+    char* interface = class_interface(class_pool);
+    write_all(server->results, class_name, strlen(class_name) + 1);
+    write_all(server->results, jack_path, strlen(jack_path) + 1);
+    write_all(server->results, interface, strlen(interface) + 1);
+    free(interface);
+}
+
+static void make_resident(CompileServer* server, ResidentClass* resident) {
+    resident->arena = init_arena(RESIDENT_ARENA_PAGES);
+    arena_register(resident->arena, "resident");
+    add_class_interface(server->state->global_table, resident->interface, resident->arena);
+    resident->symbol = vector_get(server->state->global_table->symbols,
+                                  vector_size(server->state->global_table->symbols) - 1);
+    vector_push(server->residents, resident);
+}
+
+/**
+ * A resident is replaced when its file is sent again, or when another file declares a class of the same name.
+ */
+static bool replaced_by_request(const ResidentClass* resident, vector jack_files) {
+    for (int i = 0; i < vector_size(jack_files); ++i) {
+        const char* path = vector_get(jack_files, i);
+        const char* base = get_filename_from_path(path);
+        size_t name_len = strlen(resident->class_name);
+        if (strcmp(path, resident->jack_path) == 0
+            || (strncmp(base, resident->class_name, name_len) == 0 && strcmp(base + name_len, ".jack") == 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static char* read_all(int fd, size_t* length) {
+    size_t len = 0;
+    size_t cap = 1024;
+    char* data = safer_malloc(cap);
+    ssize_t n;
+    while ((n = read(fd, data + len, cap - len - 1)) > 0) {
+        len += (size_t) n;
+        if (len + 1 == cap) {
+            cap *= 2;
+            data = realloc(data, cap);
+        }
+    }
+    data[len] = '\0';
+    *length = len;
+    return data;
+}
+
+static char* read_request(int fd) {
+    size_t len;
+    return read_all(fd, &len);
+}
+
+/**
+ * @brief Turn the request into `state->jack_files` and `state->jack_vm_files`.
+ * @return false (and report to the client) if one of the files cannot be compiled
+ */
+static bool set_request_files(CompilerState* state, char* request, FILE* reply) {
+    bool valid = true;
+    char* save = NULL;
+    for (char* line = strtok_r(request, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        size_t len = strlen(line);
+        if (len < 5 || strcmp(line + len - 5, ".jack") != 0 || access(line, R_OK) != 0) {
+            fprintf(reply, "Cannot compile '%s'\n", line);
+            valid = false;
+            continue;
+        }
+
+        char* vm_path = safer_malloc(len - 1);
+        memcpy(vm_path, line, len - 5);
+        strcpy(vm_path + len - 5, ".vm");
+        vector_push(state->jack_files, strdup(line));
+        vector_push(state->jack_vm_files, vm_path);
+    }
+    state->num_of_files = vector_size(state->jack_files);
+    return valid && state->num_of_files > 0;
+}
+
+static void clear_request_files(CompilerState* state) {
+    while (vector_size(state->jack_files) > 0) {
+        free(vector_pop(state->jack_files));
+        free(vector_pop(state->jack_vm_files));
+    }
+    state->num_of_files = 0;
+}
+
+/**
+ * @brief Compile the files of the request in the forked process, with stdout and stderr going to the client,
+ * and exit with its status. A fatal diagnostic or a crash only ends this process.
+ */
+static _Noreturn void compile_request(CompileServer* server, int client) {
+    CompilerState* state = server->state;
+    close(server->listen_fd);
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGHUP, SIG_DFL);
+
+    // The classes sent again are compiled against the new sources only
+    for (int i = 0; i < vector_size(server->residents); ++i) {
+        ResidentClass* resident = vector_get(server->residents, i);
+        if (replaced_by_request(resident, state->jack_files)) {
+            detach_symbol(state->global_table, resident->symbol);
+        }
+    }
+
+    dup2(client, STDOUT_FILENO);
+    dup2(client, STDERR_FILENO);
+
+    ThreadPool* pool = init_compiler_pool(state, state->num_of_files);
+    bool success = compile_files(state, pool, on_class_compiled, server);
+    destroy_thread_pool(pool);
+
+    fflush(stdout);
+    fflush(stderr);
+    _exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/**
+ * @brief Compile the files of one request in a child process and, if it succeeds, make its classes resident.
+ * Diagnostics go to the client, the compiler writes them to stderr.
+ */
+static bool serve_request(CompileServer* server, char* request, int client) {
+    CompilerState* state = server->state;
+    FILE* reply = fdopen(dup(client), "w");
+
+    if (!set_request_files(state, request, reply)) {
+        clear_request_files(state);
+        fclose(reply);
+        return false;
+    }
+
+    int results[2];
+    fflush(stdout);
+    fflush(stderr);
+    pid_t child = pipe(results) == 0 ? fork() : -1;
+    if (child == 0) {
+        close(results[0]);
+        server->results = results[1];
+        compile_request(server, client);
+    }
+    if (child < 0) {
+        fprintf(reply, "Could not start the compilation of the request\n");
+        clear_request_files(state);
+        fclose(reply);
+        return false;
+    }
+
+    close(results[1]);
+    size_t length;
+    char* compiled = read_all(results[0], &length);
+    close(results[0]);
+
+    int status;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {
+    }
+    bool success = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+    if (WIFSIGNALED(status)) {
+        fprintf(reply, "The compilation of the request was killed by signal %d\n", WTERMSIG(status));
+    }
+
+    if (success) {
+        for (int i = vector_size(server->residents) - 1; i >= 0; --i) {
+            ResidentClass* resident = vector_get(server->residents, i);
+            if (replaced_by_request(resident, state->jack_files)) {
+                detach_symbol(state->global_table, resident->symbol);
+                destroy_resident(vector_remove(server->residents, i));
+            }
+        }
+        for (const char* entry = compiled; entry < compiled + length;) {
+            const char* class_name = entry;
+            const char* jack_path = class_name + strlen(class_name) + 1;
+            const char* interface = jack_path + strlen(jack_path) + 1;
+            entry = interface + strlen(interface) + 1;
+            make_resident(server, init_resident(class_name, jack_path, strdup(interface)));
+        }
+    }
+
+    free(compiled);
+    clear_request_files(state);
+    fclose(reply);
+    return success;
+}
+
+static int open_server_socket(const char* socket_path) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_SOCKET, __FILE__, __LINE__,
+                            "['%s'] : Socket path '%s' is too long", __func__, socket_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path);
+    if (fd < 0 || bind(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_SOCKET, __FILE__, __LINE__,
+                            "['%s'] : Could not listen on '%s'", __func__, socket_path);
+        return -1;
+    }
+    return fd;
+}
+
+// The socket is removed however the server exits, a stale one would turn every later client away
+static char* listening_path = NULL;
+static pid_t server_pid;
+
+static void remove_server_socket(void) {
+    // Requests are compiled in forked children, which share the atexit handlers
+    if (listening_path && getpid() == server_pid) {
+        unlink(listening_path);
+        free(listening_path);
+        listening_path = NULL;
+    }
+}
+
+static void stop_on_signal(int sig) {
+    if (listening_path) {
+        unlink(listening_path);
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+/**
+ * @brief Serve compile requests on `socket_path` until a client sends `COMPILE_SERVER_STOP`.
+ */
+int run_compile_server(CompilerState* state, const char* socket_path) {
+    init_compiler_runtime(state);
+    // Residents already play the role of the on-disk cache
+    state->incremental = false;
+
+    signal(SIGPIPE, SIG_IGN);
+    CompileServer server = {
+        .state = state,
+        .residents = vector_create(),
+        .listen_fd = open_server_socket(socket_path),
+        .results = -1,
+    };
+
+    listening_path = strdup(socket_path);
+    server_pid = getpid();
+    atexit(remove_server_socket);
+    signal(SIGINT, stop_on_signal);
+    signal(SIGTERM, stop_on_signal);
+    signal(SIGHUP, stop_on_signal);
+    log_message(LOG_LEVEL_INFO, ERROR_NONE, "Compile server listening on '%s'\n", socket_path);
+
+    bool running = true;
+    while (running) {
+        int client = accept(server.listen_fd, NULL, NULL);
+        if (client < 0) {
+            log_message(LOG_LEVEL_WARNING, ERROR_SOCKET, "Failed to accept a client on '%s'\n", socket_path);
+            continue;
+        }
+
+        char* request = read_request(client);
+        if (strncmp(request, COMPILE_SERVER_STOP, strlen(COMPILE_SERVER_STOP)) == 0) {
+            running = false;
+            dprintf(client, "status ok\n");
+        } else {
+            bool success = serve_request(&server, request, client);
+            dprintf(client, "status %s\n", success ? "ok" : "failed");
+        }
+        free(request);
+        close(client);
+    }
+
+    close(server.listen_fd);
+    remove_server_socket();
+
+    while (vector_size(server.residents) > 0) {
+        destroy_resident(vector_pop(server.residents));
+    }
+    vector_destroy(server.residents);
+    if (state->arena_stats) {
+        print_arena_stats();
+    }
+    destroy_pass_timer();
+    close_log_file();
+    vector_destroy(state->class_arenas);
+    destroy_arena(state->arena);
+    return 0;
+}
+
+/**
+ * @brief Send `args` (file paths, or `COMPILE_SERVER_STOP`) to the server and print its reply.
+ * @return 0 if the server reported success
+ */
+int run_compile_client(const char* socket_path, int num_args, char** args) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "Could not connect to compile server '%s'\n", socket_path);
+        return 1;
+    }
+
+    // The server may run in another directory
+    for (int i = 0; i < num_args; ++i) {
+        char path[PATH_MAX];
+        const char* line = strcmp(args[i], COMPILE_SERVER_STOP) != 0 && realpath(args[i], path) ? path : args[i];
+        dprintf(fd, "%s\n", line);
+    }
+    shutdown(fd, SHUT_WR);
+
+    char* reply = read_request(fd);
+    close(fd);
+
+    const char* status = strstr(reply, "status ok\n");
+    bool success = status && status[strlen("status ok\n")] == '\0';
+    fputs(reply, stderr);
+    free(reply);
+    return success ? 0 : 1;
+}
@@ -4,13 +4,19 @@
 #include "ast.h"
 #include "logger.h"
 #include "vector.h"
+#include "thread_pool.h"
+#include "class_cache.h"
+#include "stdlib_table.h"
+#include "pass_timer.h"
 #include <dirent.h>
+#include <sys/stat.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 CompilerState *init_compiler() {
   Arena *arena = init_arena(128);
+  arena_register(arena, "compiler");
   CompilerState *state = arena_alloc(arena, sizeof(CompilerState));
   state->jack_files = vector_create();
   state->jack_vm_files = vector_create();
@@ -19,6 +25,16 @@ CompilerState *init_compiler() {
   state->vm_filename = NULL;
   state->vm_ptr = NULL;
   state->global_table = create_table(SCOPE_GLOBAL, NULL, arena);
+  state->num_threads = 0;
+  state->pipeline = false;
+  state->chunk_size = 0;
+  state->parallel_lex = false;
+  state->pull = false;
+  state->incremental = false;
+  state->time_passes = TIME_PASSES_NONE;
+  state->arena_stats = false;
+  state->input_dir = NULL;
+  state->class_arenas = vector_create();
   return state;
 }
 
@@ -54,11 +70,10 @@ const char *remove_ext(const char *myStr) {
 
 int find_jack_files(const char *dir_name, CompilerState *state) {
 
-  char name_buf[128];
+  char name_buf[1024];
   memset(name_buf, 0, sizeof name_buf);
 
-  // Point directly to the Pong1 subdirectory
-  snprintf(name_buf, sizeof(name_buf), "%s/Pong", dir_name);
+  snprintf(name_buf, sizeof(name_buf), "%s", dir_name);
 
   DIR *dir = opendir(name_buf);
   if (dir == NULL) {
@@ -113,64 +128,343 @@ int find_jack_files(const char *dir_name, CompilerState *state) {
   return 1;
 }
 
-int compile(CompilerState *state) {
+/*
+ * Front end work shared between the pool workers. Every slot is written by exactly one
+ * task, so no locking is needed - the merge into the program node happens afterwards.
+ */
+typedef struct {
+  CompilerState *state;
+  ASTPool **classes;
+  Arena **arenas;
+  size_t *files; // file index of every task
+  Lexer **lexers;         // files already lexed in chunks, with `parallel_lex`
+  Arena **token_arenas;   // the arenas of their tokens
+} FrontEndJob;
+
+// Tokens only live until their file is parsed, the AST lives until the end of compilation.
+// With `pipeline` the lexer runs on its own thread and only a ring of tokens is alive at a time.
+// With `chunk_size` only a window of the source is in memory, the lexer copies the lexemes out of it.
+// The lexemes move while it runs, so a chunked lexer does not stream.
+// With `parallel_lex` a large file is lexed in chunks on the whole compiler pool before the files are parsed,
+// the tokens are stitched before parsing.
+// With `pull` the parser drives the lexer, which only fills a window of tokens each time the parser runs dry.
+#define TOKEN_ARENA_PAGES 16
+#define CLASS_ARENA_PAGES 128
+
+static Arena *init_token_arena() {
+  Arena *tokenArena = init_arena(TOKEN_ARENA_PAGES);
+  arena_register(tokenArena, "tokens");
+  return tokenArena;
+}
 
-  initialize_eq_classes();
-  initialize_logger_arena();
+static void lex_and_parse_file(void *ctx, size_t task) {
+  FrontEndJob *job = ctx;
+  size_t index = job->files[task];
+  Arena *classArena = init_arena(CLASS_ARENA_PAGES);
+  arena_register(classArena, "class");
+
+  const char *path = vector_get(job->state->jack_files, index);
+  pass_timer_set_file(index);
+  bool streaming = job->state->pipeline && job->state->chunk_size == 0 && !job->state->parallel_lex &&
+                   !job->state->pull;
+  // Large files are already lexed in chunks with `parallel_lex`, see `lex_large_files`
+  Lexer *lexer = job->lexers[index];
+  Arena *tokenArena = lexer ? job->token_arenas[index] : init_token_arena();
+  if (!lexer) {
+    if (job->state->chunk_size > 0) {
+      lexer = init_chunked_lexer(path, job->state->chunk_size, tokenArena);
+    } else if (job->state->pull) {
+      lexer = init_pull_lexer(path, tokenArena);
+    } else {
+      lexer = streaming ? init_streaming_lexer(path, tokenArena) : init_lexer(path, tokenArena);
+    }
+  }
+  Parser *parser = init_parser(lexer->queue, classArena);
+  PassSample parse = pass_timer_start();
+  job->classes[index] = parse_class(parser);
+  pass_timer_stop(PASS_PARSE, parse);
+  job->arenas[index] = classArena;
+
+  if (streaming) {
+    finish_streaming_lexer(lexer);
+  } else if (job->state->pull) {
+    finish_pull_lexer(lexer);
+  }
 
-  char buf[256];
-  snprintf(buf, sizeof(buf), "%s/stdlib.json", JACK_FILES_DIR);
-  const char *stdlib_json = read_file_into_string(buf);
-  find_jack_files(JACK_FILES_DIR, state);
+  destroy_lexer(lexer);
+  destroy_arena(tokenArena);
+}
 
-  log_message(LOG_LEVEL_INFO, ERROR_NONE, "Finished finding files\n");
-  vector jack_os_classes = parse_jack_stdlib_from_json(stdlib_json, state->arena);
-  log_message(LOG_LEVEL_INFO, ERROR_NONE, "Finished parsing stdlib_json\n");
-  add_stdlib_table(state->global_table, jack_os_classes);
+/**
+ * With `parallel_lex`, lex the files large enough to split one after the other, each in chunks on every thread of
+ * the pool. The pool runs one job at a time, so this happens before the files are handed to it for parsing.
+ */
+static void lex_large_files(FrontEndJob *job, ThreadPool *pool, size_t num_tasks) {
+  for (size_t task = 0; task < num_tasks; ++task) {
+    size_t index = job->files[task];
+    const char *path = vector_get(job->state->jack_files, index);
+    struct stat st;
+    if (stat(path, &st) != 0 || !parallel_lex_splits((size_t) st.st_size)) {
+      continue;
+    }
+    pass_timer_set_file(index);
+    job->token_arenas[index] = init_token_arena();
+    job->lexers[index] = init_parallel_lexer(path, pool, job->token_arenas[index]);
+    if (!job->lexers[index]) {
+      destroy_arena(job->token_arenas[index]);
+      job->token_arenas[index] = NULL;
+    }
+  }
+}
+
+/**
+ * Lex and parse every jack file that is not parsed yet and not served by the class cache,
+ * each on its own worker and into its own arena. Files share no state, every class lands
+ * in slot `classes[file index]`, keeping later passes deterministic.
+ */
+static void parse_files(CompilerState *state, ThreadPool *pool, ClassCache *cache, ASTPool **classes) {
+  size_t num_files = state->num_of_files;
+  FrontEndJob job = {
+      .state = state,
+      .classes = classes,
+      .arenas = safer_malloc(sizeof(Arena *) * (num_files ? num_files : 1)),
+      .files = safer_malloc(sizeof(size_t) * (num_files ? num_files : 1)),
+      .lexers = calloc(num_files ? num_files : 1, sizeof(Lexer *)),
+      .token_arenas = calloc(num_files ? num_files : 1, sizeof(Arena *)),
+  };
+
+  size_t num_tasks = 0;
+  for (size_t i = 0; i < num_files; ++i) {
+    if (!classes[i] && (!cache || class_cache_needs_parse(cache, i))) {
+      job.files[num_tasks++] = i;
+    }
+  }
+
+  if (state->parallel_lex) {
+    lex_large_files(&job, pool, num_tasks);
+  }
+  thread_pool_run(pool, num_tasks, lex_and_parse_file, &job);
+
+  for (size_t task = 0; task < num_tasks; ++task) {
+    vector_push(state->class_arenas, job.arenas[job.files[task]]);
+  }
+
+  log_message(LOG_LEVEL_INFO, ERROR_NONE, "Parsed %zu files on %zu threads\n", num_tasks, thread_pool_size(pool));
+  free(job.arenas);
+  free(job.files);
+  free(job.lexers);
+  free(job.token_arenas);
+}
+
+typedef struct {
+  CompilerState *state;
+  ASTNode *program_node;
+  vector vm_files; // output file of every class in the program node
+  size_t *files;   // file index of every class in the program node
+} GenerateJob;
+
+#define GENERATE_ARENA_PAGES 32
+
+/**
+ * Generate one class into its .vm file. The visitor (and with it the current class, the
+ * current table, the label counters and the output file) is private to this task, so labels
+ * are numbered per class and the output does not depend on which worker ran the class.
+ */
+static void generate_class_file(void *ctx, size_t index) {
+  GenerateJob *job = ctx;
+  ASTPool *class_pool = program_class(job->program_node, (uint32_t) index);
+  const char *vm_path = vector_get(job->vm_files, index);
+
+  pass_timer_set_file(job->files[index]);
+  Arena *genArena = init_arena(GENERATE_ARENA_PAGES);
+  arena_register(genArena, "generate");
+  ASTVisitor *visitor = init_ast_visitor(genArena, GENERATE, job->state->global_table);
+  PassSample io = pass_timer_start();
+  visitor->vmFile = fopen(vm_path, "w");
+  pass_timer_stop(PASS_IO, io);
+  if (visitor->vmFile == NULL) {
+    log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_FILE_OPEN, __FILE__, __LINE__,
+                        "['%s'] : Failed to open/create VM file > '%s'", __func__, vm_path);
+    destroy_ast_visitor(visitor);
+    destroy_arena(genArena);
+    return;
+  }
+  PassSample generate = pass_timer_start();
+  ast_class_accept(visitor, class_pool);
+  pass_timer_stop(PASS_GENERATE, generate);
+  io = pass_timer_start();
+  fclose(visitor->vmFile);
+  pass_timer_stop(PASS_IO, io);
+
+  destroy_ast_visitor(visitor);
+  destroy_arena(genArena);
+}
+
+/**
+ * Code generation only reads the symbol tables once ANALYZE has finished, so every class
+ * can be generated independently.
+ */
+static void generate_all_classes(CompilerState *state, ThreadPool *pool, ASTNode *program_node, vector vm_files,
+                                 size_t *files) {
+  GenerateJob job = {
+      .state = state,
+      .program_node = program_node,
+      .vm_files = vm_files,
+      .files = files,
+  };
+  thread_pool_run(pool, program_node->data.program.classes->size, generate_class_file, &job);
+  log_message(LOG_LEVEL_INFO, ERROR_NONE, "Generated %u classes on %zu threads\n",
+              program_node->data.program.classes->size, thread_pool_size(pool));
+}
+
+/**
+ * @brief Everything that does not depend on the files being compiled : the lexer tables, the logger
+ * and the OS classes in the global table. A compile server does this once for all of its requests.
+ */
+void init_compiler_runtime(CompilerState *state) {
+  initialize_eq_classes();
+  initialize_logger_arena();
 
-  ASTNode *program_node = init_ast_node(NODE_PROGRAM, state->arena);
+  PassSample stdlib = pass_timer_start();
+  add_stdlib_table(state->global_table, stdlib_classes, stdlib_num_classes);
+  pass_timer_stop(PASS_STDLIB, stdlib);
+  log_message(LOG_LEVEL_INFO, ERROR_NONE, "Finished adding the stdlib table\n");
+}
 
-  for (int i = 0; i < state->num_of_files; i++) {
-    Arena *fileArena = init_arena(16);
-    Lexer *lexer = init_lexer(vector_get(state->jack_files, i), fileArena);
-    Parser *parser = init_parser(lexer->queue, lexer->line_starts, state->arena);
-    ASTNode *class_node = parse_class(parser);
-    vector_push(program_node->data.program->classes, class_node);
+/**
+ * @brief Compile `state->jack_files` against the global table, print the diagnostics and release the ASTs.
+ * The program node and the symbol tables of the compiled classes are allocated from `state->arena`.
+ *
+ * @param on_compiled - optional, called for every class that was compiled once all .vm files are written
+ * @return true if there were no errors
+ */
+bool compile_files(CompilerState *state, ThreadPool *pool, ClassCompiledHook on_compiled, void *ctx) {
+  pass_timer_reset(state->num_of_files);
+  ASTNode *program_node = init_program_node(state->arena);
+
+  ClassCache *cache = state->incremental ? init_class_cache(state->jack_files, state->jack_vm_files, stdlib_hash) : NULL;
+  ASTPool **classes = calloc(state->num_of_files ? state->num_of_files : 1, sizeof(ASTPool *));
+
+  parse_files(state, pool, cache, classes);
+  if (cache && class_cache_resolve(cache, classes) > 0) {
+    // Unchanged sources whose dependencies changed interface
+    parse_files(state, pool, cache, classes);
+  }
 
-    destroy_lexer(lexer);
-    destroy_arena(fileArena);
-    destroy_parser(parser);
+  // Only parsed classes go through the passes, cached ones just contribute their symbols
+  vector vm_files = vector_create();
+  size_t *class_files = safer_malloc(sizeof(size_t) * (state->num_of_files ? state->num_of_files : 1));
+  for (size_t i = 0; i < state->num_of_files; ++i) {
+    if (classes[i]) {
+      class_files[vector_size(vm_files)] = i;
+      small_vec_push(program_node->data.program.classes, &classes[i]);
+      vector_push(vm_files, vector_get(state->jack_vm_files, i));
+    }
   }
 
+  // Classes are added to the global table in file order whether they are parsed or cached
   ASTVisitor *visitor = init_ast_visitor(state->arena, BUILD, state->global_table);
-  ast_node_accept(visitor, program_node);
+  for (size_t i = 0; i < state->num_of_files; ++i) {
+    pass_timer_set_file(i);
+    PassSample build = pass_timer_start();
+    if (classes[i]) {
+      ast_class_accept(visitor, classes[i]);
+    } else {
+      class_cache_add_interface(cache, i, state->global_table);
+    }
+    pass_timer_stop(PASS_BUILD, build);
+  }
   log_message(LOG_LEVEL_INFO, ERROR_NONE, "Finished building\n");
+
+  // Same as visiting the program node, one class at a time so the pass can be timed per file
   visitor->phase = ANALYZE;
-  ast_node_accept(visitor, program_node);
-
-  if(error_count() == 0) {
-      visitor->phase = GENERATE;
-
-      for(int i = 0 ; i < state->num_of_files; ++i) {
-          ASTNode* class_node = vector_get(program_node->data.program->classes, i);
-          visitor->vmFile =fopen((char*) vector_get(state->jack_vm_files, i), "w");
-          if (visitor->vmFile == NULL) {
-              log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_FILE_OPEN, __FILE__, __LINE__,"['%s'] : Failed to open/create VM file > '%s'", __func__,(char*) vector_get(state->jack_vm_files, i));
-          }
-          ast_node_accept(visitor, class_node);
-          fclose((visitor->vmFile));
-      }
+  for (uint32_t i = 0; i < program_node->data.program.classes->size; ++i) {
+    pass_timer_set_file(class_files[i]);
+    PassSample analyze = pass_timer_start();
+    ast_class_accept(visitor, program_class(program_node, i));
+    pass_timer_stop(PASS_ANALYZE, analyze);
   }
+  pass_timer_set_file(PASS_TIMER_NO_FILE);
 
-  //
+  destroy_ast_visitor(visitor);
+
+  bool success = error_count() == 0;
+  if (success) {
+      generate_all_classes(state, pool, program_node, vm_files, class_files);
+      if (cache) {
+        class_cache_store(cache, classes);
+      }
+      for (size_t i = 0; on_compiled && i < state->num_of_files; ++i) {
+        if (classes[i]) {
+          on_compiled(ctx, i, classes[i]);
+        }
+      }
+  }
+  destroy_class_cache(cache);
+  vector_destroy(vm_files);
+  free(class_files);
+  free(classes);
 
   print_all_errors();
   print_error_summary();
+  print_pass_times(state->jack_files, state->time_passes);
+
+  // The AST of a class, its node pool and lists included, goes away with its arena
+  for (int i = 0; i < vector_size(state->class_arenas); ++i) {
+    destroy_arena(vector_get(state->class_arenas, i));
+  }
+  while (vector_size(state->class_arenas) > 0) {
+    vector_pop(state->class_arenas);
+  }
+
+  return success;
+}
+
+/**
+ * One pool serves the front end and code generation. There is no point in more threads than files, or with
+ * `parallel_lex` than chunks of the largest file.
+ */
+ThreadPool *init_compiler_pool(const CompilerState *state, size_t num_files) {
+  size_t num_threads = state->num_threads ? state->num_threads : default_thread_count();
+  size_t max_threads = num_files;
+  if (state->parallel_lex) {
+    for (size_t index = 0; index < num_files; ++index) {
+      struct stat st;
+      if (stat(vector_get(state->jack_files, index), &st) == 0 &&
+          parallel_lex_max_chunks((size_t) st.st_size) > max_threads) {
+        max_threads = parallel_lex_max_chunks((size_t) st.st_size);
+      }
+    }
+  }
+  if (num_threads > max_threads) {
+    num_threads = max_threads ? max_threads : 1;
+  }
+  return init_thread_pool(num_threads);
+}
+
+/**
+ * @brief Compile the jack files of `state->input_dir` (Pong if there is none).
+ * @return the exit status of the compiler, EXIT_SUCCESS if there were no errors
+ */
+int compile(CompilerState *state) {
+
+  init_compiler_runtime(state);
+  find_jack_files(state->input_dir ? state->input_dir : JACK_FILES_DIR "/Pong", state);
+  log_message(LOG_LEVEL_INFO, ERROR_NONE, "Finished finding files\n");
+
+  ThreadPool *pool = init_compiler_pool(state, state->num_of_files);
+  bool success = compile_files(state, pool, NULL, NULL);
+  destroy_thread_pool(pool);
+
+  if (state->arena_stats) {
+    print_arena_stats();
+  }
 
   // clean up
+  destroy_pass_timer();
   close_log_file();
-  destroy_ast_node(program_node);
+  vector_destroy(state->class_arenas);
   destroy_arena(state->arena);
 
-  return 1;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
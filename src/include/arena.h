@@ -6,11 +6,31 @@
 
 typedef struct Arena Arena;
 
+/**
+ * Counters kept by every arena. `high_water` is the largest number of bytes in use at once,
+ * it survives `reset_arena`.
+ */
+typedef struct {
+    size_t bytes_reserved;
+    size_t bytes_requested;
+    size_t bytes_committed;
+    size_t num_allocations;
+    size_t num_commits;
+    size_t num_regions;
+    size_t alignment_waste;
+    size_t high_water;
+} ArenaStats;
+
 Arena* init_arena(size_t mutliplier);
 void* arena_alloc(Arena* arena, size_t size);
 void reset_arena(Arena* arena);
 char* arena_sprintf(Arena* arena, const char* format, ...);
 char* arena_strdup(Arena* arena, const char* src);
+char* arena_strndup(Arena* arena, const char* src, size_t len);
 void destroy_arena(Arena* arena);
 
+ArenaStats arena_stats(const Arena* arena);
+void arena_register(Arena* arena, const char* name);
+void print_arena_stats();
+
 #endif // ARENA_ALLOCATOR_H
\ No newline at end of file
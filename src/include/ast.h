@@ -2,6 +2,7 @@
 #define AST_H
 
 #include "symbol.h"
+#include "small_vec.h"
 
 
 #define PATH_TO_WR_DEF_FILE TOSTRING(DEF_FILES_DIR/writer.def)
@@ -23,6 +24,11 @@ typedef enum {
 
 typedef struct ASTNode ASTNode;
 
+/**
+ * The ASTPool holds every node of one class.
+ */
+typedef struct ASTPool ASTPool;
+
 /*
     The ProgramNode is the root node of the AST.
     It contains a vector of ClassNodes.
@@ -153,33 +159,20 @@ typedef enum {
     NODE_VAR_TERM
 } ASTNodeType;
 
-struct ASTNode {
-    ASTNodeType nodeType;
-    union {
-        ProgramNode* program;
-        ClassNode* classDec;
-        ClassVarDecNode* classVarDec;
-        SubroutineDecNode* subroutineDec;
-        ParameterListNode* parameterList;
-        SubroutineBodyNode* subroutineBody;
-        VarDecNode* varDec;
-        StatementsNode* statements;
-        StatementNode* statement;
-        LetStatementNode* letStatement;
-        IfStatementNode* ifStatement;
-        WhileStatementNode* whileStatement;
-        DoStatementNode* doStatement;
-        ReturnStatementNode* returnStatement;
-        SubroutineCallNode* subroutineCall;
-        ExpressionNode* expression;
-        TermNode* term;
-        Operation* operation;
-        VarTerm* varTerm;
-    } data;
-    const char* filename;
-    int line;
-    size_t byte_offset;
-};
+/**
+ * Nodes refer to each other by their index in the pool of their class, see `ASTPool`.
+ * NODE_NONE stands for a missing child.
+ */
+typedef uint32_t NodeId;
+#define NODE_NONE 0
+
+/**
+ * `count` children of a node, or names, stored from `start` on in the items of the pool.
+ */
+typedef struct {
+    uint32_t start;
+    uint32_t count;
+} NodeList;
 
 typedef enum {
     BUILD,
@@ -196,7 +189,8 @@ typedef struct {
     SymbolTable* currentTable;
     FILE* vmFile;
     Phase phase;
-    char* currentClassName;
+    Atom currentClassName;
+    ASTPool* pool;      // nodes of the class being visited
     vector labelCounters;
     Arena* arena;
 } ASTVisitor;
@@ -254,14 +248,14 @@ struct CodeGenerator {
 
 struct ProgramNode
 {
-    vector classes;
+    SmallVec* classes; // ASTPool*, one per class, see `program_class`
 };
 
 struct ClassNode
 {
-    char *className;
-    vector classVarDecs; // vector of ClassVarDecNode
-    vector subroutineDecs; // vector of SubroutineDecNode
+    Atom className;
+    NodeList classVarDecs; // ClassVarDecNodes
+    NodeList subroutineDecs; // SubroutineDecNodes
 };
 
 struct ClassVarDecNode
@@ -272,8 +266,8 @@ struct ClassVarDecNode
         STATIC,
         FIELD
     } classVarModifier;
-    char *varType;
-    vector varNames; // vector of char*
+    Atom varType;
+    NodeList varNames; // atoms
 };
 struct SubroutineDecNode
 {
@@ -284,31 +278,30 @@ struct SubroutineDecNode
         FUNCTION,
         METHOD
     } subroutineType;
-    char *returnType;
-    char *subroutineName;
-    ASTNode* parameters;
-    ASTNode* body;
+    Atom returnType;
+    Atom subroutineName;
+    NodeId parameters;
+    NodeId body;
 };
 struct ParameterListNode
 {
-    vector parameterTypes; // vector of char*
-    vector parameterNames; // vector of char*
+    NodeList parameters; // atoms, the type and the name of every parameter in turn, see `parameter_type`
 };
 
 struct SubroutineBodyNode
 {
-    vector varDecs; // vector of VarDecNode
-    ASTNode* statements;
+    NodeList varDecs; // VarDecNodes
+    NodeId statements;
 };
 
 struct VarDecNode
 {
-    char *varType;
-    vector varNames; // vector of char*
+    Atom varType;
+    NodeList varNames; // atoms
 };
 struct StatementsNode
 {
-    vector statements; //vector of StatementNode
+    NodeList statements; // StatementNodes
 };
 
 struct StatementNode
@@ -324,66 +317,66 @@ struct StatementNode
     } statementType;
     union
     {
-        ASTNode* letStatement;
-        ASTNode* ifStatement;
-        ASTNode* whileStatement;
-        ASTNode* doStatement;
-        ASTNode* returnStatement;
+        NodeId letStatement;
+        NodeId ifStatement;
+        NodeId whileStatement;
+        NodeId doStatement;
+        NodeId returnStatement;
     } data;
 };
 
 struct LetStatementNode
 {
-    char *varName;
-    ASTNode *indexExpression; // NULL if not present
-    ASTNode *rightExpression;
+    Atom varName;
+    NodeId indexExpression; // NODE_NONE if not present
+    NodeId rightExpression;
 };
 
 struct IfStatementNode
 {
-    ASTNode* condition;
-    ASTNode* ifBranch;
-    ASTNode* elseBranch; // NULL if not present
+    NodeId condition;
+    NodeId ifBranch;
+    NodeId elseBranch; // NODE_NONE if not present
 };
 
 struct WhileStatementNode
 {
-    ASTNode* condition;
-    ASTNode* body;
+    NodeId condition;
+    NodeId body;
 };
 struct DoStatementNode
 {
-    ASTNode* subroutineCall;
+    NodeId subroutineCall;
 };
 
 struct ReturnStatementNode
 {
-    ASTNode* expression; // NULL if not present
+    NodeId expression; // NODE_NONE if not present
 };
 struct SubroutineCallNode
 {
-    char *caller; // This could be a varName or className. NULL if not present.
-    char *subroutineName;
-    vector arguments; // vector of ExpressionNode pointers - args
-    Type* type;
+    Atom caller; // This could be a varName or className. ATOM_NONE if not present.
+    Atom subroutineName;
+    NodeList arguments; // ExpressionNodes
+    Type type;
 };
 struct ExpressionNode
 {
-    ASTNode* term;
-    vector operations; // vector of Operation pointers - ops
-    Type* type;
+    NodeId term;
+    NodeList operations; // Operations
+    Type type;
 };
 struct Operation
 {
     char op; // Operator character
-    ASTNode* term;
+    NodeId term;
 };
 
 struct VarTerm
 {
-    char *className; // NULL if not present
-    char *varName;
-    Type* type;
+    Atom className; // ATOM_NONE if not present
+    Atom varName;
+    Type type;
 };
 struct TermNode
 {
@@ -403,29 +396,128 @@ struct TermNode
     {
         int intValue;
         char *stringValue;
-        char *keywordValue;
-        ASTNode* varTerm;
+        Atom keywordValue;
+        NodeId varTerm;
         struct
         {
-            char *arrayName;
-            ASTNode* index;
-            Type* type;
+            Atom arrayName;
+            NodeId index;
         } arrayAccess;
-        ASTNode* subroutineCall;
-        ASTNode* expression;
+        NodeId subroutineCall;
+        NodeId expression;
         struct
         {
             char unaryOp;
-            ASTNode* term;
+            NodeId term;
         } unaryOp;
     } data;
-    Type* type;
+    Type type;
 };
 
-ASTNode* init_ast_node(ASTNodeType type, Arena* arena);
+/**
+ * A node is a small fixed-size record, its payload is stored in place. Types are values, set during ANALYZE.
+ * The file a node comes from is that of its pool.
+ */
+struct ASTNode {
+    ASTNodeType nodeType;
+    int line;
+    uint32_t byte_offset; // see `ast_byte_offset`
+    union {
+        ProgramNode program;
+        ClassNode classDec;
+        ClassVarDecNode classVarDec;
+        SubroutineDecNode subroutineDec;
+        ParameterListNode parameterList;
+        SubroutineBodyNode subroutineBody;
+        VarDecNode varDec;
+        StatementsNode statements;
+        StatementNode statement;
+        LetStatementNode letStatement;
+        IfStatementNode ifStatement;
+        WhileStatementNode whileStatement;
+        DoStatementNode doStatement;
+        ReturnStatementNode returnStatement;
+        SubroutineCallNode subroutineCall;
+        ExpressionNode expression;
+        TermNode term;
+        Operation operation;
+        VarTerm varTerm;
+    } data;
+};
+
+_Static_assert(sizeof(ASTNode) <= 40, "AST nodes are 40 byte records");
+
+#define AST_CHUNK_BITS 8
+#define AST_CHUNK_SIZE ((uint32_t) 1 << AST_CHUNK_BITS)
+
+/**
+ * The nodes of one class. They are allocated in chunks of AST_CHUNK_SIZE records from the arena of the
+ * class, so a node never moves and a NodeId is its position in the pool. The entries of every NodeList of
+ * the class share the `items` array. The entries of a list being parsed are collected on `scratch` first,
+ * lists nested inside it are complete before it is, so each list is copied into `items` in one piece.
+ * Everything, the pool included, lives in the arena : the AST of a class goes away with its arena.
+ */
+struct ASTPool {
+    SmallVec chunks;            // ASTNode*
+    SmallVec items;             // uint32_t
+    SmallVec scratch;           // uint32_t
+    uint32_t num_nodes;         // NODE_NONE included
+    NodeId root;                // the class node
+    const char* filename;
+    Arena* arena;
+};
+
+static inline ASTNode* ast_node(const ASTPool* pool, NodeId id) {
+    if (id == NODE_NONE) {
+        return NULL;
+    }
+    return &((ASTNode**) pool->chunks.data)[id >> AST_CHUNK_BITS][id & (AST_CHUNK_SIZE - 1)];
+}
+
+static inline NodeId ast_child(const ASTPool* pool, NodeList list, uint32_t index) {
+    return ((const uint32_t*) pool->items.data)[list.start + index];
+}
+
+static inline Atom ast_name(const ASTPool* pool, NodeList list, uint32_t index) {
+    return (Atom) ((const uint32_t*) pool->items.data)[list.start + index];
+}
+
+static inline Atom parameter_type(const ASTPool* pool, const ParameterListNode* params, uint32_t index) {
+    return ast_name(pool, params->parameters, 2 * index);
+}
+
+static inline Atom parameter_name(const ASTPool* pool, const ParameterListNode* params, uint32_t index) {
+    return ast_name(pool, params->parameters, 2 * index + 1);
+}
+
+static inline uint32_t num_parameters(const ParameterListNode* params) {
+    return params->parameters.count / 2;
+}
+
+/**
+ * The offset diagnostics quote the line of `node` from, (size_t) -1 on the first line.
+ */
+static inline size_t ast_byte_offset(const ASTNode* node) {
+    return node->byte_offset == UINT32_MAX ? (size_t) -1 : node->byte_offset;
+}
+
+static inline ASTPool* program_class(const ASTNode* program, uint32_t index) {
+    return *(ASTPool**) small_vec_at(program->data.program.classes, index);
+}
+
+ASTPool* init_ast_pool(const char* filename, Arena* arena);
+NodeId ast_new_node(ASTPool* pool, ASTNodeType type);
+uint32_t ast_list_begin(const ASTPool* pool);
+void ast_list_push(ASTPool* pool, uint32_t item);
+NodeList ast_list_end(ASTPool* pool, uint32_t mark);
+void ast_list_split(ASTPool* pool, uint32_t mark, ASTNodeType type, NodeList* matching, NodeList* others);
+
+ASTNode* init_program_node(Arena* arena);
+size_t ast_nodes_created();
 ASTVisitor* init_ast_visitor(Arena* arena, Phase initialPhase, SymbolTable* globalTable);
-void ast_node_accept(ASTVisitor *visitor, ASTNode *node);
-void destroy_ast_node(ASTNode* node);
+void destroy_ast_visitor(ASTVisitor* visitor);
+void ast_node_accept(ASTVisitor *visitor, NodeId node);
+void ast_class_accept(ASTVisitor *visitor, ASTPool *pool);
 
 void execute_build_function(ASTVisitor* visitor, ASTNode* node);
 void execute_analyze_function(ASTVisitor* visitor, ASTNode* node);
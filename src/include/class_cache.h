@@ -0,0 +1,32 @@
+#ifndef CLASS_CACHE_H
+#define CLASS_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ast.h"
+
+#define CLASS_CACHE_DIR ".jackcache"
+#define CLASS_CACHE_VERSION 1
+
+/**
+ * On-disk cache for incremental compilation, one entry per class in a `.jackcache/` directory next to its source.
+ *
+ * An entry records the hash of the class source, the class interface (every class-level symbol and the
+ * arguments of every subroutine), the identifiers the class refers to, and the key its .vm file was generated with.
+ * The key combines the source hash with the interface hashes of the classes the class depends on - the classes it names,
+ * or whose members it names. A class whose source and key are unchanged keeps its .vm file and is never lexed or
+ * parsed, its symbols come from the cached interface instead.
+ */
+typedef struct ClassCache ClassCache;
+
+ClassCache* init_class_cache(vector jack_files, vector jack_vm_files, uint64_t stdlib_hash);
+bool class_cache_needs_parse(const ClassCache* cache, size_t index);
+size_t class_cache_resolve(ClassCache* cache, ASTPool** classes);
+void class_cache_add_interface(const ClassCache* cache, size_t index, SymbolTable* global_table);
+void class_cache_store(ClassCache* cache, ASTPool** classes);
+void destroy_class_cache(ClassCache* cache);
+
+char* class_interface(const ASTPool* pool);
+void add_class_interface(SymbolTable* global_table, const char* class_interface, Arena* arena);
+
+#endif // CLASS_CACHE_H
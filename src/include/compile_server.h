@@ -0,0 +1,24 @@
+#ifndef COMPILE_SERVER_H
+#define COMPILE_SERVER_H
+
+#include "refac_compiler.h"
+
+#define COMPILE_SERVER_STOP "--stop"
+
+/**
+ * A long-running compiler listening on a Unix domain socket.
+ *
+ * The lexer tables, the logger and the OS classes in the global table are set up once.
+ * A request is the list of .jack files to compile, one absolute path per line, and the reply is the diagnostics
+ * followed by a `status ok` or `status failed` line. The .vm files are written next to their sources.
+ * Each request is compiled by a forked copy of the server with its own thread pool, a fatal diagnostic or a
+ * crash only fails that request.
+ *
+ * Every class compiled successfully stays resident as its interface (see `class_interface`), so later requests
+ * only send the files that changed and still resolve calls into the rest of the program. A class sent again
+ * replaces its resident interface; if the request fails, the previous interfaces are kept.
+ */
+int run_compile_server(CompilerState* state, const char* socket_path);
+int run_compile_client(const char* socket_path, int num_args, char** args);
+
+#endif // COMPILE_SERVER_H
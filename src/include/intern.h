@@ -0,0 +1,32 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "error.h"
+
+#define PATH_TO_ATOM_DEF_FILE TOSTRING(DEF_FILES_DIR/atoms.def)
+
+/**
+ * Every distinct identifier and type name is stored once, process wide, and referred to by its atom.
+ * Two names are equal exactly when their atoms are, so symbol lookups and type checks compare integers.
+ *
+ * The table may be used from any thread. Interned strings live until the process exits.
+ */
+typedef uint32_t Atom;
+
+// Names the compiler itself refers to, interned first so their atoms are constants
+#define ATOM(name, str_repr) name,
+enum {
+    ATOM_NONE,  // no name, `atom_str` gives NULL
+    #include PATH_TO_ATOM_DEF_FILE
+    NUM_PREDEFINED_ATOMS
+};
+#undef ATOM
+
+Atom intern(const char* str, size_t len);
+Atom intern_str(const char* str);
+const char* atom_str(Atom atom);
+size_t interned_count();
+
+#endif // INTERN_H
@@ -0,0 +1,81 @@
+#ifndef LEXER_SCAN_H
+#define LEXER_SCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Loops skipping the runs of bytes that keep the lexer DFA in the same state without emitting a token.
+ * Every loop returns the position of the first byte at or after `pos` that ends the run. The NUL at the end of
+ * the input always ends a run, and so does '\n', so the lexer still sees every byte that changes its line.
+ *
+ * Comment bodies are the only runs long enough for wide loads to pay off, they go through kernels chosen at
+ * startup, see lexer_scan.c. The vector kernels only issue aligned loads, which never cross into the page after
+ * the NUL. Whitespace, identifiers, numbers and strings are a few bytes and stay scalar.
+ */
+typedef size_t (*ScanFn)(const char* input, size_t pos);
+
+typedef enum {
+    SCAN_KERNEL_SCALAR,
+    SCAN_KERNEL_SSE2,
+    SCAN_KERNEL_AVX2,
+} ScanKernel;
+
+typedef struct {
+    ScanFn line_comment;    // to '\n'
+    ScanFn block_comment;   // to '*' or '\n'
+} ScanKernels;
+
+extern ScanKernels scan_kernels;
+
+ScanKernel best_scan_kernel();
+bool use_scan_kernel(ScanKernel kernel);
+const char* scan_kernel_name(ScanKernel kernel);
+
+static inline bool scan_is_identifier_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Past ' ', '\t' and '\r'
+static inline size_t scan_whitespace(const char* input, size_t pos) {
+    while (input[pos] == ' ' || input[pos] == '\t' || input[pos] == '\r') {
+        pos++;
+    }
+    return pos;
+}
+
+// Past [A-Za-z0-9_]
+static inline size_t scan_identifier(const char* input, size_t pos) {
+    while (scan_is_identifier_char(input[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+// Past [0-9]
+static inline size_t scan_digits(const char* input, size_t pos) {
+    while (input[pos] >= '0' && input[pos] <= '9') {
+        pos++;
+    }
+    return pos;
+}
+
+// To '\n'
+static inline size_t scan_line_comment(const char* input, size_t pos) {
+    return scan_kernels.line_comment(input, pos);
+}
+
+// To '*' or '\n'
+static inline size_t scan_block_comment(const char* input, size_t pos) {
+    return scan_kernels.block_comment(input, pos);
+}
+
+// To '"' or '\n'
+static inline size_t scan_string(const char* input, size_t pos) {
+    while (input[pos] != '"' && input[pos] != '\n' && input[pos] != '\0') {
+        pos++;
+    }
+    return pos;
+}
+
+#endif // LEXER_SCAN_H
@@ -1,8 +1,10 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#define log_error_no_offset(phase, code, filename, line, format, ...) log_error_internal(phase, code, filename, line, SIZE_MAX, format, ##__VA_ARGS__)
-#define log_error_with_offset(phase, code, filename, line, byte_offset, format, ...) log_error_internal(phase, code, filename, line, byte_offset, format, ##__VA_ARGS__)
+#define log_error_no_offset(phase, code, filename, line, format, ...) log_error_internal(phase, code, NULL, filename, line, SIZE_MAX, format, ##__VA_ARGS__)
+#define log_error_with_offset(phase, code, filename, line, byte_offset, format, ...) log_error_internal(phase, code, NULL, filename, line, byte_offset, format, ##__VA_ARGS__)
+// The offending line is quoted from `source`, the buffer the file was lexed from, instead of the file
+#define log_error_in_source(phase, code, source, filename, line, byte_offset, format, ...) log_error_internal(phase, code, source, filename, line, byte_offset, format, ##__VA_ARGS__)
 
 
 #include <stdarg.h>  
@@ -10,6 +12,7 @@
 #include <stdlib.h>
 #include "error.h"
 #include "arena.h"
+#include "source_buffer.h"
 
 typedef enum {
     LOG_LEVEL_ERROR,
@@ -24,8 +27,11 @@ extern Arena* loggerArena;
 
 void log_message(LogLevel level, ErrorCode code, const char* format, ...);
 char* get_line_from_file(const char* filepath, size_t byte_offset, Arena* arena);
+char* get_line_from_source(const SourceBuffer* source, size_t byte_offset, Arena* arena);
+void release_diagnostic_source();
 const char* get_filename_from_path(const char* filepath);
-void log_error_internal(ErrorPhase phase, ErrorCode code, const char* filepath, int line, size_t byte_offset, char* format, ...);
+void log_error_internal(ErrorPhase phase, ErrorCode code, const SourceBuffer* source, const char* filepath, int line,
+                        size_t byte_offset, char* format, ...);
 void close_log_file();
 void initialize_logger_arena();
 void destroy_logger_arena();
@@ -0,0 +1,51 @@
+#ifndef PASS_TIMER_H
+#define PASS_TIMER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "error.h"
+#include "vector.h"
+
+#define PATH_TO_PASS_DEF_FILE TOSTRING(DEF_FILES_DIR/passes.def)
+
+#define PASS(name, str_repr) name,
+typedef enum {
+    #include PATH_TO_PASS_DEF_FILE
+    PASS_COUNT
+} Pass;
+#undef PASS
+
+typedef enum {
+    TIME_PASSES_NONE,
+    TIME_PASSES_TEXT,
+    TIME_PASSES_JSON
+} TimePassesFormat;
+
+// Not tied to an input file, e.g. loading the stdlib
+#define PASS_TIMER_NO_FILE SIZE_MAX
+
+typedef struct {
+    uint64_t wall_ns;
+    uint64_t cpu_ns;   // CPU time of the calling thread
+} PassSample;
+
+/**
+ * Wall-clock and CPU time spent in every pass, per input file (`--time-passes`).
+ *
+ * Time is attributed to the file the calling thread is working on, see `pass_timer_set_file`. Passes of
+ * different files run on different threads, so the totals are the sum over files and can exceed the wall-clock
+ * time of the whole compilation. When the timer is disabled, starting and stopping a pass costs one branch.
+ */
+extern bool pass_timer_enabled;
+
+void init_pass_timer();
+void pass_timer_reset(size_t num_files);
+void pass_timer_set_file(size_t file_index);
+size_t pass_timer_current_file();
+PassSample pass_timer_start();
+void pass_timer_stop(Pass pass, PassSample start);
+void print_pass_times(vector files, TimePassesFormat format);
+void destroy_pass_timer();
+
+#endif // PASS_TIMER_H
@@ -2,6 +2,8 @@
 #define REFAC_COMPILER_H
 
 #include "refac_parser.h"
+#include "thread_pool.h"
+#include "pass_timer.h"
 
 typedef struct {
     Arena* arena;
@@ -11,8 +13,26 @@ typedef struct {
     char* vm_filename;
     FILE* vm_ptr;
     SymbolTable* global_table;
+    size_t num_threads;     // worker threads for parsing and code generation, 0 = one per core
+    bool pipeline;          // lex on a separate thread, streaming tokens to the parser
+    size_t chunk_size;      // read the sources through a window of this many bytes instead of mapping them, 0 = map
+    bool parallel_lex;      // split large files into chunks lexed on `num_threads` threads
+    bool pull;              // lex on demand as the parser reads, a fixed window of tokens at a time
+    bool incremental;       // reuse the .vm of classes whose source and dependencies are unchanged
+    TimePassesFormat time_passes; // report the time spent in every pass after compiling
+    bool arena_stats;       // report the memory use of every named arena at exit
+    const char* input_dir;  // directory of the .jack files, NULL = the Pong sample
+    vector class_arenas;    // one arena per parsed class, owns that class's AST
 } CompilerState;
 
+/**
+ * Called for every class of a successful compilation, `file_index` indexes `jack_files`.
+ */
+typedef void (*ClassCompiledHook)(void* ctx, size_t file_index, ASTPool* class_pool);
+
 CompilerState* init_compiler();
+void init_compiler_runtime(CompilerState* state);
+ThreadPool* init_compiler_pool(const CompilerState* state, size_t num_files);
+bool compile_files(CompilerState* state, ThreadPool* pool, ClassCompiledHook on_compiled, void* ctx);
 int compile(CompilerState* state);
 #endif
\ No newline at end of file
@@ -2,23 +2,43 @@
 #define REFAC_LEXER_H
 
 #define PATH_TO_EQ_DEF_FILE TOSTRING(DEF_FILES_DIR/eq_classes.def)
+#define PATH_TO_DFA_DEF_FILE TOSTRING(DEF_FILES_DIR/lexer_dfa.def)
 
+#include <limits.h>
 #include <stdio.h>
+#include <pthread.h>
 #include "logger.h"
 #include "token_queue.h"
+#include "source_buffer.h"
+#include "thread_pool.h"
 
 #define NUM_STATES 11
 #define NUM_EQ_CLASSES 10
+
+typedef struct LexemeStore LexemeStore;
+typedef struct ChunkRun ChunkRun;
+
 typedef struct
 {
-    char *input;
+    SourceBuffer *source;
+    const char *input;  // source->data, NUL terminated, or the window of a chunked lexer
     size_t position;
     const char *filename;
     int cur_len;
     TokenQueue* queue;
     ErrorCode error_code;
-    vector line_starts;
     Arena* arena;
+    pthread_t thread;   // only used by a streaming lexer
+    size_t timer_file;  // file the lexing time is attributed to, see pass_timer.h
+    SourceWindow *window;       // NULL unless the file is read in chunks
+    LexemeStore *lexemes;       // where a chunked lexer copies the lexemes to, `source` refers to them
+    size_t base;        // offset in the file of `input[0]`
+    int state;          // the state the scanner starts or resumes in
+    size_t token_start; // where the token pending in `state` started
+    int line;           // the line the scanner starts on
+    ChunkRun *run;      // NULL unless the lexer scans one chunk of a file for a parallel lexer
+    int max_tokens;     // the scanner suspends once it pushed this many tokens (or one more), INT_MAX unless pulled
+    bool suspended;     // the scanner returned at `max_tokens`, not at the end of the input
 } Lexer;
 
 typedef enum
@@ -49,10 +69,40 @@ typedef enum
     IN_ERROR,
 } States;
 
+/**
+ * Whether the bytes of `state` from `token_start` on are part of a token, and have to stay in the window when
+ * a chunked lexer moves it. Comments and START only look at the current byte.
+ */
+static inline bool state_holds_token(int state)
+{
+    return state != START && (state < IN_COMMENT_SINGLE || state > SEEN_STAR_IN_COMMENT);
+}
+
+/**
+ * The generated direct coded scanner is the default, the table driven one is kept as its reference.
+ */
+typedef enum
+{
+    LEXER_MODE_DIRECT,
+    LEXER_MODE_TABLE,
+} LexerMode;
+
 Lexer *init_lexer(const char *filename, Arena* arena);
+Lexer *init_lexer_from_string(const char *filename, char *input, Arena* arena);
+Lexer *init_streaming_lexer(const char *filename, Arena* arena);
+Lexer *init_chunked_lexer(const char *filename, size_t window_size, Arena* arena);
+Lexer *init_parallel_lexer(const char *filename, ThreadPool *pool, Arena* arena);
+Lexer *init_parallel_lexer_from_string(const char *filename, char *input, ThreadPool *pool, Arena* arena);
+size_t parallel_lex_max_chunks(size_t length);
+bool parallel_lex_splits(size_t length);
+Lexer *init_pull_lexer(const char *filename, Arena* arena);
+ErrorCode finish_pull_lexer(Lexer *lexer);
+ErrorCode finish_streaming_lexer(Lexer *lexer);
 void initialize_eq_classes();
 void destroy_lexer(Lexer *lexer);
 ErrorCode process_input(Lexer *lexer);
+ErrorCode process_input_table(Lexer *lexer);
+void use_lexer_mode(LexerMode mode);
 char *strip(const char *str);
 void destroy_queue(TokenQueue* queue);
 
@@ -9,32 +9,29 @@
 typedef struct Parser {
     TokenQueue* queue;
     Token* currentToken;
-    vector line_offsets;
     bool has_error;
     Arena* arena;
+    ASTPool* pool;      // nodes of the class being parsed
 } Parser;
 
-Parser* init_parser(TokenQueue* queue, vector line_offsets, Arena* arena);
-ASTNode* init_program();
-ASTNode* parse_class(Parser* parser);
-ASTNode* parse_class_var_dec(Parser* parser);
-ASTNode* parse_subroutine_dec(Parser* parser);
-ASTNode* parse_parameter_list(Parser* parser);
-ASTNode* parse_subroutine_body(Parser* parser);
-ASTNode* parse_var_dec(Parser* parser);
-ASTNode* parse_statements(Parser* parser);
-ASTNode* parse_statement(Parser* parser);
-ASTNode* parse_let_statement(Parser* parser);
-ASTNode* parse_if_statement(Parser* parser);
-ASTNode* parse_while_statement(Parser* parser);
-ASTNode* parse_do_statement(Parser* parser);
-ASTNode* parse_return_statement(Parser* parser);
-ASTNode* parse_subroutine_call(Parser* parser);
-ASTNode* parse_expression(Parser* parser);
-ASTNode* parse_term(Parser* parser);
-ASTNode* parse_var_term(Parser* parser);
-
-void destroy_parser(Parser* parser);
+Parser* init_parser(TokenQueue* queue, Arena* arena);
+ASTPool* parse_class(Parser* parser);
+NodeId parse_class_var_dec(Parser* parser);
+NodeId parse_subroutine_dec(Parser* parser);
+NodeId parse_parameter_list(Parser* parser);
+NodeId parse_subroutine_body(Parser* parser);
+NodeId parse_var_dec(Parser* parser);
+NodeId parse_statements(Parser* parser);
+NodeId parse_statement(Parser* parser);
+NodeId parse_let_statement(Parser* parser);
+NodeId parse_if_statement(Parser* parser);
+NodeId parse_while_statement(Parser* parser);
+NodeId parse_do_statement(Parser* parser);
+NodeId parse_return_statement(Parser* parser);
+NodeId parse_subroutine_call(Parser* parser);
+NodeId parse_expression(Parser* parser);
+NodeId parse_term(Parser* parser);
+NodeId parse_var_term(Parser* parser);
 
 
 #endif // REFAC_PARSER_H
@@ -1,23 +1,38 @@
 #ifndef RINGBUFFER_H
 #define RINGBUFFER_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include "token.h"
 
-#define RINGBUFFER_SIZE 2048
+#define RINGBUFFER_SIZE 1024 // must be a power of two
 
+/**
+ * Bounded single-producer / single-consumer token ring.
+ * Tokens are stored by value. The indices only ever grow, the slot of an index is `idx & (RINGBUFFER_SIZE - 1)`.
+ *
+ *  release_idx <= read_idx <= write_idx <= release_idx + RINGBUFFER_SIZE
+ *
+ * [release_idx, read_idx) are tokens handed to the consumer that are still in use (the current token),
+ * [read_idx, write_idx) are tokens published by the producer but not popped yet.
+ */
 typedef struct {
-    Token* data[RINGBUFFER_SIZE];
-    size_t read_idx;
-    size_t write_idx;
+    Token data[RINGBUFFER_SIZE];
+    _Alignas(64) atomic_size_t write_idx;   // written by the producer
+    _Alignas(64) atomic_size_t read_idx;    // written by the consumer
+    atomic_size_t release_idx;              // written by the consumer
+    atomic_bool closed;                     // producer finished, no more pushes
+    atomic_bool cancelled;                  // consumer finished, further pushes are dropped
 } RingBuffer;
 
 RingBuffer* init_ringbuffer();
-bool ringbuffer_push(RingBuffer* buffer, Token* token);
-bool ringbuffer_pop(RingBuffer* buffer, Token** value);
+bool ringbuffer_push(RingBuffer* rb, const Token* token);
+bool ringbuffer_pop(RingBuffer* rb, Token** value);
+Token* ringbuffer_peek(RingBuffer* rb, size_t offset);
+void ringbuffer_close(RingBuffer* rb);
+void ringbuffer_cancel(RingBuffer* rb);
 void ringbuffer_destroy(RingBuffer* rb);
 bool rb_is_empty(const RingBuffer* rb);
-Token* ringbuffer_peek(const RingBuffer* rb);
 
-#endif // RINGBUFFER_H
\ No newline at end of file
+#endif // RINGBUFFER_H
@@ -0,0 +1,54 @@
+#ifndef SMALL_VEC_H
+#define SMALL_VEC_H
+
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "arena.h"
+
+#define SMALL_VEC_INLINE_BYTES 64
+
+/**
+ * A growable array of `elem_size` byte elements for lists that are usually short. The first
+ * SMALL_VEC_INLINE_BYTES bytes of elements are stored in the vector itself, longer lists move to a buffer
+ * in `arena` that doubles as it fills. Nothing is ever freed : a buffer outgrown stays in the arena,
+ * and the vector goes away with its arena.
+ * `data` may point into the vector, so a vector must stay where `init_small_vec` put it.
+ */
+typedef struct {
+    void* data;
+    uint32_t size;
+    uint32_t capacity;
+    uint32_t elem_size;
+    Arena* arena;
+    alignas(max_align_t) unsigned char inline_data[SMALL_VEC_INLINE_BYTES];
+} SmallVec;
+
+void init_small_vec(SmallVec* vec, size_t elem_size, Arena* arena);
+bool small_vec_reserve(SmallVec* vec, uint32_t capacity);
+bool small_vec_append(SmallVec* vec, const void* elems, uint32_t count);
+
+static inline void* small_vec_at(const SmallVec* vec, uint32_t index) {
+    return (char*) vec->data + (size_t) index * vec->elem_size;
+}
+
+static inline bool small_vec_push(SmallVec* vec, const void* elem) {
+    if (vec->size == vec->capacity && !small_vec_reserve(vec, vec->size + 1)) {
+        return false;
+    }
+    memcpy(small_vec_at(vec, vec->size++), elem, vec->elem_size);
+    return true;
+}
+
+/**
+ * Drop the elements from `size` on.
+ */
+static inline void small_vec_truncate(SmallVec* vec, uint32_t size) {
+    if (size < vec->size) {
+        vec->size = size;
+    }
+}
+
+#endif // SMALL_VEC_H
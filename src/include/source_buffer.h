@@ -0,0 +1,51 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Read only contents of a source file, mapped in place where the platform allows it.
+ * `data[length]` is always '\0', so the lexer can scan the buffer without bound checks.
+ * Offsets into a buffer fit in 32 bits, larger files are refused.
+ */
+typedef struct {
+    const char* data;
+    size_t length;
+    size_t map_length;      // bytes mapped, 0 if `data` is heap allocated
+    uint32_t* line_starts;  // offset of the first byte of every line, NULL until `index_source_lines`
+    uint32_t num_lines;
+    uint32_t lines_capacity;
+    bool lexemes_only;      // `data` is the lexemes a chunked lexer kept, not the text of the file
+} SourceBuffer;
+
+/**
+ * A file read front to back through a window of `capacity` bytes, for sources too large to keep in memory
+ * or that cannot be mapped. `data[end]` is always '\0'. The window only grows when the bytes to keep fill
+ * all of it, i.e. for a single token longer than the window.
+ */
+typedef struct {
+    FILE* file;
+    char* data;
+    size_t capacity;
+    size_t end;             // bytes of the file in `data`
+    size_t base;            // offset in the file of `data[0]`
+    bool at_eof;
+    SourceBuffer* lines;    // gets the line index of the file, filled as the window moves on
+} SourceWindow;
+
+SourceBuffer* open_source_buffer(const char* path);
+SourceBuffer* source_buffer_from_string(char* str);
+void close_source_buffer(SourceBuffer* buffer);
+
+void index_source_lines(SourceBuffer* buffer);
+size_t source_line_offset(const SourceBuffer* buffer, int line);
+int source_line_of(const SourceBuffer* buffer, size_t offset);
+
+SourceWindow* open_source_window(const char* path, size_t capacity, SourceBuffer* lines);
+size_t slide_source_window(SourceWindow* window, size_t keep);
+void close_source_window(SourceWindow* window);
+
+#endif // SOURCE_BUFFER_H
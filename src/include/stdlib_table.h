@@ -0,0 +1,17 @@
+#ifndef STDLIB_TABLE_H
+#define STDLIB_TABLE_H
+
+#include <stdint.h>
+#include "symbol.h"
+
+/**
+ * Signatures of the OS classes, generated from `jack_files/stdlib.json` by `tools/stdlib_gen.c` at build time.
+ * The table is constant data linked into the compiler, `add_stdlib_table` reads it in place.
+ */
+extern const ClassInfo stdlib_classes[];
+extern const int stdlib_num_classes;
+
+// FNV-1a hash of stdlib.json, class cache keys depend on it
+extern const uint64_t stdlib_hash;
+
+#endif // STDLIB_TABLE_H
@@ -4,6 +4,7 @@
 #include "safer.h"
 
 #include "arena.h"
+#include "intern.h"
 
 typedef struct Symbol Symbol;
 typedef struct SymbolTable SymbolTable;
@@ -44,7 +45,7 @@ typedef enum {
 
 typedef struct Type {
     BasicType basicType;
-    char* userDefinedType;  // NULL unless basicType == TYPE_USER_DEFINED
+    Atom userDefinedType;  // ATOM_NONE unless basicType == TYPE_USER_DEFINED
 } Type;
 
 typedef enum {
@@ -54,7 +55,7 @@ typedef enum {
 } Depth;
 
 struct Symbol {
-    char *name;
+    Atom name;
     Type* type;
     Kind kind;
     int index;
@@ -71,28 +72,31 @@ struct SymbolTable {
     Arena* arena;
 };
 
+// Signatures of the OS classes, see stdlib_table.h
 struct ParameterInfo {
-    char* name;
-    char* type;
+    const char* name;
+    const char* type;
 };
 
 struct FunctionInfo {
-    char* name;
-    char* return_type;
-    vector parameters;
+    const char* name;
+    const char* return_type;
     Kind kind;
+    const ParameterInfo* parameters;
+    int num_parameters;
 };
 
 struct ClassInfo {
-    char* name;
-    vector functions;
+    const char* name;
+    const FunctionInfo* functions;
+    int num_functions;
 };
 
 SymbolTable* create_table(Scope scope, SymbolTable *parent, Arena* arena);
 void destroy_table(SymbolTable *table);
-Symbol* symbol_new(const char *name,  Type* type, Kind kind, SymbolTable* table);
-Symbol* symbol_table_add(SymbolTable *table, const char* name, const char* type, Kind kind);
-Symbol* symbol_table_lookup(SymbolTable* table, char* name, Depth depth);
+Symbol* symbol_new(Atom name, Type* type, Kind kind, SymbolTable* table);
+Symbol* symbol_table_add(SymbolTable *table, Atom name, Atom type, Kind kind);
+Symbol* symbol_table_lookup(SymbolTable* table, Atom name, Depth depth);
 vector get_symbols_of_kind(SymbolTable* table, Kind kind);
 const char* type_to_str(Type* type);
 void destroy_symbol(Symbol *symbol);
@@ -100,8 +104,7 @@ SymbolTable* create_and_link_table(Scope scope, SymbolTable* parent);
 SymbolTable* getParent(SymbolTable *table);
 SymbolTable* add_child_table(SymbolTable* parent, Scope scope);
 
-vector parse_jack_stdlib_from_json(const char* json_content, Arena* arena);
-void add_stdlib_table(SymbolTable* global_table, vector jack_os_classes);
+void add_stdlib_table(SymbolTable* global_table, const ClassInfo* classes, int num_classes);
 
 
 #endif // SYMBOL_H
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+
+/**
+ * A task run by the pool. `index` identifies which of the `num_tasks` work items is being processed,
+ * so results can be written into slot `index` of a caller-owned array and merged in a fixed order.
+ */
+typedef void (*ThreadTask)(void* ctx, size_t index);
+
+typedef struct ThreadPool ThreadPool;
+
+ThreadPool* init_thread_pool(size_t num_threads);
+void thread_pool_run(ThreadPool* pool, size_t num_tasks, ThreadTask task, void* ctx);
+size_t thread_pool_size(const ThreadPool* pool);
+void destroy_thread_pool(ThreadPool* pool);
+size_t default_thread_count();
+
+#endif // THREAD_POOL_H
@@ -2,8 +2,14 @@
 #define TOKEN_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include "arena.h"
+#include "intern.h"
+#include "source_buffer.h"
+
+// The largest integer constant of the language
+#define JACK_INT_MAX 32767
 
 typedef enum
 {
@@ -67,11 +73,21 @@ typedef enum
     TOKEN_CATEGORY_ARITH = 1 << 8
 } TokenCategory;
 
+/**
+ * The lexeme of a token is a slice of the source buffer of its file, which the lexer keeps alive
+ * until it is destroyed. Copy it with `token_strdup`, or intern it with `token_atom`, if it has to outlive the lexer.
+ * Integer constants are decoded by the lexer and keep their value instead of their lexeme.
+ */
 typedef struct {
     TokenType type;
-    const char* filename;
-    char* lx;
     int line;
+    const char* filename;
+    const SourceBuffer* source;  // of the file, its lines are indexed
+    union {
+        uint32_t offset;         // of the lexeme in `source->data`
+        uint32_t value;          // of a TOKEN_TYPE_NUM, at most JACK_INT_MAX
+    };
+    uint32_t length;             // of the lexeme, not NUL terminated
 } Token;
 
 typedef struct
@@ -81,14 +97,16 @@ typedef struct
 } TokenMapping;
 
 const char* token_type_to_string(TokenType type);
-TokenType token_type_from_str(const char *str);
+TokenType token_type_from_str(const char *str, size_t len);
 TokenType token_type_from_char(char ch);
 
 TokenCategory get_token_category(TokenType type);
 bool is_token_category(TokenType type, TokenCategory category);
 const char* token_category_to_string(TokenCategory category);
-Token *new_token(const char* filename, TokenType type, char *lx, int line, Arena* arena);
-void destroy_token(Token *token);
+const char* token_lexeme(const Token *token);
+size_t token_line_offset(const Token *token);
+char* token_strdup(const Token *token, Arena* arena);
+Atom token_atom(const Token *token);
 
 void fmt(const Token *token);
 char* token_to_string(const Token *token);
@@ -1,20 +1,63 @@
 #ifndef TOKEN_QUEUE_H
 #define TOKEN_QUEUE_H
 
-#include "vector.h"
 #include <stdio.h>
 #include "token.h"
 #include "arena.h"
+#include "ringbuffer.h"
+#include "source_buffer.h"
 
+/**
+ * The tokens of one file as parallel arrays, indexed by token number. The file and its source
+ * buffer are the same for every token, so they are stored once.
+ */
+typedef struct {
+    uint8_t* types;     // TokenType
+    uint32_t* offsets;  // of the lexemes in `source->data`, the values of integer constants
+    uint32_t* lengths;
+    uint32_t* lines;
+    size_t count;
+    size_t capacity;
+    const char* filename;
+    const SourceBuffer* source;
+} TokenStream;
+
+/**
+ * Asked by a pull queue for more tokens. Pushes at least one token unless the input has ended.
+ * @return false once no more tokens will come
+ */
+typedef bool (*TokenPull)(void* ctx);
+
+/**
+ * The tokens of one file. Either the whole file is collected in `stream`,
+ * or - when streaming - the tokens pass through `ring` from the lexer thread to the parser,
+ * or - when pulling - `stream` is a ring of PULL_WINDOW tokens the lexer refills on demand.
+ * A popped token of `stream` is rebuilt in `current`, it stays valid until the next pop.
+ */
 typedef struct {
     int idx;
-    vector list;
+    TokenStream stream;
+    Token current;
+    RingBuffer* ring; // NULL unless streaming
+    TokenPull pull;   // NULL unless pulling
+    void* pull_ctx;
+    size_t head;      // slot of the next token of a pull queue
+    bool drained;     // `pull` will not push any more tokens
 } TokenQueue;
 
-TokenQueue * queue_init(Arena* arena);
-bool queue_push(TokenQueue* queue, Token* ptr);
+#define PULL_WINDOW 64 // tokens, a power of 2
+
+TokenQueue * queue_init(const char* filename, const SourceBuffer* source, Arena* arena);
+TokenQueue * queue_init_streaming(const char* filename, const SourceBuffer* source, Arena* arena);
+TokenQueue * queue_init_pull(const char* filename, const SourceBuffer* source, Arena* arena, TokenPull pull, void* ctx);
+size_t queue_space(const TokenQueue* queue);
+bool queue_push(TokenQueue* queue, const Token* token);
+bool queue_append(TokenQueue* queue, const TokenStream* tokens);
 bool queue_pop(TokenQueue* queue, Token** val);
-Token* queue_peek(const TokenQueue* queue);
-Token* queue_peek_offset(TokenQueue *queue, int offset);
+TokenType queue_peek(TokenQueue* queue);
+TokenType queue_peek_offset(TokenQueue *queue, int offset);
+size_t queue_size(const TokenQueue* queue);
+void queue_close(TokenQueue* queue);
+void queue_cancel(TokenQueue* queue);
 
-#endif //TOKEN_QUEUE_H
\ No newline at end of file
+#endif //TOKEN_QUEUE_H
@@ -0,0 +1,127 @@
+#include "lexer_scan.h"
+#include <stdint.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+    // SSE2 is part of x86-64, AVX2 is compiled per function and only used if the CPU has it
+    #define SCAN_X86
+    #include <immintrin.h>
+#endif
+
+static const char* kernel_names[] = {
+    [SCAN_KERNEL_SCALAR] = "scalar",
+    [SCAN_KERNEL_SSE2] = "sse2",
+    [SCAN_KERNEL_AVX2] = "avx2",
+};
+
+/*
+ * Scalar kernels, also the reference for the vector ones
+ */
+
+static size_t scalar_line_comment(const char* input, size_t pos) {
+    while (input[pos] != '\n' && input[pos] != '\0') {
+        pos++;
+    }
+    return pos;
+}
+
+static size_t scalar_block_comment(const char* input, size_t pos) {
+    while (input[pos] != '*' && input[pos] != '\n' && input[pos] != '\0') {
+        pos++;
+    }
+    return pos;
+}
+
+#ifdef SCAN_X86
+
+/**
+ * Defines a kernel over aligned blocks of `width` bytes. `end_mask` gives a bit per byte of a block that
+ * ends the run, the bits of the bytes before `pos` in the first block are cleared.
+ */
+#define DEFINE_SCAN(name, attr, vec, load, width, end_mask)                                   \
+    attr static size_t name(const char* input, size_t pos) {                                  \
+        const char* block = (const char*) ((uintptr_t) (input + pos) & ~(uintptr_t) ((width) - 1)); \
+        unsigned offset = (unsigned) (input + pos - block);                                   \
+        unsigned mask = end_mask(load((const vec*) block)) >> offset << offset;               \
+        while (mask == 0) {                                                                   \
+            block += (width);                                                                 \
+            mask = end_mask(load((const vec*) block));                                        \
+        }                                                                                     \
+        return (size_t) (block - input) + (size_t) __builtin_ctz(mask);                       \
+    }
+
+/*
+ * SSE2, 16 bytes at a time
+ */
+
+#define SSE2_EQ(v, c) _mm_cmpeq_epi8(v, _mm_set1_epi8(c))
+
+static inline unsigned sse2_line_comment_end(__m128i v) {
+    return (unsigned) _mm_movemask_epi8(_mm_or_si128(SSE2_EQ(v, '\n'), SSE2_EQ(v, '\0')));
+}
+
+static inline unsigned sse2_block_comment_end(__m128i v) {
+    __m128i end = _mm_or_si128(_mm_or_si128(SSE2_EQ(v, '*'), SSE2_EQ(v, '\n')), SSE2_EQ(v, '\0'));
+    return (unsigned) _mm_movemask_epi8(end);
+}
+
+DEFINE_SCAN(sse2_line_comment, , __m128i, _mm_load_si128, 16, sse2_line_comment_end)
+DEFINE_SCAN(sse2_block_comment, , __m128i, _mm_load_si128, 16, sse2_block_comment_end)
+
+/*
+ * AVX2, 32 bytes at a time
+ */
+
+#define AVX2 __attribute__((target("avx2")))
+#define AVX2_EQ(v, c) _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))
+
+AVX2 static inline unsigned avx2_line_comment_end(__m256i v) {
+    return (unsigned) _mm256_movemask_epi8(_mm256_or_si256(AVX2_EQ(v, '\n'), AVX2_EQ(v, '\0')));
+}
+
+AVX2 static inline unsigned avx2_block_comment_end(__m256i v) {
+    __m256i end = _mm256_or_si256(_mm256_or_si256(AVX2_EQ(v, '*'), AVX2_EQ(v, '\n')), AVX2_EQ(v, '\0'));
+    return (unsigned) _mm256_movemask_epi8(end);
+}
+
+DEFINE_SCAN(avx2_line_comment, AVX2, __m256i, _mm256_load_si256, 32, avx2_line_comment_end)
+DEFINE_SCAN(avx2_block_comment, AVX2, __m256i, _mm256_load_si256, 32, avx2_block_comment_end)
+
+#endif // SCAN_X86
+
+static const ScanKernels kernels[] = {
+    [SCAN_KERNEL_SCALAR] = {scalar_line_comment, scalar_block_comment},
+#ifdef SCAN_X86
+    [SCAN_KERNEL_SSE2] = {sse2_line_comment, sse2_block_comment},
+    [SCAN_KERNEL_AVX2] = {avx2_line_comment, avx2_block_comment},
+#endif
+};
+
+ScanKernels scan_kernels = {scalar_line_comment, scalar_block_comment};
+
+/**
+ * @brief The widest kernels the CPU running the compiler supports.
+ */
+ScanKernel best_scan_kernel() {
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? SCAN_KERNEL_AVX2 : SCAN_KERNEL_SSE2;
+#else
+    return SCAN_KERNEL_SCALAR;
+#endif
+}
+
+/**
+ * @brief Make the lexer use `kernel`. Must not be called while a lexer is running.
+ * @return false if the kernel is not available on this build or CPU, the kernels are left as they were
+ */
+bool use_scan_kernel(ScanKernel kernel) {
+    if (kernel > best_scan_kernel()) {
+        return false;
+    }
+    scan_kernels = kernels[kernel];
+    return true;
+}
+
+const char* scan_kernel_name(ScanKernel kernel) {
+    return kernel_names[kernel];
+}
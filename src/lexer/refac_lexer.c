@@ -2,118 +2,21 @@
 #include "token.h"
 #include <string.h>
 #include "safer.h"
+#include "pass_timer.h"
+#include "source_buffer.h"
+#include "lexer_scan.h"
 
 /**
  * The transition table for the DFA.
  */
 static int transition[NUM_STATES][NUM_EQ_CLASSES] = {
-        [START] = {
-                [C_white] = START,
-                [C_newline] = START,
-                [C_alpha] = IN_ID,
-                [C_digit] = IN_NUM,
-                [C_double_quote] = IN_STRING,
-                [C_slash] = COMMENT_START,
-                [C_star] = IN_SYMBOL,
-                [C_symbol] = IN_SYMBOL,
-                [C_other] = IN_ERROR,
-                [C_eof] = START,
-        },
-        [IN_ID] = {
-                [C_white] = START,
-                [C_newline] = START,
-                [C_alpha] = IN_ID,
-                [C_digit] = IN_ID,
-                [C_double_quote] = IN_STRING,
-                [C_slash] = COMMENT_START,
-                [C_star] = IN_SYMBOL,
-                [C_symbol] = START,
-                [C_other] = IN_ERROR,
-                [C_eof] = IN_ERROR,
-        },
-        [IN_NUM] = {
-                [C_white] = START,
-                [C_alpha] = START,
-                [C_digit] = IN_NUM,
-                [C_double_quote] = IN_STRING,
-                [C_slash] = COMMENT_START,
-                [C_star] = IN_SYMBOL,
-                [C_symbol] = IN_SYMBOL,
-                [C_other] = IN_ERROR,
-                [C_eof] = IN_ERROR,
-        },
-        [IN_STRING] = {
-                [C_white] = IN_STRING,
-                [C_newline] = IN_ERROR,
-                [C_alpha] = IN_STRING,
-                [C_digit] = IN_STRING,
-                [C_double_quote] = START,
-                [C_slash] = IN_STRING,
-                [C_star] = IN_STRING,
-                [C_symbol] = IN_STRING,
-                [C_other] = IN_STRING,
-                [C_eof] = IN_ERROR,
-        },
-        [COMMENT_START] = {
-                [C_white] = START,
-                [C_newline] = START,
-                [C_alpha] = IN_ID,
-                [C_digit] = IN_NUM,
-                [C_double_quote] = IN_STRING,
-                [C_slash] = IN_COMMENT_SINGLE,
-                [C_star] = IN_COMMENT_MULTI,
-                [C_symbol] = IN_SYMBOL,
-                [C_other] = IN_ERROR,
-                [C_eof] = IN_ERROR,
-        },
-        [IN_COMMENT_SINGLE] = {
-                [C_white] = IN_COMMENT_SINGLE,
-                [C_newline] = START,
-                [C_alpha] = IN_COMMENT_SINGLE,
-                [C_digit] = IN_COMMENT_SINGLE,
-                [C_double_quote] = IN_COMMENT_SINGLE,
-                [C_slash] = IN_COMMENT_SINGLE,
-                [C_star] = IN_COMMENT_SINGLE,
-                [C_symbol] = IN_COMMENT_SINGLE,
-                [C_other] = IN_COMMENT_SINGLE,
-                [C_eof] = IN_ERROR,
-        },
-        [IN_COMMENT_MULTI] = {
-                [C_white] = IN_COMMENT_MULTI,
-                [C_newline] = IN_COMMENT_MULTI,
-                [C_alpha] = IN_COMMENT_MULTI,
-                [C_digit] = IN_COMMENT_MULTI,
-                [C_double_quote] = IN_COMMENT_MULTI,
-                [C_slash] = IN_COMMENT_MULTI,
-                [C_star] = SEEN_STAR_IN_COMMENT,
-                [C_symbol] = IN_COMMENT_MULTI,
-                [C_other] = IN_COMMENT_MULTI,
-                [C_eof] = IN_ERROR,
-        },
-        [SEEN_STAR_IN_COMMENT] = {
-                [C_white] = IN_COMMENT_MULTI,
-                [C_newline] = IN_COMMENT_MULTI,
-                [C_alpha] = IN_COMMENT_MULTI,
-                [C_digit] = IN_COMMENT_MULTI,
-                [C_double_quote] = IN_COMMENT_MULTI,
-                [C_slash] = START,
-                [C_star] = SEEN_STAR_IN_COMMENT,
-                [C_symbol] = IN_COMMENT_MULTI,
-                [C_other] = IN_COMMENT_MULTI,
-                [C_eof] = IN_ERROR,
-        },
-        [IN_SYMBOL] = {
-                [C_white] = START,
-                [C_newline] = START,
-                [C_alpha] = IN_ID,
-                [C_digit] = IN_NUM,
-                [C_double_quote] = IN_STRING,
-                [C_slash] = COMMENT_START,
-                [C_star] = IN_SYMBOL,
-                [C_symbol] = IN_SYMBOL,
-                [C_other] = IN_ERROR,
-                [C_eof] = START,
-        },
+    #define LEXER_TRANSITION(from_state, eq_class, to_state) [from_state][eq_class] = to_state,
+    #define LEXER_SKIP(state, run)
+
+    #include PATH_TO_DFA_DEF_FILE
+
+    #undef LEXER_TRANSITION
+    #undef LEXER_SKIP
 };
 
 
@@ -141,16 +44,42 @@ void initialize_eq_classes() {
 
     #undef EQ_CLASS_DEF_RANGE
     #undef EQ_CLASS_DEF_SINGLE
+
+    use_scan_kernel(best_scan_kernel());
+}
+
+static SourceBuffer* read_source(const char *filename) {
+    PassSample io = pass_timer_start();
+    SourceBuffer* source = open_source_buffer(filename);
+    pass_timer_stop(PASS_IO, io);
+
+    if (source == NULL) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_FILE_OPEN, __FILE__, __LINE__,
+                            "['%s'] : Failed to open file > '%s'", __func__, filename);
+        return NULL;
+    }
+    if (source->length == 0) {
+        close_source_buffer(source);
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_FILE_READ, __FILE__, __LINE__,
+                            "['%s'] : File is empty > '%s'", __func__, filename);
+        return NULL;
+    }
+    return source;
 }
 
 /**
- * Initialize a new lexer with the given filename.
- * The lexer will read the contents of the file into a string buffer.
- * The buffer is owned by the lexer.
- * @param filename The name of the file to be processed by the lexer - 
- * @return A pointer to the initialized lexer.
+ * How the tokens get to the parser : all collected before it starts, through a ring from a lexer thread,
+ * or lexed whenever the parser runs out of them.
  */
-Lexer* init_lexer(const char *filename, Arena *lexerArena) {
+typedef enum {
+    TOKENS_COLLECTED,
+    TOKENS_STREAMED,
+    TOKENS_PULLED,
+} TokenDelivery;
+
+static bool pull_tokens(void *ctx);
+
+static Lexer* create_lexer(const char *filename, SourceBuffer *source, Arena *lexerArena, TokenDelivery delivery) {
     Lexer* lexer = arena_alloc(lexerArena, sizeof(Lexer));
     if (lexer == NULL) {
         log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
@@ -158,21 +87,40 @@ Lexer* init_lexer(const char *filename, Arena *lexerArena) {
         return NULL;
     }
 
-    lexer->input = read_file_into_string(filename);
-    if (lexer->input == NULL) {
-        free(lexer);
+    if (source == NULL) {
         log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
                             "['%s'] : Failed to allocate memory for file buffer", __func__);
         return NULL;
-
     }
 
+    index_source_lines(source);
+    lexer->source = source;
+    lexer->input = source->data;
     lexer->arena = lexerArena;
     lexer->filename = strdup(filename);
 
     lexer->position = 0;
-    lexer->queue = queue_init(lexerArena);
-    lexer->line_starts = vector_create(); // owned by parser
+    lexer->timer_file = pass_timer_current_file();
+    lexer->window = NULL;
+    lexer->lexemes = NULL;
+    lexer->base = 0;
+    lexer->state = START;
+    lexer->token_start = 0;
+    lexer->line = 0;
+    lexer->run = NULL;
+    lexer->max_tokens = INT_MAX;
+    lexer->suspended = false;
+    switch (delivery) {
+        case TOKENS_STREAMED:
+            lexer->queue = queue_init_streaming(lexer->filename, source, lexerArena);
+            break;
+        case TOKENS_PULLED:
+            lexer->queue = queue_init_pull(lexer->filename, source, lexerArena, pull_tokens, lexer);
+            break;
+        default:
+            lexer->queue = queue_init(lexer->filename, source, lexerArena);
+            break;
+    }
     if (lexer->queue == NULL) {
         log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
                             "['%s'] : Failed to allocate memory for lexer queue", __func__);
@@ -180,14 +128,331 @@ Lexer* init_lexer(const char *filename, Arena *lexerArena) {
         return NULL;
     }
 
+    return lexer;
+}
+
+static Lexer* lex_source(const char *filename, SourceBuffer *source, Arena *lexerArena) {
+    Lexer* lexer = create_lexer(filename, source, lexerArena, TOKENS_COLLECTED);
+    if (lexer != NULL) {
+        PassSample lex = pass_timer_start();
+        lexer->error_code = process_input(lexer);
+        pass_timer_stop(PASS_LEX, lex);
+    }
+    return lexer;
+}
+
+/**
+ * Initialize a new lexer with the given filename.
+ * The lexer maps the file in place and tokenizes all of it.
+ * The mapping is owned by the lexer.
+ * @param filename The name of the file to be processed by the lexer - 
+ * @return A pointer to the initialized lexer.
+ */
+Lexer* init_lexer(const char *filename, Arena *lexerArena) {
+    return lex_source(filename, read_source(filename), lexerArena);
+}
+
+/**
+ * Tokenize a source that is already in memory, `filename` is only used for diagnostics.
+ * The lexer takes ownership of `input`, which must be heap allocated.
+ */
+Lexer* init_lexer_from_string(const char *filename, char *input, Arena *lexerArena) {
+    return lex_source(filename, source_buffer_from_string(input), lexerArena);
+}
+
+static void* streaming_lexer_main(void *arg) {
+    Lexer* lexer = arg;
+    pass_timer_set_file(lexer->timer_file);
+    PassSample lex = pass_timer_start();
     lexer->error_code = process_input(lexer);
+    pass_timer_stop(PASS_LEX, lex);
+    queue_close(lexer->queue);
+    return NULL;
+}
+
+/**
+ * @brief Start a lexer on its own thread. The tokens are pushed into a bounded ring
+ * as they are recognised, so the parser can consume them from `lexer->queue` while the
+ * rest of the file is still being lexed. Must be ended with `finish_streaming_lexer`.
+ */
+Lexer* init_streaming_lexer(const char *filename, Arena *lexerArena) {
+    Lexer* lexer = create_lexer(filename, read_source(filename), lexerArena, TOKENS_STREAMED);
+    if (lexer == NULL) {
+        return NULL;
+    }
+
+    lexer->error_code = ERROR_NONE;
+    if (pthread_create(&lexer->thread, NULL, streaming_lexer_main, lexer) != 0) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_THREAD_CREATE, __FILE__, __LINE__,
+                            "['%s'] : Failed to create lexer thread for > '%s'", __func__, filename);
+        return NULL;
+    }
+
+    return lexer;
+}
+
+/**
+ * @brief Wait for a streaming lexer once the parser is done with its queue.
+ * Tokens the parser did not read are dropped.
+ */
+ErrorCode finish_streaming_lexer(Lexer *lexer) {
+    queue_cancel(lexer->queue);
+    pthread_join(lexer->thread, NULL);
+    return lexer->error_code;
+}
+
+/**
+ * Lex on until the queue of a pull lexer is full, see `init_pull_lexer`.
+ */
+static bool pull_tokens(void *ctx) {
+    Lexer* lexer = ctx;
+    size_t space = queue_space(lexer->queue);
+    // A step of the scanner pushes up to two tokens
+    lexer->max_tokens = space > 1 ? (int) space - 1 : 1;
+    lexer->suspended = false;
+
+    PassSample lex = pass_timer_start();
+    ErrorCode error = process_input(lexer);
+    pass_timer_stop(PASS_LEX, lex);
+    if (lexer->suspended) {
+        return true;
+    }
+    lexer->error_code = error;
+    return false;
+}
+
+/**
+ * @brief A lexer driven by the parser. Nothing is lexed up front, popping or peeking past the tokens at hand
+ * resumes the scanner where it stopped, and it stops again once the window of PULL_WINDOW tokens is full.
+ * The tokens of the file are never all in memory. The time spent lexing is also counted as parsing time.
+ * Must be ended with `finish_pull_lexer`.
+ */
+Lexer* init_pull_lexer(const char *filename, Arena *lexerArena) {
+    Lexer* lexer = create_lexer(filename, read_source(filename), lexerArena, TOKENS_PULLED);
+    if (lexer != NULL) {
+        lexer->error_code = ERROR_NONE;
+    }
+    return lexer;
+}
+
+/**
+ * @brief Lex the rest of the file once the parser is done with the queue, so its diagnostics are reported.
+ * The tokens are dropped.
+ */
+ErrorCode finish_pull_lexer(Lexer *lexer) {
+    queue_cancel(lexer->queue);
+    return lexer->error_code;
+}
+
+typedef struct {
+    uint32_t hash;
+    uint32_t offset;        // in `text`, LEXEME_FREE if the slot is empty
+    uint32_t length;
+} LexemeSlot;
+
+/**
+ * The lexemes of a chunked lexer, each distinct one stored once. The window has moved on by the time the
+ * parser reads the tokens, so their offsets are into `text`, which becomes the data of the lexer's source.
+ */
+struct LexemeStore {
+    char *text;             // '\0' after every lexeme, as the source has a character ending it
+    size_t length;
+    size_t capacity;
+    LexemeSlot *slots;      // open addressing, `num_slots` is a power of 2
+    size_t num_slots;
+    size_t count;
+};
+
+#define LEXEME_FREE UINT32_MAX
+#define INITIAL_LEXEME_SLOTS 1024
+#define INITIAL_LEXEME_TEXT 4096
+
+static LexemeStore* init_lexeme_store() {
+    LexemeStore* store = safer_malloc(sizeof(LexemeStore));
+    store->capacity = INITIAL_LEXEME_TEXT;
+    store->text = safer_malloc(store->capacity);
+    store->text[0] = '\0';
+    store->length = 0;
+    store->num_slots = INITIAL_LEXEME_SLOTS;
+    store->slots = safer_malloc(sizeof(LexemeSlot) * store->num_slots);
+    for (size_t i = 0; i < store->num_slots; ++i) {
+        store->slots[i].offset = LEXEME_FREE;
+    }
+    store->count = 0;
+    return store;
+}
+
+static uint32_t hash_lexeme(const char *lexeme, size_t length) {
+    uint32_t hash = 0x811c9dc5u;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ (unsigned char) lexeme[i]) * 0x01000193u;
+    }
+    return hash;
+}
+
+static void grow_lexeme_slots(LexemeStore *store) {
+    size_t num_slots = store->num_slots * 2;
+    LexemeSlot* slots = safer_malloc(sizeof(LexemeSlot) * num_slots);
+    for (size_t i = 0; i < num_slots; ++i) {
+        slots[i].offset = LEXEME_FREE;
+    }
+    for (size_t i = 0; i < store->num_slots; ++i) {
+        if (store->slots[i].offset == LEXEME_FREE) {
+            continue;
+        }
+        size_t index = store->slots[i].hash & (num_slots - 1);
+        while (slots[index].offset != LEXEME_FREE) {
+            index = (index + 1) & (num_slots - 1);
+        }
+        slots[index] = store->slots[i];
+    }
+    free(store->slots);
+    store->slots = slots;
+    store->num_slots = num_slots;
+}
+
+/**
+ * @return the offset of the lexeme in the store, copying it in the first time it is seen
+ */
+static uint32_t store_lexeme(LexemeStore *store, const char *lexeme, size_t length) {
+    uint32_t hash = hash_lexeme(lexeme, length);
+    size_t index = hash & (store->num_slots - 1);
+    for (; store->slots[index].offset != LEXEME_FREE; index = (index + 1) & (store->num_slots - 1)) {
+        LexemeSlot* slot = &store->slots[index];
+        if (slot->hash == hash && slot->length == length && memcmp(store->text + slot->offset, lexeme, length) == 0) {
+            return slot->offset;
+        }
+    }
+
+    if (store->length + length + 2 > store->capacity) {
+        while (store->length + length + 2 > store->capacity) {
+            store->capacity *= 2;
+        }
+        store->text = realloc(store->text, store->capacity);
+        if (store->text == NULL) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                                "['%s'] : Failed to grow the lexeme store", __func__);
+        }
+    }
+
+    uint32_t offset = (uint32_t) store->length;
+    memcpy(store->text + offset, lexeme, length);
+    store->text[offset + length] = '\0';
+    store->length += length + 1;
+    store->text[store->length] = '\0';
+    store->slots[index] = (LexemeSlot) {hash, offset, (uint32_t) length};
+    if (++store->count * 2 > store->num_slots) {
+        grow_lexeme_slots(store);
+    }
+    return offset;
+}
+
+/**
+ * Where a scan of a chunk of a parallel lexer went, see `init_parallel_lexer`.
+ */
+typedef struct {
+    int state;
+    char c;
+    int line;
+    size_t position;        // in the chunk
+    const char *func;
+} LexerFault;
+
+typedef struct {
+    size_t position;        // in the chunk
+    uint32_t length;
+    int line;
+} LexerOverflow;
+
+struct ChunkRun {
+    int start_state;
+    int end_state;          // the state the chunk ends in, IN_ERROR if the input ended inside it
+    size_t end;             // where the chunk ends in the input scanned, SIZE_MAX if the file ends there
+    TokenQueue *queue;
+    bool failed;
+    LexerFault fault;       // reported only once the run is known to have started in the right state
+    LexerOverflow *overflows;   // integer constants out of range, reported like `fault`
+    size_t num_overflows;
+    size_t overflows_capacity;
+};
+
+/**
+ * Called on every NUL the scanner reaches at `pos` in `state`. If it is the end of the window of a chunked
+ * lexer and not of the file, the window moves on, keeping the bytes from `keep` on. If it is the end of the
+ * chunk of a parallel lexer, `state` is kept for the chunk that follows.
+ * @return how far the window moved, END_OF_CHUNK at the end of a chunk, NO_REFILL if the NUL ends the input
+ */
+#define NO_REFILL ((size_t) -1)
+#define END_OF_CHUNK ((size_t) -2)
+
+static size_t refill_input(Lexer *lexer, size_t pos, size_t keep, int state) {
+    if (lexer->run != NULL && pos == lexer->run->end) {
+        lexer->run->end_state = state;
+        return END_OF_CHUNK;
+    }
+    SourceWindow* window = lexer->window;
+    if (window == NULL || pos != window->end || window->at_eof) {
+        return NO_REFILL;
+    }
+    size_t shift = slide_source_window(window, keep);
+    lexer->input = window->data;
+    lexer->base = window->base;
+    return shift;
+}
+
+/**
+ * @brief Tokenize a file reading it through a window of `window_size` bytes, for files too large to map.
+ * The lexemes are copied out of the window, each distinct lexeme once, so the memory used grows with the
+ * tokens and distinct names of the file but not with its size.
+ */
+Lexer* init_chunked_lexer(const char *filename, size_t window_size, Arena *lexerArena) {
+    LexemeStore* store = init_lexeme_store();
+    SourceBuffer* source = source_buffer_from_string(store->text);
+    source->lexemes_only = true;
+
+    PassSample io = pass_timer_start();
+    SourceWindow* window = open_source_window(filename, window_size, source);
+    pass_timer_stop(PASS_IO, io);
+
+    if (window == NULL) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_FILE_OPEN, __FILE__, __LINE__,
+                            "['%s'] : Failed to open file > '%s'", __func__, filename);
+        return NULL;
+    }
+    if (window->end == 0) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_FILE_READ, __FILE__, __LINE__,
+                            "['%s'] : File is empty > '%s'", __func__, filename);
+        return NULL;
+    }
 
+    Lexer* lexer = create_lexer(filename, source, lexerArena, TOKENS_COLLECTED);
+    if (lexer == NULL) {
+        return NULL;
+    }
+    lexer->window = window;
+    lexer->lexemes = store;
+    lexer->input = window->data;
+
+    PassSample lex = pass_timer_start();
+    lexer->error_code = process_input(lexer);
+    pass_timer_stop(PASS_LEX, lex);
+
+    // The tokens refer to the store from now on
+    source->data = store->text;
+    source->length = store->length;
+    close_source_window(window);
+    lexer->window = NULL;
+    free(store->slots);
+    free(store);
+    lexer->lexemes = NULL;
+    lexer->input = source->data;
     return lexer;
 }
 
 void destroy_lexer(Lexer *lexer) {
     if (lexer != NULL) {
-        free(lexer->input);
+        destroy_queue(lexer->queue);
+        close_source_buffer(lexer->source);
         free((char*) lexer->filename);
     }
 }
@@ -195,21 +460,22 @@ void destroy_lexer(Lexer *lexer) {
 /**
  * Determine the TokenType based on the token string and the previous state.
  *
- * @param token_str The token string.
+ * @param token_str The token string, not NUL terminated.
+ * @param token_len The length of the token string.
  * @param old_state The previous state of the lexer.
  * @return The TokenType determined based on the token string and the previous state.
  */
-TokenType determine_token_type(const char *token_str, int old_state) {
+TokenType determine_token_type(const char *token_str, size_t token_len, int old_state) {
     switch (old_state) {
         case IN_ID:
-            return token_type_from_str(token_str);
+            return token_type_from_str(token_str, token_len);
         case IN_NUM:
             return TOKEN_TYPE_NUM;
         case IN_STRING:
             return TOKEN_TYPE_STRING;
         case IN_SYMBOL:
         case COMMENT_START:
-            if (strlen(token_str) == 1) {
+            if (token_len == 1) {
                 return token_type_from_char(token_str[0]);
             }
         default:
@@ -218,6 +484,49 @@ TokenType determine_token_type(const char *token_str, int old_state) {
 }
 
 
+/**
+ * Report an integer constant larger than JACK_INT_MAX. The lexer goes on after it, only the value is wrong.
+ */
+static void integer_overflow(Lexer *lexer, size_t token_start, size_t length, int line) {
+    ChunkRun *run = lexer->run;
+    if (run != NULL) {
+        if (run->num_overflows == run->overflows_capacity) {
+            run->overflows_capacity = run->overflows_capacity ? run->overflows_capacity * 2 : 4;
+            run->overflows = realloc(run->overflows, sizeof(LexerOverflow) * run->overflows_capacity);
+            if (run->overflows == NULL) {
+                log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                                    "['%s'] : Failed to grow the deferred diagnostics", __func__);
+            }
+        }
+        run->overflows[run->num_overflows++] = (LexerOverflow) {token_start, (uint32_t) length, line};
+        return;
+    }
+    // Quoted from the constant on
+    log_error_in_source(ERROR_PHASE_LEXER, ERROR_LEXER_INTEGER_OVERFLOW, lexer->source, lexer->filename, line,
+                        lexer->base + token_start - 1, "['%s'] : Integer constant > '%.*s' is larger than %d",
+                        __func__, (int) length, lexer->input + token_start, JACK_INT_MAX);
+}
+
+/**
+ * The value of an integer constant, decoded as soon as the scanner has skipped its digits, so they are
+ * read again from the L1 cache. The parser takes the value from the token, the lexeme is not kept.
+ */
+static uint32_t decode_integer(Lexer *lexer, size_t token_start, size_t length, int line) {
+    const char *digits = lexer->input + token_start;
+    uint32_t value = 0;
+    for (size_t i = 0; i < length; ++i) {
+        // Stops growing past the limit, so no number of digits wraps around
+        if (value <= JACK_INT_MAX) {
+            value = value * 10 + (uint32_t) (digits[i] - '0');
+        }
+    }
+    if (value > JACK_INT_MAX) {
+        integer_overflow(lexer, token_start, length, line);
+        return JACK_INT_MAX;
+    }
+    return value;
+}
+
 /**
  * @brief Create a token object
  * 
@@ -229,10 +538,76 @@ TokenType determine_token_type(const char *token_str, int old_state) {
  * @param token_count - The number of tokens created so far
  */
 void create_token(Lexer *lexer, int old_state, size_t token_start, size_t token_len, int line) {
-    char* token_str = strndup(lexer->input + token_start, token_len);
-    TokenType type = determine_token_type(token_str, old_state);
-    Token* token = new_token(lexer->filename, type, token_str, line, lexer->arena);
-    queue_push(lexer->queue, token);
+    // The queue copies the token, nothing is kept per token outside of it
+    const char* lexeme = lexer->input + token_start;
+    Token token = {
+        .type = determine_token_type(lexeme, token_len, old_state),
+        .filename = lexer->filename,
+        .source = lexer->source,
+        .length = (uint32_t) token_len,
+        .line = line,
+    };
+    if (token.type == TOKEN_TYPE_NUM) {
+        token.value = decode_integer(lexer, token_start, token_len, line);
+    } else if (lexer->lexemes) {
+        token.offset = store_lexeme(lexer->lexemes, lexeme, token_len);
+    } else {
+        token.offset = (uint32_t) (lexer->base + token_start);
+    }
+    queue_push(lexer->queue, &token);
+}
+
+/**
+ * Report the error the DFA ran into, coming from `old_state` on `c`.
+ */
+static ErrorCode lexer_error(Lexer *lexer, int old_state, char c, int line, const char *func) {
+    if (lexer->run != NULL) {
+        // The chunk may have been scanned from the wrong state, the parallel lexer decides whether to report it
+        lexer->run->failed = true;
+        lexer->run->fault = (LexerFault) {old_state, c, line, lexer->position, func};
+        return ERROR_LEXER_ILLEGAL_SYMBOL;
+    }
+    size_t offset = lexer->position + lexer->base;
+    if (old_state == IN_STRING && c == '\n') {
+        log_error_in_source(ERROR_PHASE_LEXER, ERROR_LEXER_NEWLINE_IN_STRING, lexer->source, lexer->filename, line,
+                            offset, "['%s'] : A string cannot contain a new line", func);
+        return ERROR_LEXER_NEWLINE_IN_STRING;
+    } else if (old_state == IN_STRING && c == '\0') {
+        log_error_in_source(ERROR_PHASE_LEXER, ERROR_LEXER_EOF_IN_STRING, lexer->source, lexer->filename, line,
+                            offset, "['%s'] : A string cannot contain file EOF", func);
+        return ERROR_LEXER_EOF_IN_STRING;
+    } else if (c == '\0') {
+        log_error_in_source(ERROR_PHASE_LEXER, ERROR_LEXER_UNEXPECTED_EOF, lexer->source, lexer->filename, line,
+                            offset, "['%s'] : Unexpected EOF", func);
+        return ERROR_LEXER_UNEXPECTED_EOF;
+    } else {
+        log_error_in_source(ERROR_PHASE_LEXER, ERROR_LEXER_NEWLINE_IN_STRING, lexer->source, lexer->filename, line,
+                            offset, "['%s'] : Illegal symbol > '%c'", func, c);
+        return ERROR_LEXER_ILLEGAL_SYMBOL; // Unreachable since log_with_offset "panics"
+    }
+}
+
+/*
+ * The direct coded scanner, generated from the same transition table by tools/scanner_gen.c :
+ * `static ErrorCode process_input_direct(Lexer *lexer)`
+ */
+#ifndef LEXER_COMPUTED_GOTO
+    #if defined(__GNUC__)
+        #define LEXER_COMPUTED_GOTO 1
+    #else
+        #define LEXER_COMPUTED_GOTO 0
+    #endif
+#endif
+#include "lexer_direct.h"
+
+static LexerMode lexer_mode = LEXER_MODE_DIRECT;
+
+/**
+ * @brief Switch between the generated scanner and the table driven reference.
+ * Must not be called while a lexer is running.
+ */
+void use_lexer_mode(LexerMode mode) {
+    lexer_mode = mode;
 }
 
 /**
@@ -241,26 +616,67 @@ void create_token(Lexer *lexer, int old_state, size_t token_start, size_t token_
  * @param lexer The lexer object.
  */
 ErrorCode process_input(Lexer *lexer) {
-    int state = START;
-    int line = 0;
-    size_t token_start = 0;
+    if (lexer_mode == LEXER_MODE_TABLE) {
+        return process_input_table(lexer);
+    }
+    return process_input_direct(lexer);
+}
+
+/**
+ * Tokenize by interpreting the transition table, one character per iteration.
+ * This is the reference the generated scanner must agree with.
+ *
+ * @param lexer The lexer object.
+ */
+ErrorCode process_input_table(Lexer *lexer) {
+    int state = lexer->state;
+    int line = lexer->line;
+    size_t token_start = lexer->token_start;
     bool in_comment = false;
     int old_state = START;
     bool was_in_comment = false;
     int token_count = 0;
 
     while (true) {
+        // Skip runs that stay in the same state without emitting a token, the loops stop on every '\n'
+        switch (state) {
+            #define LEXER_TRANSITION(from_state, eq_class, to_state)
+            #define LEXER_SKIP(skip_state, run) \
+                case skip_state: \
+                    lexer->position = scan_##run(lexer->input, lexer->position); \
+                    break;
+
+            #include PATH_TO_DFA_DEF_FILE
+
+            #undef LEXER_TRANSITION
+            #undef LEXER_SKIP
+            default:
+                break;
+        }
+
         char c = lexer->input[lexer->position];
+        // The end of the window of a chunked lexer, read on and look at the same position again
+        if (c == '\0') {
+            bool holds_token = state_holds_token(state);
+            size_t shift = refill_input(lexer, lexer->position, holds_token ? token_start : lexer->position, state);
+            if (shift == END_OF_CHUNK) {
+                break;
+            }
+            if (shift != NO_REFILL) {
+                lexer->position -= shift;
+                if (holds_token) {
+                    token_start -= shift;
+                }
+                continue;
+            }
+        }
         EqClasses eq_class = eq_classes[(int) c];
         old_state = state;
         int next_state = transition[state][eq_class];
 
         // Handle newline increment
         if (c == '\n') {
-             line++;
-             size_t* offset = arena_alloc(loggerArena, sizeof(size_t));
-            *offset = lexer->position;
-            vector_push(lexer->line_starts, offset);
+            line++;
         }
 
         // Check if we were in a comment
@@ -295,28 +711,21 @@ ErrorCode process_input(Lexer *lexer) {
 
         // Handle lexer error
         if (state == IN_ERROR) {
-            if (old_state == IN_STRING && c == '\n') {
-                log_error_with_offset(ERROR_PHASE_LEXER, ERROR_LEXER_NEWLINE_IN_STRING, lexer->filename, line,
-                                      lexer->position, "['%s'] : A string cannot contain a new line", __func__);
-                return ERROR_LEXER_NEWLINE_IN_STRING;
-            } else if (old_state == IN_STRING && c == '\0') {
-                log_error_with_offset(ERROR_PHASE_LEXER, ERROR_LEXER_EOF_IN_STRING, lexer->filename, line,
-                                      lexer->position, "['%s'] : A string cannot contain file EOF", __func__);
-                return ERROR_LEXER_EOF_IN_STRING;
-            } else if (c == '\0') {
-                log_error_with_offset(ERROR_PHASE_LEXER, ERROR_LEXER_UNEXPECTED_EOF, lexer->filename, line,
-                                      lexer->position, "['%s'] : Unexpected EOF", __func__);
-                return ERROR_LEXER_UNEXPECTED_EOF;
-            } else {
-                log_error_with_offset(ERROR_PHASE_LEXER, ERROR_LEXER_NEWLINE_IN_STRING, lexer->filename, line,
-                                      lexer->position, "['%s'] : Illegal symbol > '%c'", __func__, c);
-                return ERROR_LEXER_ILLEGAL_SYMBOL; // Unreachable since log_with_offset "panics"
-            }
+            return lexer_error(lexer, old_state, c, line, __func__);
         }
 
         lexer->position++;
 
         if (c == '\0') break; // EOF
+
+        // A pull lexer hands its tokens over before the window of its queue overflows
+        if (token_count >= lexer->max_tokens) {
+            lexer->state = state;
+            lexer->token_start = token_start;
+            lexer->line = line;
+            lexer->suspended = true;
+            return ERROR_NONE;
+        }
     }
 
     log_message(LOG_LEVEL_DEBUG, ERROR_NONE, "Lexer processed %d tokens\n", token_count);
@@ -324,13 +733,220 @@ ErrorCode process_input(Lexer *lexer) {
     return ERROR_NONE;
 }
 
+/*
+ * The parallel lexer cuts a file after newlines into chunks and scans them all at once, each from a guess
+ * of the state it starts in. After a newline the DFA can only be in START or IN_COMMENT_MULTI - a string
+ * cannot hold a newline and every other state ends at one - so a chunk is scanned from START, and again
+ * from IN_COMMENT_MULTI if that fails. The chunks are then stitched in order : the run that started in
+ * the state the chunk before ended in is kept, and if there is none the chunk is scanned again from it.
+ */
+#ifndef PARALLEL_LEX_MIN_CHUNK
+    #define PARALLEL_LEX_MIN_CHUNK ((size_t) 256 * 1024)
+#endif
+#define PARALLEL_LEX_CHUNKS_PER_THREAD 4
+#define MAX_CHUNK_RUNS 3
+
+// The vector kernels load the whole aligned block holding the NUL after a chunk
+#define CHUNK_SLACK 32
+
+typedef struct {
+    size_t begin;           // offset in the file, the start of a line
+    size_t end;
+    int first_line;
+    ChunkRun runs[MAX_CHUNK_RUNS];
+    int num_runs;
+} LexChunk;
+
+typedef struct {
+    const Lexer *lexer;
+    LexChunk *chunks;
+} ParallelLexJob;
 
+/**
+ * Cut the source into at most `max_chunks` chunks of about the same size, each ending after a newline.
+ * @return the number of chunks
+ */
+static size_t split_into_chunks(const SourceBuffer *source, LexChunk *chunks, size_t max_chunks) {
+    size_t num_chunks = 0;
+    size_t begin = 0;
+    for (size_t i = 1; begin < source->length; ++i) {
+        size_t end = source->length;
+        if (i < max_chunks) {
+            size_t target = source->length / max_chunks * i;
+            if (target < begin) {
+                continue;   // the line the last cut was moved to runs past this one
+            }
+            const char *newline = memchr(source->data + target, '\n', source->length - target);
+            end = newline ? (size_t) (newline - source->data) + 1 : source->length;
+        }
+        chunks[num_chunks].begin = begin;
+        chunks[num_chunks].end = end;
+        chunks[num_chunks].first_line = source_line_of(source, begin);
+        chunks[num_chunks].num_runs = 0;
+        num_chunks++;
+        begin = end;
+    }
+    return num_chunks;
+}
 
+/**
+ * Scan `chunk` from `state` into a new run. All but the last chunk are copied out, so their end is a NUL
+ * the scanner stops at. The tokens refer to the source of `parent`.
+ */
+static ChunkRun* scan_chunk(const Lexer *parent, LexChunk *chunk, int state) {
+    ChunkRun *run = &chunk->runs[chunk->num_runs++];
+    run->start_state = state;
+    run->end_state = IN_ERROR;
+    run->failed = false;
+    run->num_overflows = 0;
+
+    Lexer lexer = *parent;
+    lexer.queue = run->queue;
+    lexer.run = run;
+    lexer.base = chunk->begin;
+    lexer.position = 0;
+    lexer.state = state;
+    lexer.line = chunk->first_line;
+
+    char *copy = NULL;
+    if (chunk->end == parent->source->length) {
+        run->end = SIZE_MAX;
+        lexer.input = parent->source->data + chunk->begin;
+    } else {
+        run->end = chunk->end - chunk->begin;
+        copy = safer_malloc(run->end + 1 + CHUNK_SLACK);
+        memcpy(copy, parent->source->data + chunk->begin, run->end);
+        memset(copy + run->end, '\0', 1 + CHUNK_SLACK);
+        lexer.input = copy;
+    }
 
+    process_input(&lexer);
+    free(copy);
+    return run;
+}
 
+static void lex_chunk(void *ctx, size_t index) {
+    ParallelLexJob *job = ctx;
+    LexChunk *chunk = &job->chunks[index];
+    ChunkRun *run = scan_chunk(job->lexer, chunk, START);
+    // Text that is not valid code is most likely the inside of a block comment
+    if (index > 0 && run->failed) {
+        scan_chunk(job->lexer, chunk, IN_COMMENT_MULTI);
+    }
+}
 
+/**
+ * Collect the tokens of the runs that started in the right states, in order, into the queue of `lexer`.
+ * @return the error of the first chunk that fails, the serial lexer stops there too
+ */
+static ErrorCode stitch_chunks(Lexer *lexer, LexChunk *chunks, size_t num_chunks) {
+    ErrorCode error = ERROR_NONE;
+    int state = START;
+    size_t rescanned = 0;
+    for (size_t i = 0; i < num_chunks; ++i) {
+        LexChunk *chunk = &chunks[i];
+        ChunkRun *run = NULL;
+        for (int r = 0; r < chunk->num_runs && run == NULL; ++r) {
+            if (chunk->runs[r].start_state == state) {
+                run = &chunk->runs[r];
+            }
+        }
+        if (run == NULL) {
+            run = scan_chunk(lexer, chunk, state);
+            rescanned++;
+        }
 
+        queue_append(lexer->queue, &run->queue->stream);
+        for (size_t o = 0; o < run->num_overflows; ++o) {
+            LexerOverflow *overflow = &run->overflows[o];
+            integer_overflow(lexer, chunk->begin + overflow->position, overflow->length, overflow->line);
+        }
+        if (run->failed) {
+            lexer->position = chunk->begin + run->fault.position;
+            error = lexer_error(lexer, run->fault.state, run->fault.c, run->fault.line, run->fault.func);
+            break;
+        }
+        if (run->end_state == IN_ERROR) {
+            break;
+        }
+        state = run->end_state;
+    }
 
+    log_message(LOG_LEVEL_DEBUG, ERROR_NONE, "Parallel lexer stitched %zu chunks, %zu scanned again\n",
+                num_chunks, rescanned);
+    return error;
+}
 
+/**
+ * @brief The most chunks `init_parallel_lexer` cuts a file of `length` bytes into, whatever the size of the pool.
+ */
+size_t parallel_lex_max_chunks(size_t length) {
+    return length / PARALLEL_LEX_MIN_CHUNK;
+}
+
+/**
+ * @brief Whether `init_parallel_lexer` splits a file of `length` bytes into chunks, smaller files are lexed serially.
+ */
+bool parallel_lex_splits(size_t length) {
+    return parallel_lex_max_chunks(length) >= 2;
+}
+
+static Lexer* lex_source_parallel(const char *filename, SourceBuffer *source, ThreadPool *pool,
+                                  Arena *lexerArena) {
+    size_t num_threads = thread_pool_size(pool);
+    size_t max_chunks = source ? parallel_lex_max_chunks(source->length) : 0;
+    if (max_chunks > num_threads * PARALLEL_LEX_CHUNKS_PER_THREAD) {
+        max_chunks = num_threads * PARALLEL_LEX_CHUNKS_PER_THREAD;
+    }
+    if (num_threads < 2 || !source || !parallel_lex_splits(source->length)) {
+        return lex_source(filename, source, lexerArena);
+    }
 
+    Lexer *lexer = create_lexer(filename, source, lexerArena, TOKENS_COLLECTED);
+    if (lexer == NULL) {
+        return NULL;
+    }
+
+    PassSample lex = pass_timer_start();
+    LexChunk *chunks = safer_malloc(sizeof(LexChunk) * max_chunks);
+    size_t num_chunks = split_into_chunks(source, chunks, max_chunks);
+    // The arena is not shared, every queue a run may need is taken from it up front
+    for (size_t i = 0; i < num_chunks; ++i) {
+        for (int r = 0; r < MAX_CHUNK_RUNS; ++r) {
+            chunks[i].runs[r].queue = queue_init(lexer->filename, source, lexerArena);
+            chunks[i].runs[r].overflows = NULL;
+            chunks[i].runs[r].overflows_capacity = 0;
+        }
+    }
 
+    ParallelLexJob job = {.lexer = lexer, .chunks = chunks};
+    thread_pool_run(pool, num_chunks, lex_chunk, &job);
+
+    lexer->error_code = stitch_chunks(lexer, chunks, num_chunks);
+    for (size_t i = 0; i < num_chunks; ++i) {
+        for (int r = 0; r < MAX_CHUNK_RUNS; ++r) {
+            destroy_queue(chunks[i].runs[r].queue);
+            free(chunks[i].runs[r].overflows);
+        }
+    }
+    free(chunks);
+    pass_timer_stop(PASS_LEX, lex);
+    return lexer;
+}
+
+/**
+ * @brief Tokenize a file on the threads of `pool`, for single files of many megabytes. The tokens, their lines
+ * and the diagnostics are the same as those of `init_lexer`. Files too small to be worth splitting are lexed
+ * serially. The pool runs one job at a time, so this must not be called from a task of `pool`.
+ */
+Lexer* init_parallel_lexer(const char *filename, ThreadPool *pool, Arena *lexerArena) {
+    return lex_source_parallel(filename, read_source(filename), pool, lexerArena);
+}
+
+/**
+ * Tokenize a source that is already in memory like `init_parallel_lexer`. The lexer takes ownership of `input`,
+ * which must be heap allocated.
+ */
+Lexer* init_parallel_lexer_from_string(const char *filename, char *input, ThreadPool *pool, Arena *lexerArena) {
+    return lex_source_parallel(filename, source_buffer_from_string(input), pool, lexerArena);
+}
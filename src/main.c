@@ -1,16 +1,70 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "refac_compiler.h"
+#include "compile_server.h"
 
 #ifndef JACK_FILES_DIR
     #define JACK_FILES_DIR "./jack_files"  // Fallback if JACK_FILES_DIR is not defined in CMakeLists.txt
 #endif
 
 #define PATH_LEN_MAX 1024
+#define DEFAULT_CHUNK_KIB 64
 
-int main() {
+static void print_usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-j threads] [--pipeline] [--chunked[=KiB]] [--parallel-lex] [--pull] [--incremental] [--time-passes[=json]] [--arena-stats] [--server socket] [dir]\n"
+                    "       %s --connect socket (files... | --stop)\n", prog, prog);
+}
+
+int main(int argc, char** argv) {
     const char* jackFilesDir = JACK_FILES_DIR;
 
+    if (argc >= 2 && strcmp(argv[1], "--connect") == 0) {
+        if (argc < 4) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        return run_compile_client(argv[2], argc - 3, argv + 3);
+    }
+
     CompilerState* compilerState = init_compiler();
-    int res = compile(compilerState);
-    return 0;
+    const char* serverSocket = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            compilerState->num_threads = (size_t) strtoul(argv[++i], NULL, 10);
+        } else if (strncmp(argv[i], "-j", 2) == 0 && argv[i][2] != '\0') {
+            compilerState->num_threads = (size_t) strtoul(argv[i] + 2, NULL, 10);
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            compilerState->pipeline = true;
+        } else if (strcmp(argv[i], "--chunked") == 0) {
+            compilerState->chunk_size = DEFAULT_CHUNK_KIB * 1024;
+        } else if (strncmp(argv[i], "--chunked=", 10) == 0 && strtoul(argv[i] + 10, NULL, 10) > 0) {
+            compilerState->chunk_size = (size_t) strtoul(argv[i] + 10, NULL, 10) * 1024;
+        } else if (strcmp(argv[i], "--parallel-lex") == 0) {
+            compilerState->parallel_lex = true;
+        } else if (strcmp(argv[i], "--pull") == 0) {
+            compilerState->pull = true;
+        } else if (strcmp(argv[i], "--incremental") == 0) {
+            compilerState->incremental = true;
+        } else if (strcmp(argv[i], "--time-passes") == 0 || strcmp(argv[i], "--time-passes=json") == 0) {
+            compilerState->time_passes = argv[i][13] == '=' ? TIME_PASSES_JSON : TIME_PASSES_TEXT;
+            init_pass_timer();
+        } else if (strcmp(argv[i], "--arena-stats") == 0) {
+            compilerState->arena_stats = true;
+        } else if (strcmp(argv[i], "--server") == 0 && i + 1 < argc) {
+            serverSocket = argv[++i];
+        } else if (argv[i][0] != '-' && !compilerState->input_dir) {
+            compilerState->input_dir = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (serverSocket) {
+        return run_compile_server(compilerState, serverSocket);
+    }
+
+    return compile(compilerState);
 }
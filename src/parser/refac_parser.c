@@ -5,12 +5,13 @@
 
 
 /**
- * @brief Initializes a parser.
+ * @brief Initializes a parser. The parser lives in `arena` and its tokens belong to the lexer owning `queue`,
+ * so there is nothing to destroy.
  * 
  * @param lexer 
  * @return Parser* 
  */
-Parser* init_parser(TokenQueue* queue, vector line_offsets, Arena* arena) {
+Parser* init_parser(TokenQueue* queue, Arena* arena) {
     Parser* parser = arena_alloc(arena, sizeof(Parser));
     
     if(!parser) {
@@ -25,55 +26,59 @@ Parser* init_parser(TokenQueue* queue, vector line_offsets, Arena* arena) {
         free(parser);
         return NULL;
     }
-    parser->line_offsets = line_offsets;
     parser->arena = arena;
     parser->queue = queue;
     parser->currentToken = NULL;
     parser->has_error = false;
+    parser->pool = NULL;
 
     return parser;
 }
 
-void destroy_parser(Parser* parser) {
-
-    /*
-     *  parser->arena will live longer than the parser
-     *  parser->currentToken - pointer into a element from the queue // does not need to be manually freed
-     *  parser itself arena allocated dies when arena is destroyed
-     */
-     vector_destroy(parser->line_offsets);
-}
-
 void expect_and_consume(Parser* parser, TokenType expected) {
     if (parser->currentToken->type != expected) {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                              (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
-                              "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(expected),
-                              token_type_to_string(parser->currentToken->type)
-                              );
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                            token_line_offset(parser->currentToken),
+                            "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(expected),
+                            token_type_to_string(parser->currentToken->type)
+                            );
         parser->has_error = true;
     } else {
         queue_pop(parser->queue, &parser->currentToken);
     }
 }
 
-ASTNode* parse_class(Parser* parser) {
+/**
+ * @brief A new node of `type` in the pool of the class, at the position of the current token.
+ */
+static NodeId new_node(Parser* parser, ASTNodeType type) {
+    NodeId id = ast_new_node(parser->pool, type);
+    ASTNode* node = ast_node(parser->pool, id);
+    node->line = parser->currentToken->line;
+    node->byte_offset = (uint32_t) token_line_offset(parser->currentToken);
+    return id;
+}
+
+/**
+ * @brief Parse the class of the queue into a pool of its own, allocated from the arena of the parser.
+ */
+ASTPool* parse_class(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_CLASS, parser->arena);
     log_message(LOG_LEVEL_DEBUG, ERROR_NONE, "Parsing class\n");
 
     queue_pop(parser->queue, &parser->currentToken);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, parser->currentToken->line);
+    parser->pool = init_ast_pool(parser->currentToken->filename, parser->arena);
+    NodeId id = new_node(parser, NODE_CLASS);
+    ASTNode* node = ast_node(parser->pool, id);
+    parser->pool->root = id;
     expect_and_consume(parser, TOKEN_TYPE_CLASS);
 
     if (parser->currentToken->type == TOKEN_TYPE_ID) {
-        node->data.classDec->className = arena_strdup(parser->arena,parser->currentToken->lx);
+        node->data.classDec.className = token_atom(parser->currentToken);
         queue_pop(parser->queue, &parser->currentToken);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-            (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+            token_line_offset(parser->currentToken),
             "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
             token_type_to_string(parser->currentToken->type)
         );
@@ -82,55 +87,54 @@ ASTNode* parse_class(Parser* parser) {
 
     expect_and_consume(parser, TOKEN_TYPE_OPEN_BRACE);
 
+    uint32_t mark = ast_list_begin(parser->pool);
     while (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_CLASS_VAR | TOKEN_CATEGORY_SUBROUTINE_DEC)) {
         if (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_CLASS_VAR)) {
-            ASTNode* classVarDec = parse_class_var_dec(parser);
-            vector_push(node->data.classDec->classVarDecs, classVarDec);
+            ast_list_push(parser->pool, parse_class_var_dec(parser));
         } else if (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_SUBROUTINE_DEC)) {
-            ASTNode* subroutineDec = parse_subroutine_dec(parser);
-            vector_push(node->data.classDec->subroutineDecs, subroutineDec);
+            ast_list_push(parser->pool, parse_subroutine_dec(parser));
         }
     }
+    ast_list_split(parser->pool, mark, NODE_CLASS_VAR_DEC, &node->data.classDec.classVarDecs,
+                   &node->data.classDec.subroutineDecs);
 
     log_message(LOG_LEVEL_INFO, ERROR_NONE,
                 "Current token : %s\n", token_to_string(parser->currentToken));
     log_message(LOG_LEVEL_INFO, ERROR_NONE, "idx : [%d], queue size : [%d]\n",
-                parser->queue->idx, vector_size(parser->queue->list));
+                parser->queue->idx, (int) queue_size(parser->queue));
 
     if (parser->currentToken->type != TOKEN_TYPE_CLOSE_BRACE) {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-            (size_t) vector_get(parser->line_offsets, parser->currentToken->line - 2),
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+            token_line_offset(parser->currentToken),
             "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_CLOSE_BRACE),
             token_type_to_string(parser->currentToken->type)
         );
     }
 
-    return node;
+    return parser->pool;
 }
 
-ASTNode* parse_class_var_dec(Parser* parser) {
+NodeId parse_class_var_dec(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_CLASS_VAR_DEC, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_CLASS_VAR_DEC);
+    ASTNode* node = ast_node(parser->pool, id);
 
     log_message(LOG_LEVEL_DEBUG,ERROR_NONE, "Parsing class variable declaration. Current Token : %s, Line : %d\n",
                 token_type_to_string(parser->currentToken->type), parser->currentToken->line);
 
     // Parse the class variable modifier
     if (parser->currentToken->type == TOKEN_TYPE_STATIC) {
-        node->data.classVarDec->classVarModifier = STATIC;
+        node->data.classVarDec.classVarModifier = STATIC;
         queue_pop(parser->queue, &parser->currentToken);
     } else if (parser->currentToken->type == TOKEN_TYPE_FIELD) {
-        node->data.classVarDec->classVarModifier = FIELD;
+        node->data.classVarDec.classVarModifier = FIELD;
         queue_pop(parser->queue, &parser->currentToken);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                              (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
-                              "['%s'] : Expected category > '%s', instead received > '%s'",
-                              token_category_to_string(TOKEN_CATEGORY_CLASS_VAR),
-                              token_type_to_string(parser->currentToken->type)
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                            token_line_offset(parser->currentToken),
+                            "['%s'] : Expected category > '%s', instead received > '%s'",
+                            token_category_to_string(TOKEN_CATEGORY_CLASS_VAR),
+                            token_type_to_string(parser->currentToken->type)
         );
         parser->has_error = true;
     }
@@ -138,25 +142,26 @@ ASTNode* parse_class_var_dec(Parser* parser) {
 
     // Parse the variable type
     if (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_TYPE)) {
-        node->data.classVarDec->varType = arena_strdup(parser->arena,parser->currentToken->lx);
+        node->data.classVarDec.varType = token_atom(parser->currentToken);
         queue_pop(parser->queue, &parser->currentToken);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                              (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
-                              "['%s'] : Expected category > '%s', instead received > '%s'",
-                              token_category_to_string(TOKEN_CATEGORY_TYPE),
-                              token_type_to_string(parser->currentToken->type)
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                            token_line_offset(parser->currentToken),
+                            "['%s'] : Expected category > '%s', instead received > '%s'",
+                            token_category_to_string(TOKEN_CATEGORY_TYPE),
+                            token_type_to_string(parser->currentToken->type)
         );
         parser->has_error = true;
     }
 
     // Parse the first variable name
+    uint32_t mark = ast_list_begin(parser->pool);
     if (parser->currentToken->type == TOKEN_TYPE_ID) {
-        vector_push(node->data.classVarDec->varNames, arena_strdup(parser->arena,parser->currentToken->lx));
+        ast_list_push(parser->pool, token_atom(parser->currentToken));
         queue_pop(parser->queue, &parser->currentToken);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-            (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+            token_line_offset(parser->currentToken),
             "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
             token_type_to_string(parser->currentToken->type)
         );
@@ -168,11 +173,11 @@ ASTNode* parse_class_var_dec(Parser* parser) {
     while (parser->currentToken->type == TOKEN_TYPE_COMMA) {
         queue_pop(parser->queue, &parser->currentToken);
         if (parser->currentToken->type == TOKEN_TYPE_ID) {
-            vector_push(node->data.classVarDec->varNames, arena_strdup(parser->arena,parser->currentToken->lx));
+            ast_list_push(parser->pool, token_atom(parser->currentToken));
             queue_pop(parser->queue, &parser->currentToken);
         } else {
-            log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+            log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                token_line_offset(parser->currentToken),
                 "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
                 token_type_to_string(parser->currentToken->type)
             );
@@ -180,60 +185,59 @@ ASTNode* parse_class_var_dec(Parser* parser) {
         }
     }
 
+    node->data.classVarDec.varNames = ast_list_end(parser->pool, mark);
     expect_and_consume(parser, TOKEN_TYPE_SEMICOLON);
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_subroutine_dec(Parser* parser) {
+NodeId parse_subroutine_dec(Parser* parser) {
     
-    ASTNode* node = init_ast_node(NODE_SUBROUTINE_DEC, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_SUBROUTINE_DEC);
+    ASTNode* node = ast_node(parser->pool, id);
     log_message(LOG_LEVEL_DEBUG,ERROR_NONE, "Parsing subroutine declaration. Current Token : %s, Line : %d\n",
                 token_type_to_string(parser->currentToken->type), parser->currentToken->line);
     
     // Parse the subroutine type
     if (parser->currentToken->type == TOKEN_TYPE_CONSTRUCTOR) {
-        node->data.subroutineDec->subroutineType = CONSTRUCTOR;
+        node->data.subroutineDec.subroutineType = CONSTRUCTOR;
         queue_pop(parser->queue, &parser->currentToken);
     } else if (parser->currentToken->type == TOKEN_TYPE_FUNCTION) {
-        node->data.subroutineDec->subroutineType = FUNCTION;
+        node->data.subroutineDec.subroutineType = FUNCTION;
         queue_pop(parser->queue, &parser->currentToken);
     } else if (parser->currentToken->type == TOKEN_TYPE_METHOD) {
-        node->data.subroutineDec->subroutineType = METHOD;
+        node->data.subroutineDec.subroutineType = METHOD;
         queue_pop(parser->queue, &parser->currentToken);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                              (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
-                              "['%s'] : Expected category > '%s', instead received > '%s'",
-                              token_category_to_string(TOKEN_CATEGORY_SUBROUTINE_DEC),
-                              token_type_to_string(parser->currentToken->type)
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                            token_line_offset(parser->currentToken),
+                            "['%s'] : Expected category > '%s', instead received > '%s'",
+                            token_category_to_string(TOKEN_CATEGORY_SUBROUTINE_DEC),
+                            token_type_to_string(parser->currentToken->type)
         );
         parser->has_error = true;
     }
 
     // Parse the return type
     if (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_TYPE)) {
-        node->data.subroutineDec->returnType = arena_strdup(parser->arena,parser->currentToken->lx);
+        node->data.subroutineDec.returnType = token_atom(parser->currentToken);
         queue_pop(parser->queue, &parser->currentToken);
     }else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                              (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
-                              "['%s'] : Expected category > '%s', instead received > '%s'",
-                              token_category_to_string(TOKEN_CATEGORY_TYPE),
-                              token_type_to_string(parser->currentToken->type)
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                            token_line_offset(parser->currentToken),
+                            "['%s'] : Expected category > '%s', instead received > '%s'",
+                            token_category_to_string(TOKEN_CATEGORY_TYPE),
+                            token_type_to_string(parser->currentToken->type)
         );
         parser->has_error = true;
     }
     // Parse the subroutine name
     if (parser->currentToken->type == TOKEN_TYPE_ID) {
-        node->data.subroutineDec->subroutineName = arena_strdup(parser->arena,parser->currentToken->lx);
+        node->data.subroutineDec.subroutineName = token_atom(parser->currentToken);
         queue_pop(parser->queue, &parser->currentToken);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-            (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+            token_line_offset(parser->currentToken),
             "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
             token_type_to_string(parser->currentToken->type)
         );
@@ -241,35 +245,35 @@ ASTNode* parse_subroutine_dec(Parser* parser) {
     }
     expect_and_consume(parser, TOKEN_TYPE_OPEN_PAREN);
     // Parse the parameter list
-    node->data.subroutineDec->parameters = parse_parameter_list(parser);
+    node->data.subroutineDec.parameters = parse_parameter_list(parser);
     expect_and_consume(parser, TOKEN_TYPE_CLOSE_PAREN);
     // Parse the subroutine body
-    node->data.subroutineDec->body = parse_subroutine_body(parser);
-    return node;
+    node->data.subroutineDec.body = parse_subroutine_body(parser);
+    return id;
 }
 
-ASTNode* parse_parameter_list(Parser* parser) {
+NodeId parse_parameter_list(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_PARAMETER_LIST, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_PARAMETER_LIST);
+    ASTNode* node = ast_node(parser->pool, id);
 
     log_message(LOG_LEVEL_DEBUG,ERROR_NONE, "Parsing parameter list. Current Token : %s, Line : %d\n",
                     token_type_to_string(parser->currentToken->type), parser->currentToken->line);
    
-    // Parse the first parameter
+    // Parse the first parameter, every parameter pushes its type and its name, ATOM_NONE when missing
+    uint32_t mark = ast_list_begin(parser->pool);
     if (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_TYPE)) {
 
-        vector_push(node->data.parameterList->parameterTypes, arena_strdup(parser->arena,parser->currentToken->lx));
+        ast_list_push(parser->pool, token_atom(parser->currentToken));
         queue_pop(parser->queue, &parser->currentToken);
 
          if (parser->currentToken->type == TOKEN_TYPE_ID) {
-            vector_push(node->data.parameterList->parameterNames, arena_strdup(parser->arena,parser->currentToken->lx));
+            ast_list_push(parser->pool, token_atom(parser->currentToken));
             queue_pop(parser->queue, &parser->currentToken);
         } else {
-             log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+            ast_list_push(parser->pool, ATOM_NONE);
+             log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                token_line_offset(parser->currentToken),
                 "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
                 token_type_to_string(parser->currentToken->type)
              );
@@ -280,23 +284,25 @@ ASTNode* parse_parameter_list(Parser* parser) {
         while (parser->currentToken->type == TOKEN_TYPE_COMMA) {
             queue_pop(parser->queue, &parser->currentToken);
             if (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_TYPE)) {
-                vector_push(node->data.parameterList->parameterTypes, arena_strdup(parser->arena,parser->currentToken->lx));
+                ast_list_push(parser->pool, token_atom(parser->currentToken));
                 queue_pop(parser->queue, &parser->currentToken);
             } else {
-                log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                                      (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
-                                      "['%s'] : Expected category type > '%s', instead received > '%s'",
-                                      token_category_to_string(TOKEN_CATEGORY_TYPE),
-                                      token_type_to_string(parser->currentToken->type)
+                ast_list_push(parser->pool, ATOM_NONE);
+                log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                                    token_line_offset(parser->currentToken),
+                                    "['%s'] : Expected category type > '%s', instead received > '%s'",
+                                    token_category_to_string(TOKEN_CATEGORY_TYPE),
+                                    token_type_to_string(parser->currentToken->type)
                 );
                 parser->has_error = true;
             }
             if (parser->currentToken->type == TOKEN_TYPE_ID) {
-                vector_push(node->data.parameterList->parameterNames, arena_strdup(parser->arena,parser->currentToken->lx));
+                ast_list_push(parser->pool, token_atom(parser->currentToken));
                 queue_pop(parser->queue, &parser->currentToken);
             } else {
-                log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                    (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+                ast_list_push(parser->pool, ATOM_NONE);
+                log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                    token_line_offset(parser->currentToken),
                     "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
                      token_type_to_string(parser->currentToken->type)
                 );
@@ -306,15 +312,14 @@ ASTNode* parse_parameter_list(Parser* parser) {
         }
     }
 
-    return node;
+    node->data.parameterList.parameters = ast_list_end(parser->pool, mark);
+    return id;
 }
 
-ASTNode* parse_subroutine_body(Parser* parser) {
+NodeId parse_subroutine_body(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_SUBROUTINE_BODY, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_SUBROUTINE_BODY);
+    ASTNode* node = ast_node(parser->pool, id);
 
     log_message(LOG_LEVEL_DEBUG,ERROR_NONE, "Parsing subroutine body. Current Token : %s, Line : %d\n",
         token_type_to_string(parser->currentToken->type), parser->currentToken->line);
@@ -322,25 +327,24 @@ ASTNode* parse_subroutine_body(Parser* parser) {
     expect_and_consume(parser, TOKEN_TYPE_OPEN_BRACE);
 
     // Parse any variable declarations
+    uint32_t mark = ast_list_begin(parser->pool);
     while (parser->currentToken->type == TOKEN_TYPE_VAR) {
-        ASTNode* varDec = parse_var_dec(parser);
-        vector_push(node->data.subroutineBody->varDecs, varDec);
+        ast_list_push(parser->pool, parse_var_dec(parser));
     }
+    node->data.subroutineBody.varDecs = ast_list_end(parser->pool, mark);
 
     // Parse the statements
-    node->data.subroutineBody->statements = parse_statements(parser);
+    node->data.subroutineBody.statements = parse_statements(parser);
 
     expect_and_consume(parser, TOKEN_TYPE_CLOSE_BRACE);
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_var_dec(Parser* parser) {
+NodeId parse_var_dec(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_VAR_DEC, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_VAR_DEC);
+    ASTNode* node = ast_node(parser->pool, id);
 
     log_message(LOG_LEVEL_DEBUG,ERROR_NONE, "Parsing variable declaration. Current Token : %s, Line : %d\n",
         token_type_to_string(parser->currentToken->type), parser->currentToken->line);
@@ -349,25 +353,26 @@ ASTNode* parse_var_dec(Parser* parser) {
 
     // Parse the variable type
     if (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_TYPE)) {
-        node->data.varDec->varType = arena_strdup(parser->arena,parser->currentToken->lx);
+        node->data.varDec.varType = token_atom(parser->currentToken);
         queue_pop(parser->queue, &parser->currentToken);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                              (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
-                              "['%s'] : Expected category > '%s', instead received > '%s'",
-                              token_category_to_string(TOKEN_CATEGORY_TYPE),
-                              token_type_to_string(parser->currentToken->type)
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                            token_line_offset(parser->currentToken),
+                            "['%s'] : Expected category > '%s', instead received > '%s'",
+                            token_category_to_string(TOKEN_CATEGORY_TYPE),
+                            token_type_to_string(parser->currentToken->type)
         );
         parser->has_error = true;
     }
 
     // Parse the first variable name
+    uint32_t mark = ast_list_begin(parser->pool);
     if (parser->currentToken->type == TOKEN_TYPE_ID) {
-        vector_push(node->data.varDec->varNames, arena_strdup(parser->arena,parser->currentToken->lx));
+        ast_list_push(parser->pool, token_atom(parser->currentToken));
         queue_pop(parser->queue, &parser->currentToken);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-            (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+            token_line_offset(parser->currentToken),
             "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
             token_type_to_string(parser->currentToken->type)
         );
@@ -378,11 +383,11 @@ ASTNode* parse_var_dec(Parser* parser) {
     while (parser->currentToken->type == TOKEN_TYPE_COMMA) {
         queue_pop(parser->queue, &parser->currentToken);
         if (parser->currentToken->type == TOKEN_TYPE_ID) {
-            vector_push(node->data.varDec->varNames, arena_strdup(parser->arena,parser->currentToken->lx));
+            ast_list_push(parser->pool, token_atom(parser->currentToken));
             queue_pop(parser->queue, &parser->currentToken);
         } else {
-            log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+            log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                token_line_offset(parser->currentToken),
                 "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
                 token_type_to_string(parser->currentToken->type)
             );
@@ -390,75 +395,71 @@ ASTNode* parse_var_dec(Parser* parser) {
         }
     }
 
+    node->data.varDec.varNames = ast_list_end(parser->pool, mark);
     expect_and_consume(parser, TOKEN_TYPE_SEMICOLON);
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_statements(Parser* parser) {
+NodeId parse_statements(Parser* parser) {
     
-    ASTNode* node = init_ast_node(NODE_STATEMENTS, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_STATEMENTS);
+    ASTNode* node = ast_node(parser->pool, id);
 
     log_message(LOG_LEVEL_DEBUG,ERROR_NONE, "Parsing statements. Current Token : %s, Line : %d\n",
         token_type_to_string(parser->currentToken->type), parser->currentToken->line);
 
     // Parse any statements
+    uint32_t mark = ast_list_begin(parser->pool);
     while (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_STATEMENT)) {
-        ASTNode* statement = parse_statement(parser);
-        vector_push(node->data.statements->statements, statement);
+        ast_list_push(parser->pool, parse_statement(parser));
     }
+    node->data.statements.statements = ast_list_end(parser->pool, mark);
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_statement(Parser* parser) {
+NodeId parse_statement(Parser* parser) {
 
 
-    ASTNode* node = init_ast_node(NODE_STATEMENT, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_STATEMENT);
+    ASTNode* node = ast_node(parser->pool, id);
 
     log_message(LOG_LEVEL_DEBUG,ERROR_NONE, "Parsing statement. Current Token : %s, Line : %d\n",
         token_type_to_string(parser->currentToken->type), parser->currentToken->line);
 
     if (parser->currentToken->type == TOKEN_TYPE_LET) {
-        node->data.statement->statementType = LET;
-        node->data.statement->data.letStatement = parse_let_statement(parser);
+        node->data.statement.statementType = LET;
+        node->data.statement.data.letStatement = parse_let_statement(parser);
     } else if (parser->currentToken->type == TOKEN_TYPE_DO) {
-        node->data.statement->statementType = DO;
-        node->data.statement->data.doStatement = parse_do_statement(parser);
+        node->data.statement.statementType = DO;
+        node->data.statement.data.doStatement = parse_do_statement(parser);
     } else if (parser->currentToken->type == TOKEN_TYPE_IF) {
-        node->data.statement->statementType = IF;
-        node->data.statement->data.ifStatement = parse_if_statement(parser);
+        node->data.statement.statementType = IF;
+        node->data.statement.data.ifStatement = parse_if_statement(parser);
     } else if (parser->currentToken->type == TOKEN_TYPE_WHILE) {
-        node->data.statement->statementType = WHILE;
-        node->data.statement->data.whileStatement = parse_while_statement(parser);
+        node->data.statement.statementType = WHILE;
+        node->data.statement.data.whileStatement = parse_while_statement(parser);
     } else if (parser->currentToken->type == TOKEN_TYPE_RETURN) {
-        node->data.statement->statementType = RETURN;
-        node->data.statement->data.returnStatement = parse_return_statement(parser);
+        node->data.statement.statementType = RETURN;
+        node->data.statement.data.returnStatement = parse_return_statement(parser);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                              (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
-                              "['%s'] : Expected category > '%s', instead received > '%s'",
-                              token_category_to_string(TOKEN_CATEGORY_STATEMENT),
-                              token_type_to_string(parser->currentToken->type)
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                            token_line_offset(parser->currentToken),
+                            "['%s'] : Expected category > '%s', instead received > '%s'",
+                            token_category_to_string(TOKEN_CATEGORY_STATEMENT),
+                            token_type_to_string(parser->currentToken->type)
         );
         parser->has_error = true;
     }
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_let_statement(Parser* parser) {
+NodeId parse_let_statement(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_LET_STATEMENT, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_LET_STATEMENT);
+    ASTNode* node = ast_node(parser->pool, id);
 
     log_message(LOG_LEVEL_DEBUG,ERROR_NONE, "Parsing let statement. Current Token : %s, Line : %d\n",
         token_type_to_string(parser->currentToken->type), parser->currentToken->line);
@@ -467,11 +468,11 @@ ASTNode* parse_let_statement(Parser* parser) {
 
     // Parse the variable name
     if (parser->currentToken->type == TOKEN_TYPE_ID) {
-        node->data.letStatement->varName = arena_strdup(parser->arena,parser->currentToken->lx);
+        node->data.letStatement.varName = token_atom(parser->currentToken);
         queue_pop(parser->queue, &parser->currentToken);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-            (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+            token_line_offset(parser->currentToken),
             "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
             token_type_to_string(parser->currentToken->type)
         );
@@ -481,105 +482,95 @@ ASTNode* parse_let_statement(Parser* parser) {
     // Parse the expression
     if (parser->currentToken->type == TOKEN_TYPE_OPEN_BRACKET) {
         queue_pop(parser->queue, &parser->currentToken);
-        node->data.letStatement->indexExpression = parse_expression(parser);
+        node->data.letStatement.indexExpression = parse_expression(parser);
         expect_and_consume(parser, TOKEN_TYPE_CLOSE_BRACKET);
     }
 
     expect_and_consume(parser, TOKEN_TYPE_EQUAL);
-    node->data.letStatement->rightExpression = parse_expression(parser);
+    node->data.letStatement.rightExpression = parse_expression(parser);
     expect_and_consume(parser, TOKEN_TYPE_SEMICOLON);
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_if_statement(Parser* parser) {
+NodeId parse_if_statement(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_IF_STATEMENT, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_IF_STATEMENT);
+    ASTNode* node = ast_node(parser->pool, id);
 
     expect_and_consume(parser, TOKEN_TYPE_IF);
     expect_and_consume(parser, TOKEN_TYPE_OPEN_PAREN);
-    node->data.ifStatement->condition = parse_expression(parser);
+    node->data.ifStatement.condition = parse_expression(parser);
 
     expect_and_consume(parser, TOKEN_TYPE_CLOSE_PAREN);
     expect_and_consume(parser, TOKEN_TYPE_OPEN_BRACE);
 
-    node->data.ifStatement->ifBranch = parse_statements(parser);
+    node->data.ifStatement.ifBranch = parse_statements(parser);
     expect_and_consume(parser, TOKEN_TYPE_CLOSE_BRACE);
 
     if (parser->currentToken->type == TOKEN_TYPE_ELSE) {
         queue_pop(parser->queue, &parser->currentToken);
         expect_and_consume(parser, TOKEN_TYPE_OPEN_BRACE);
-        node->data.ifStatement->elseBranch = parse_statements(parser);
+        node->data.ifStatement.elseBranch = parse_statements(parser);
         expect_and_consume(parser, TOKEN_TYPE_CLOSE_BRACE);
     }
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_while_statement(Parser* parser) {
+NodeId parse_while_statement(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_WHILE_STATEMENT, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_WHILE_STATEMENT);
+    ASTNode* node = ast_node(parser->pool, id);
 
     expect_and_consume(parser, TOKEN_TYPE_WHILE);
     expect_and_consume(parser, TOKEN_TYPE_OPEN_PAREN);
 
-    node->data.whileStatement->condition = parse_expression(parser);
+    node->data.whileStatement.condition = parse_expression(parser);
 
     expect_and_consume(parser, TOKEN_TYPE_CLOSE_PAREN);
     expect_and_consume(parser, TOKEN_TYPE_OPEN_BRACE);
 
-    node->data.whileStatement->body = parse_statements(parser);
+    node->data.whileStatement.body = parse_statements(parser);
     expect_and_consume(parser, TOKEN_TYPE_CLOSE_BRACE);
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_do_statement(Parser* parser) {
+NodeId parse_do_statement(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_DO_STATEMENT, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_DO_STATEMENT);
+    ASTNode* node = ast_node(parser->pool, id);
 
     expect_and_consume(parser, TOKEN_TYPE_DO);
-    node->data.doStatement->subroutineCall = parse_subroutine_call(parser);
+    node->data.doStatement.subroutineCall = parse_subroutine_call(parser);
     expect_and_consume(parser, TOKEN_TYPE_SEMICOLON);
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_return_statement(Parser* parser) {
+NodeId parse_return_statement(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_RETURN_STATEMENT, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_RETURN_STATEMENT);
+    ASTNode* node = ast_node(parser->pool, id);
 
     expect_and_consume(parser, TOKEN_TYPE_RETURN);
     if (parser->currentToken->type != TOKEN_TYPE_SEMICOLON) {
-        node->data.returnStatement->expression = parse_expression(parser);
+        node->data.returnStatement.expression = parse_expression(parser);
     }
 
     expect_and_consume(parser, TOKEN_TYPE_SEMICOLON);
-    return node;
+    return id;
 }
 
-ASTNode* parse_subroutine_call(Parser *parser) {
+NodeId parse_subroutine_call(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_SUBROUTINE_CALL, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_SUBROUTINE_CALL);
+    ASTNode* node = ast_node(parser->pool, id);
 
     // Parse the caller
     if (parser->currentToken->type == TOKEN_TYPE_ID) {
-        node->data.subroutineCall->caller = arena_strdup(parser->arena,parser->currentToken->lx);
+        node->data.subroutineCall.caller = token_atom(parser->currentToken);
         queue_pop(parser->queue, &parser->currentToken);
     }
 
@@ -587,11 +578,11 @@ ASTNode* parse_subroutine_call(Parser *parser) {
     if (parser->currentToken->type == TOKEN_TYPE_PERIOD) {
         queue_pop(parser->queue, &parser->currentToken);
         if (parser->currentToken->type == TOKEN_TYPE_ID) {
-            node->data.subroutineCall->subroutineName = arena_strdup(parser->arena,parser->currentToken->lx);
+            node->data.subroutineCall.subroutineName = token_atom(parser->currentToken);
             queue_pop(parser->queue, &parser->currentToken);
         } else {
-            log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+            log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                token_line_offset(parser->currentToken),
                 "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
                 token_type_to_string(parser->currentToken->type)
             );
@@ -599,56 +590,56 @@ ASTNode* parse_subroutine_call(Parser *parser) {
         }
     } else {
         // If there is no period after the ID, it is a subroutine call without a caller
-        node->data.subroutineCall->subroutineName = node->data.subroutineCall->caller;
-        node->data.subroutineCall->caller = NULL;
+        node->data.subroutineCall.subroutineName = node->data.subroutineCall.caller;
+        node->data.subroutineCall.caller = ATOM_NONE;
     }
 
     expect_and_consume(parser, TOKEN_TYPE_OPEN_PAREN);
 
     // Parse the expression list
+    uint32_t mark = ast_list_begin(parser->pool);
     while (parser->currentToken->type != TOKEN_TYPE_CLOSE_PAREN) {
-        ASTNode* expression = parse_expression(parser);
-        vector_push(node->data.subroutineCall->arguments, expression);
+        ast_list_push(parser->pool, parse_expression(parser));
 
         if (parser->currentToken->type == TOKEN_TYPE_COMMA) {
             queue_pop(parser->queue, &parser->currentToken);
         }
     }
+    node->data.subroutineCall.arguments = ast_list_end(parser->pool, mark);
 
     expect_and_consume(parser, TOKEN_TYPE_CLOSE_PAREN);
-    return node;
+    return id;
 }
 
-ASTNode *parse_expression(Parser *parser) {
+NodeId parse_expression(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_EXPRESSION, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_EXPRESSION);
+    ASTNode* node = ast_node(parser->pool, id);
 
-    node->data.expression->term = parse_term(parser);
+    node->data.expression.term = parse_term(parser);
 
+    uint32_t mark = ast_list_begin(parser->pool);
     while (is_token_category(parser->currentToken->type, TOKEN_CATEGORY_UNARY | TOKEN_CATEGORY_ARITH
         | TOKEN_CATEGORY_BOOLEAN | TOKEN_CATEGORY_RELATIONAL)) {
 
-        ASTNode* op = init_ast_node(NODE_OPERATION, parser->arena);
+        NodeId opId = ast_new_node(parser->pool, NODE_OPERATION);
+        ASTNode* op = ast_node(parser->pool, opId);
     
-        op->data.operation->op = parser->currentToken->lx[0]; // Assuming lx is the string representation of the token
+        op->data.operation.op = token_lexeme(parser->currentToken)[0]; // Assuming lx is the string representation of the token
         queue_pop(parser->queue, &parser->currentToken);
-        op->data.operation->term = parse_term(parser);
+        op->data.operation.term = parse_term(parser);
 
-        vector_push(node->data.expression->operations, op);
+        ast_list_push(parser->pool, opId);
     }
+    node->data.expression.operations = ast_list_end(parser->pool, mark);
 
-    return node;
+    return id;
 }
 
-ASTNode* parse_term(Parser* parser) {
+NodeId parse_term(Parser* parser) {
 
-    ASTNode* node = init_ast_node(NODE_TERM, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+    NodeId id = new_node(parser, NODE_TERM);
+    ASTNode* node = ast_node(parser->pool, id);
 
     TokenType type = parser->currentToken->type;
 
@@ -657,110 +648,107 @@ ASTNode* parse_term(Parser* parser) {
 
     if (type == TOKEN_TYPE_NUM) {
         // A integer constant
-        node->data.term->termType = INTEGER_CONSTANT;
-        node->data.term->data.intValue = atoi(parser->currentToken->lx);
+        node->data.term.termType = INTEGER_CONSTANT;
+        node->data.term.data.intValue = (int) parser->currentToken->value;
         queue_pop(parser->queue, &parser->currentToken);
     } else if (type == TOKEN_TYPE_STRING) {
         // A string constant
-        node->data.term->termType = STRING_CONSTANT;
-        node->data.term->data.stringValue = arena_strdup(parser->arena,parser->currentToken->lx);
+        node->data.term.termType = STRING_CONSTANT;
+        node->data.term.data.stringValue = token_strdup(parser->currentToken, parser->arena);
         queue_pop(parser->queue, &parser->currentToken);
     } else if (type == TOKEN_TYPE_TRUE || type == TOKEN_TYPE_FALSE || type == TOKEN_TYPE_NULL || type == TOKEN_TYPE_THIS) {
         // A keyword constant
-        node->data.term->termType = KEYWORD_CONSTANT;
-        node->data.term->data.keywordValue = arena_strdup(parser->arena,parser->currentToken->lx);
+        node->data.term.termType = KEYWORD_CONSTANT;
+        node->data.term.data.keywordValue = token_atom(parser->currentToken);
         queue_pop(parser->queue, &parser->currentToken);
     } else if (type == TOKEN_TYPE_ID) {
-        Token* nextToken = (Token*) queue_peek(parser->queue);
+        TokenType next = queue_peek(parser->queue);
 
-        if (nextToken->type == TOKEN_TYPE_OPEN_BRACKET) {
+        if (next == TOKEN_TYPE_OPEN_BRACKET) {
             // It's an array access
-            node->data.term->termType = ARRAY_ACCESS;
-            node->data.term->data.arrayAccess.arrayName = arena_strdup(parser->arena,parser->currentToken->lx);
+            node->data.term.termType = ARRAY_ACCESS;
+            node->data.term.data.arrayAccess.arrayName = token_atom(parser->currentToken);
 
             expect_and_consume(parser, TOKEN_TYPE_ID);
             expect_and_consume(parser, TOKEN_TYPE_OPEN_BRACKET);
-            node->data.term->data.arrayAccess.index = parse_expression(parser);
+            node->data.term.data.arrayAccess.index = parse_expression(parser);
             expect_and_consume(parser, TOKEN_TYPE_CLOSE_BRACKET);
-        } else if (nextToken->type == TOKEN_TYPE_PERIOD) {
-            Token* secondPeek = (Token*) queue_peek_offset(parser->queue, 1);
-
-            if (secondPeek->type == TOKEN_TYPE_ID) {
-                 Token* thirdPeek = (Token*) queue_peek_offset(parser->queue, 2);
-                 if (thirdPeek->type == TOKEN_TYPE_OPEN_PAREN) {
-                     node->data.term->termType = SUBROUTINE_CALL;
-                     node->data.term->data.subroutineCall = parse_subroutine_call(parser);
+        } else if (next == TOKEN_TYPE_PERIOD) {
+            TokenType second = queue_peek_offset(parser->queue, 1);
+
+            if (second == TOKEN_TYPE_ID) {
+                 if (queue_peek_offset(parser->queue, 2) == TOKEN_TYPE_OPEN_PAREN) {
+                     node->data.term.termType = SUBROUTINE_CALL;
+                     node->data.term.data.subroutineCall = parse_subroutine_call(parser);
                  } else {
-                     node->data.term->termType = VAR_TERM;
-                     node->data.term->data.varTerm = parse_var_term(parser);
+                     node->data.term.termType = VAR_TERM;
+                     node->data.term.data.varTerm = parse_var_term(parser);
                  }
             } else {
-                log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                    (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+                log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                    token_line_offset(parser->currentToken),
                     "['%s'] : Unexpected token after period > '%s'",
-                    token_type_to_string(secondPeek->type)
+                    token_type_to_string(second)
                 );
                 parser->has_error = true;
             }
         } else {
-            node->data.term->termType = VAR_TERM;
-            node->data.term->data.varTerm  = parse_var_term(parser);
+            node->data.term.termType = VAR_TERM;
+            node->data.term.data.varTerm  = parse_var_term(parser);
         }
     } else if (type == TOKEN_TYPE_OPEN_PAREN) {
         // It's an expression inside parentheses
-        node->data.term->termType = EXPRESSION;
+        node->data.term.termType = EXPRESSION;
         queue_pop(parser->queue, &parser->currentToken);
-        node->data.term->data.expression = parse_expression(parser);
+        node->data.term.data.expression = parse_expression(parser);
         expect_and_consume(parser, TOKEN_TYPE_CLOSE_PAREN);
     } else if (type == TOKEN_TYPE_HYPHEN || type == TOKEN_TYPE_TILDE) {
         // It's a unary operation
-        node->data.term->termType = UNARY_OP;
-        node->data.term->data.unaryOp.unaryOp = parser->currentToken->lx[0];
+        node->data.term.termType = UNARY_OP;
+        node->data.term.data.unaryOp.unaryOp = token_lexeme(parser->currentToken)[0];
         queue_pop(parser->queue, &parser->currentToken);
-        node->data.term->data.unaryOp.term = parse_term(parser);
+        node->data.term.data.unaryOp.term = parse_term(parser);
     } else {
-        log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-            (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+        log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+            token_line_offset(parser->currentToken),
             "['%s'] : Unexpected token in term > '%s'", token_type_to_string(parser->currentToken->type)
         );
         parser->has_error = true;
-        node->data.term->termType = TRM_NONE;
+        node->data.term.termType = TRM_NONE;
         queue_pop(parser->queue, &parser->currentToken);
-        return NULL;
+        return NODE_NONE;
     }
-    return node;
+    return id;
 }
 
 
-ASTNode* parse_var_term(Parser* parser) {
-    ASTNode* node = init_ast_node(NODE_VAR_TERM, parser->arena);
-    node->filename = arena_strdup(parser->arena, parser->currentToken->filename);
-    node->line = parser->currentToken->line;
-    node->byte_offset = *(size_t*)vector_get(parser->line_offsets, node->line  - 1);
+NodeId parse_var_term(Parser* parser) {
+    NodeId id = new_node(parser, NODE_VAR_TERM);
+    ASTNode* node = ast_node(parser->pool, id);
 
-    char* possibleClassName;
+    Atom possibleClassName = ATOM_NONE;
     if (parser->currentToken->type == TOKEN_TYPE_ID) {
-        possibleClassName = arena_strdup(parser->arena,parser->currentToken->lx);
+        possibleClassName = token_atom(parser->currentToken);
         queue_pop(parser->queue, &parser->currentToken);
     }
 
     if (parser->currentToken->type == TOKEN_TYPE_PERIOD) {
-        node->data.varTerm->className = possibleClassName;
+        node->data.varTerm.className = possibleClassName;
         queue_pop(parser->queue, &parser->currentToken);
         if (parser->currentToken->type == TOKEN_TYPE_ID) {
-            node->data.varTerm->varName = arena_strdup(parser->arena,parser->currentToken->lx);
+            node->data.varTerm.varName = token_atom(parser->currentToken);
             queue_pop(parser->queue, &parser->currentToken);
         } else {
-            log_error_with_offset(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->filename, parser->currentToken->line,
-                (size_t) vector_get(parser->line_offsets, parser->currentToken->line),
+            log_error_in_source(ERROR_PHASE_PARSER, ERROR_PARSER_UNEXPECTED_TOKEN, parser->currentToken->source, parser->currentToken->filename, parser->currentToken->line,
+                token_line_offset(parser->currentToken),
                 "['%s'] : Expected token > '%s', instead received > '%s'", token_type_to_string(TOKEN_TYPE_ID),
                 token_type_to_string(parser->currentToken->type)
             );
             parser->has_error = true;
         }
     } else {
-        node->data.varTerm->varName = possibleClassName;
+        node->data.varTerm.varName = possibleClassName;
     }
 
-    return node;
+    return id;
 }
\ No newline at end of file
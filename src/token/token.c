@@ -3,29 +3,8 @@
 #include <string.h>
 #include <stdio.h>
 
-static const TokenMapping tokenMappings[21] = {
-    {"class", TOKEN_TYPE_CLASS},
-    {"constructor", TOKEN_TYPE_CONSTRUCTOR},
-    {"method", TOKEN_TYPE_METHOD},
-    {"function", TOKEN_TYPE_FUNCTION},
-    {"int", TOKEN_TYPE_INT},
-    {"boolean", TOKEN_TYPE_BOOLEAN},
-    {"char", TOKEN_TYPE_CHAR},
-    {"var", TOKEN_TYPE_VAR},
-    {"void", TOKEN_TYPE_VOID},
-    {"static", TOKEN_TYPE_STATIC},
-    {"field", TOKEN_TYPE_FIELD},
-    {"let", TOKEN_TYPE_LET},
-    {"do", TOKEN_TYPE_DO},
-    {"if", TOKEN_TYPE_IF},
-    {"else", TOKEN_TYPE_ELSE},
-    {"while", TOKEN_TYPE_WHILE},
-    {"return", TOKEN_TYPE_RETURN},
-    {"true", TOKEN_TYPE_TRUE},
-    {"false", TOKEN_TYPE_FALSE},
-    {"null", TOKEN_TYPE_NULL},
-    {"this", TOKEN_TYPE_THIS},
-};
+// keywordTable, a perfect hash of the keywords of keywords.def generated by tools/keyword_gen.c
+#include "keyword_table.h"
 
 static const TokenCategory tokenCategories[62] = {
     [TOKEN_TYPE_ID] = TOKEN_CATEGORY_TYPE | TOKEN_CATEGORY_FACTOR,
@@ -124,20 +103,23 @@ const char* token_type_to_string(TokenType type) {
 
 /**
  * Get the TokenType corresponding to the given string.
+ * Keywords are found with one hash of the length and the first and last characters, and one compare.
  *
- * @param str The string representation of the token.
+ * @param str The string representation of the token, not necessarily NUL terminated.
+ * @param len The length of the string.
  * @return The TokenType corresponding to the string, or TOKEN_TYPE_ID if not found.
  */
-TokenType token_type_from_str(const char *str)
+TokenType token_type_from_str(const char *str, size_t len)
 {
-    size_t numMappings = sizeof(tokenMappings) / sizeof(TokenMapping);
+    if (len < KEYWORD_MIN_LEN || len > KEYWORD_MAX_LEN)
+    {
+        return TOKEN_TYPE_ID;
+    }
 
-    for (size_t i = 0; i < numMappings; i++)
+    const TokenMapping *mapping = &keywordTable[KEYWORD_HASH(str, len)];
+    if (mapping->str != NULL && strncmp(str, mapping->str, len) == 0 && mapping->str[len] == '\0')
     {
-        if (strcmp(str, tokenMappings[i].str) == 0)
-        {
-            return tokenMappings[i].tokenType;
-        }
+        return mapping->tokenType;
     }
 
     return TOKEN_TYPE_ID;
@@ -220,43 +202,49 @@ char* token_to_string(const Token *token)
 {
     // Assuming the lexeme won't be more than 100 characters.
     // Please adjust this size as per your needs.
-    static char buffer[200];
-    snprintf(buffer, sizeof(buffer), "Token {  type: %-30s Lexeme: %-10s Line: %d }",
+    static _Thread_local char buffer[200];
+    if (token->type == TOKEN_TYPE_NUM) {
+        snprintf(buffer, sizeof(buffer), "Token {  type: %-30s Lexeme: %-10u Line: %d }",
+                 token_type_names[token->type], token->value, token->line);
+        return buffer;
+    }
+    snprintf(buffer, sizeof(buffer), "Token {  type: %-30s Lexeme: %-10.*s Line: %d }",
            token_type_names[token->type],
-           token->lx,
+           (int) token->length, token_lexeme(token),
            token->line);
     return buffer;
 }
 
 /**
- * Create a new token. Takes ownership of the 'lx' string,
- *
- * @param type The type of the token.
- * @param lx The string associated with the token.
- * @param line The line number where the token was found.
- * @return A pointer to the newly created token.
+ * The first character of the lexeme. It is not NUL terminated, but is always followed by
+ * a character that cannot continue it (or the NUL at the end of the source).
+ * Integer constants have no lexeme, see `Token`.
  */
-Token *new_token(const char* filename, TokenType type, char *lx, int line, Arena* arena)
+const char* token_lexeme(const Token *token)
 {
-    Token *token = arena_alloc(arena, sizeof(Token));
-    if (token == NULL)
-    {
-        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
-                            "['%s'] : Failed to allocate memory for a token", __func__);
-        return NULL;
-    }
-    token->filename = filename; // Points to memory from
-    token->type = type; // Pass by value - copy
-    token->lx = lx; // Take ownership of the lx string
-    token->line = line;
+    return token->source->data + token->offset;
+}
 
-    return token;
+/**
+ * The byte offset of the '\n' before the token's line, (size_t) -1 on the first line.
+ */
+size_t token_line_offset(const Token *token)
+{
+    return source_line_offset(token->source, token->line);
 }
 
-void destroy_token(Token *token)
+/**
+ * Copy the lexeme into `arena`, for strings that have to outlive the source buffer.
+ */
+char* token_strdup(const Token *token, Arena* arena)
 {
-    if (token != NULL)
-    {
-        free(token->lx);
-    }
-}
\ No newline at end of file
+    return arena_strndup(arena, token_lexeme(token), token->length);
+}
+
+/**
+ * The atom of the lexeme, for identifiers and type names.
+ */
+Atom token_atom(const Token *token)
+{
+    return intern(token_lexeme(token), token->length);
+}
@@ -1,7 +1,13 @@
 #include "token_queue.h"
 #include "logger.h"
+#include <stdlib.h>
+#include <string.h>
 
-TokenQueue *queue_init(Arena *arena) {
+#define INITIAL_TOKENS 256
+
+_Static_assert(TOKEN_TYPE_LESS_THAN <= UINT8_MAX, "token types are stored in a uint8_t");
+
+TokenQueue *queue_init(const char *filename, const SourceBuffer *source, Arena *arena) {
     TokenQueue *queue = arena_alloc(arena, sizeof(TokenQueue));
 
     if (!queue) {
@@ -11,25 +17,163 @@ TokenQueue *queue_init(Arena *arena) {
     }
 
     queue->idx = 0;
-    queue->list = vector_create();
+    queue->ring = NULL;
+    queue->pull = NULL;
+    queue->pull_ctx = NULL;
+    queue->head = 0;
+    queue->drained = false;
+    queue->stream = (TokenStream) {
+        .types = NULL,
+        .offsets = NULL,
+        .lengths = NULL,
+        .lines = NULL,
+        .count = 0,
+        .capacity = 0,
+        .filename = filename,
+        .source = source,
+    };
+
+    return queue;
+}
+
+/**
+ * @brief A queue whose tokens are handed over through a bounded ring instead of being collected,
+ * so only the tokens inside the window are alive at any time. One thread pushes, another one pops.
+ */
+TokenQueue *queue_init_streaming(const char *filename, const SourceBuffer *source, Arena *arena) {
+    TokenQueue *queue = queue_init(filename, source, arena);
+    if (!queue) {
+        return NULL;
+    }
+
+    queue->ring = init_ringbuffer();
+    if (!queue->ring) {
+        return NULL;
+    }
+
+    return queue;
+}
+
+static bool resize_stream(TokenStream *stream, size_t capacity) {
+    uint8_t *types = realloc(stream->types, capacity * sizeof(uint8_t));
+    if (types != NULL) {
+        stream->types = types;
+    }
+    uint32_t *offsets = realloc(stream->offsets, capacity * sizeof(uint32_t));
+    if (offsets != NULL) {
+        stream->offsets = offsets;
+    }
+    uint32_t *lengths = realloc(stream->lengths, capacity * sizeof(uint32_t));
+    if (lengths != NULL) {
+        stream->lengths = lengths;
+    }
+    uint32_t *lines = realloc(stream->lines, capacity * sizeof(uint32_t));
+    if (lines != NULL) {
+        stream->lines = lines;
+    }
 
-    if (!queue->list) {
+    if (!types || !offsets || !lengths || !lines) {
         log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
-                            "['%s'] : Failed to create list for the token queue", __func__);
+                            "['%s'] : Failed to grow the token stream", __func__);
+        return false;
+    }
+    stream->capacity = capacity;
+    return true;
+}
+
+static bool grow_stream(TokenStream *stream) {
+    return resize_stream(stream, stream->capacity ? stream->capacity * 2 : INITIAL_TOKENS);
+}
+
+/**
+ * @brief A queue the parser drives : when it pops or peeks past the tokens at hand, `pull(ctx)` lexes the
+ * next ones into a ring of PULL_WINDOW tokens. The whole file is never tokenized at once.
+ */
+TokenQueue *queue_init_pull(const char *filename, const SourceBuffer *source, Arena *arena, TokenPull pull, void *ctx) {
+    TokenQueue *queue = queue_init(filename, source, arena);
+    if (!queue || !resize_stream(&queue->stream, PULL_WINDOW)) {
         return NULL;
     }
 
+    queue->pull = pull;
+    queue->pull_ctx = ctx;
     return queue;
 }
 
-bool queue_push(TokenQueue *queue, Token *ptr) {
-    if (!queue || !ptr) {
+/**
+ * @brief Free slots of a pull queue, how many tokens its lexer may push before the parser pops.
+ */
+size_t queue_space(const TokenQueue *queue) {
+    return queue->stream.capacity - queue->stream.count;
+}
+
+/**
+ * Pull until `needed` tokens are at hand or the input ends.
+ */
+static void pull_tokens(TokenQueue *queue, size_t needed) {
+    while (queue->stream.count < needed && !queue->drained) {
+        queue->drained = !queue->pull(queue->pull_ctx);
+    }
+}
+
+/**
+ * Append a token. The token is copied, into the ring or the stream, so `token` may point to a temporary.
+ */
+bool queue_push(TokenQueue *queue, const Token *token) {
+    if (!queue || !token) {
         log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
                             "['%s'] : Null pointer provided", __func__);
         return false;
     }
 
-    vector_push(queue->list, ptr);
+    if (queue->ring) {
+        return ringbuffer_push(queue->ring, token);
+    }
+
+    TokenStream *stream = &queue->stream;
+    size_t slot = stream->count;
+    if (queue->pull) {
+        if (stream->count == stream->capacity) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_BUFFER_FULL, __FILE__, __LINE__,
+                                "['%s'] : Pulled more tokens than the window holds", __func__);
+            return false;
+        }
+        slot = (queue->head + stream->count) & (stream->capacity - 1);
+    } else if (stream->count == stream->capacity && !grow_stream(stream)) {
+        return false;
+    }
+    stream->types[slot] = (uint8_t) token->type;
+    stream->offsets[slot] = token->offset; // or the value, they share the slot
+    stream->lengths[slot] = token->length;
+    stream->lines[slot] = (uint32_t) token->line;
+    stream->count++;
+    return true;
+}
+
+/**
+ * Append all tokens of `tokens`, which must come from the same source, to a collecting queue.
+ */
+bool queue_append(TokenQueue *queue, const TokenStream *tokens) {
+    if (!queue || !tokens || queue->ring) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
+                            "['%s'] : Null pointer or streaming queue provided", __func__);
+        return false;
+    }
+
+    TokenStream *stream = &queue->stream;
+    while (stream->count + tokens->count > stream->capacity) {
+        if (!grow_stream(stream)) {
+            return false;
+        }
+    }
+    if (tokens->count == 0) {
+        return true;
+    }
+    memcpy(stream->types + stream->count, tokens->types, tokens->count * sizeof(uint8_t));
+    memcpy(stream->offsets + stream->count, tokens->offsets, tokens->count * sizeof(uint32_t));
+    memcpy(stream->lengths + stream->count, tokens->lengths, tokens->count * sizeof(uint32_t));
+    memcpy(stream->lines + stream->count, tokens->lines, tokens->count * sizeof(uint32_t));
+    stream->count += tokens->count;
     return true;
 }
 
@@ -40,52 +184,128 @@ bool queue_pop(TokenQueue *queue, Token **val) {
         return false;
     }
 
-    if (queue->idx >= vector_size(queue->list)) {
+    if (queue->ring) {
+        if (!ringbuffer_pop(queue->ring, val)) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
+                                "['%s'] : Null pointer provided", __func__);
+            return false;
+        }
+        queue->idx++;
+        return true;
+    }
+
+    TokenStream *stream = &queue->stream;
+    size_t idx = (size_t) queue->idx;
+    bool available = idx < stream->count;
+    if (queue->pull) {
+        pull_tokens(queue, 1);
+        idx = queue->head;
+        available = stream->count > 0;
+    }
+    if (!available) {
         log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
                             "['%s'] : Null pointer provided", __func__);
         return false;
     }
 
-    *val = vector_get(queue->list, queue->idx);
+    queue->current = (Token) {
+        .type = (TokenType) stream->types[idx],
+        .line = (int) stream->lines[idx],
+        .filename = stream->filename,
+        .source = stream->source,
+        .offset = stream->offsets[idx],     // or the value
+        .length = stream->lengths[idx],
+    };
+    *val = &queue->current;
     queue->idx++;
+    if (queue->pull) {
+        queue->head = (queue->head + 1) & (stream->capacity - 1);
+        stream->count--;
+    }
     return true;
 }
 
-Token *queue_peek(const TokenQueue *queue) {
+/**
+ * @brief The type of the token `offset` tokens past the next one, nothing is consumed.
+ * @return TOKEN_TYPE_UNRECOGNISED past the last token
+ */
+TokenType queue_peek_offset(TokenQueue *queue, int offset) {
     if (!queue) {
         log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
                             "['%s'] : Null pointer provided", __func__);
-        return NULL;
+        return TOKEN_TYPE_UNRECOGNISED;
+    }
+
+    if (queue->ring) {
+        const Token *token = ringbuffer_peek(queue->ring, (size_t) offset);
+        return token ? token->type : TOKEN_TYPE_UNRECOGNISED;
     }
 
-    if (queue->idx < vector_size(queue->list)) {
-        return vector_get(queue->list, queue->idx);
+    if (queue->pull) {
+        pull_tokens(queue, (size_t) offset + 1);
+        if ((size_t) offset < queue->stream.count) {
+            return (TokenType) queue->stream.types[(queue->head + (size_t) offset) & (queue->stream.capacity - 1)];
+        }
+        return TOKEN_TYPE_UNRECOGNISED;
     }
 
-    return NULL;
+    size_t idx = (size_t) queue->idx + (size_t) offset;
+    if (idx < queue->stream.count) {
+        return (TokenType) queue->stream.types[idx];
+    }
+    return TOKEN_TYPE_UNRECOGNISED;
 }
 
+TokenType queue_peek(TokenQueue *queue) {
+    return queue_peek_offset(queue, 0);
+}
 
-Token* queue_peek_offset(TokenQueue *queue, int offset) {
-    if (!queue) {
-        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
-                            "['%s'] : Null pointer provided", __func__);
-        return NULL;
+/**
+ * @brief Tokens collected so far. A streaming or pull queue does not keep them, it counts the popped ones.
+ */
+size_t queue_size(const TokenQueue *queue) {
+    if (queue->ring || queue->pull) {
+        return (size_t) queue->idx;
     }
+    return queue->stream.count;
+}
 
-    if (queue->idx + offset < vector_size(queue->list)) {
-        return vector_get(queue->list, queue->idx + offset);
+/**
+ * Producer side of a streaming queue : no more tokens will follow.
+ */
+void queue_close(TokenQueue* queue) {
+    if (queue != NULL && queue->ring != NULL) {
+        ringbuffer_close(queue->ring);
     }
-    return NULL;
 }
 
+/**
+ * Consumer side of a streaming queue : no more tokens will be read, the producer may stop.
+ * A pull queue runs its lexer to the end of the input, dropping the tokens, so every diagnostic is reported.
+ */
+void queue_cancel(TokenQueue* queue) {
+    if (queue != NULL && queue->ring != NULL) {
+        ringbuffer_cancel(queue->ring);
+    }
+    if (queue != NULL && queue->pull != NULL) {
+        while (!queue->drained) {
+            queue->stream.count = 0;
+            queue->drained = !queue->pull(queue->pull_ctx);
+        }
+        queue->stream.count = 0;
+    }
+}
 
 void destroy_queue(TokenQueue* queue) {
     if (queue != NULL) {
-        for(int i = 0; i < vector_size(queue->list); ++i) {
-            Token* tok = (Token*) vector_get(queue->list, i);
-            destroy_token(tok);
+        if (queue->ring != NULL) {
+            ringbuffer_destroy(queue->ring);
+            queue->ring = NULL;
         }
-        vector_destroy(queue->list);
+        free(queue->stream.types);
+        free(queue->stream.offsets);
+        free(queue->stream.lengths);
+        free(queue->stream.lines);
+        queue->stream = (TokenStream) {0};
     }
 }
@@ -1,3 +1,6 @@
+#ifdef ARENA_HUGEPAGES
+    #define _DEFAULT_SOURCE // MADV_HUGEPAGE
+#endif
 #include "arena.h"
 #include <stdlib.h>
 #include <stdalign.h>
@@ -5,6 +8,8 @@
 #include <stddef.h>
 #include "logger.h"
 #include <string.h>
+#include <pthread.h>
+#include "vector.h"
 
 #ifdef _WIN32
     #include <windows.h>
@@ -13,13 +18,47 @@
     #include <unistd.h>
 #endif
 
- struct Arena {
+/**
+ * A reserved block of address space, committed page by page as it fills up.
+ */
+typedef struct ArenaRegion {
     void* start;
     void* current;
     void* committed_end;
     void* reserved_end;
+    struct ArenaRegion* prev;   // older, full region
+} ArenaRegion;
+
+/**
+ * An arena is a chain of regions. When the newest region is full another one is reserved, at least twice
+ * as large, so pointers handed out earlier stay valid and a program of any size fits.
+ */
+ struct Arena {
+    ArenaRegion* region;  // newest region, all allocations come from it
+    size_t used_before;   // bytes in use in the older regions
+    ArenaStats stats;
+    const char* name;     // registry entry, NULL if the arena is not registered
 };
 
+// Regions stop doubling at this size and grow linearly after
+#define ARENA_MAX_REGION_SIZE ((size_t) 1 << 30)
+// Regions at least this large are advised to use transparent huge pages (ARENA_HUGEPAGES)
+#define ARENA_HUGEPAGE_SIZE ((size_t) 2 << 20)
+
+/**
+ * Arenas registered under a name, e.g. every class arena under "class". The stats of a destroyed
+ * arena are folded into its entry, so arenas that only live for one file are still reported at exit.
+ */
+typedef struct {
+    const char* name;
+    size_t num_arenas;
+    ArenaStats retired;        // sum over destroyed arenas, `high_water` is the largest of them
+    vector live;               // registered arenas that are not destroyed yet
+} ArenaRegistryEntry;
+
+static vector arena_registry = NULL;
+static pthread_mutex_t arena_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
 #define PAGE_SIZE (get_page_size())
 #define ALIGN_UP(pointer, alignment) \
     ((void*)(((uintptr_t)(pointer) + (alignment)-1) & ~((alignment)-1)))
@@ -35,31 +74,95 @@ static size_t get_page_size() {
     #endif
 }
 
-Arena* init_arena(size_t multiplier) {
-    size_t size = multiplier * PAGE_SIZE;
-
-    Arena* arena = malloc(sizeof(Arena));
-    if (!arena) {
+static ArenaRegion* reserve_region(size_t size) {
+    ArenaRegion* region = malloc(sizeof(ArenaRegion));
+    if (!region) {
         return NULL;
     }
 
     #ifdef _WIN32
-        arena->start = VirtualAlloc(0, size, MEM_RESERVE, PAGE_READWRITE);
+        region->start = VirtualAlloc(0, size, MEM_RESERVE, PAGE_READWRITE);
+        if (region->start == NULL) {
+            free(region);
+            return NULL;
+        }
     #else
-        arena->start = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-        if (arena->start == MAP_FAILED) {
-            free(arena);
+        region->start = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region->start == MAP_FAILED) {
+            free(region);
             return NULL;
         }
+        #if defined(ARENA_HUGEPAGES) && defined(MADV_HUGEPAGE)
+            if (size >= ARENA_HUGEPAGE_SIZE) {
+                madvise(region->start, size, MADV_HUGEPAGE);
+            }
+        #endif
     #endif
 
-    arena->current = arena->start;
-    arena->committed_end = arena->start;
-    arena->reserved_end = arena->start + size;
+    region->current = region->start;
+    region->committed_end = region->start;
+    region->reserved_end = (char*)region->start + size;
+    region->prev = NULL;
+    return region;
+}
+
+static bool release_region(ArenaRegion* region) {
+    bool released = true;
+    #ifdef _WIN32
+        released = VirtualFree(region->start, 0, MEM_RELEASE);
+    #else
+        released = munmap(region->start, (char*)region->reserved_end - (char*)region->start) == 0;
+    #endif
+    free(region);
+    return released;
+}
+
+Arena* init_arena(size_t multiplier) {
+    size_t size = multiplier * PAGE_SIZE;
+
+    Arena* arena = malloc(sizeof(Arena));
+    if (!arena) {
+        return NULL;
+    }
+
+    arena->region = reserve_region(size);
+    if (!arena->region) {
+        free(arena);
+        return NULL;
+    }
+
+    arena->used_before = 0;
+    memset(&arena->stats, 0, sizeof(ArenaStats));
+    arena->stats.bytes_reserved = size;
+    arena->stats.num_regions = 1;
+    arena->name = NULL;
     return arena;
 }
 
+/**
+ * @brief Chain a region that can hold `size` more bytes. Regions double in size up to `ARENA_MAX_REGION_SIZE`.
+ */
+static bool grow_arena(Arena* arena, size_t size) {
+    ArenaRegion* full = arena->region;
+    size_t full_size = (char*)full->reserved_end - (char*)full->start;
+    size_t needed = (size + alignof(max_align_t) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    size_t region_size = full_size < ARENA_MAX_REGION_SIZE ? full_size * 2 : full_size;
+    if (region_size < needed) {
+        region_size = needed;
+    }
+
+    ArenaRegion* region = reserve_region(region_size);
+    if (!region) {
+        return false;
+    }
 
+    region->prev = full;
+    arena->used_before += (char*)full->current - (char*)full->start;
+    arena->region = region;
+    arena->stats.bytes_reserved += region_size;
+    arena->stats.num_regions++;
+    return true;
+}
 
 static bool commit_memory(void* addr, size_t size) {
     // Size, rounded to page boundaries.
@@ -73,42 +176,169 @@ static bool commit_memory(void* addr, size_t size) {
 }
 
 void* arena_alloc(Arena* arena, size_t size) {
-    // Check if there's enough space
-    if (!arena || arena->current + size > arena->reserved_end) {
-        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
-                            "['%s'] : Arena out of space", __func__);
+    if (!arena) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
+                            "['%s'] : Null pointer provided", __func__);
         return NULL;
     }
 
     // Align the current pointer to the system's word size
-    arena->current = ALIGN_UP(arena->current, alignof(max_align_t));
+    ArenaRegion* region = arena->region;
+    void* aligned = ALIGN_UP(region->current, alignof(max_align_t));
+
+    // Chain a new region once this one is full
+    if ((char*)aligned + size > (char*)region->reserved_end) {
+        if (!grow_arena(arena, size)) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                                "['%s'] : Failed to reserve another arena region", __func__);
+            return NULL;
+        }
+        region = arena->region;
+        aligned = region->current;
+    }
+    arena->stats.alignment_waste += (char*)aligned - (char*)region->current;
+    region->current = aligned;
 
     // Check if we need to commit more memory
-    if (arena->current + size > arena->committed_end) {
-        size_t needed_size = ((char*)arena->current + size) - (char*)arena->committed_end;
+    if ((char*)region->current + size > (char*)region->committed_end) {
+        size_t needed_size = ((char*)region->current + size) - (char*)region->committed_end;
         size_t commit_size = (needed_size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
-        if (!commit_memory(arena->committed_end, needed_size)) {
+        if (!commit_memory(region->committed_end, needed_size)) {
             log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
                             "['%s'] : Failed to commit memory from the arena", __func__);
             return NULL;
         }
-        arena->committed_end = (char*)arena->committed_end + commit_size;
+        region->committed_end = (char*)region->committed_end + commit_size;
+        arena->stats.bytes_committed += commit_size;
+        arena->stats.num_commits++;
     }
 
 
-    void* result = arena->current;
-    arena->current = (char*)arena->current + size;
+    void* result = region->current;
+    region->current = (char*)region->current + size;
+
+    arena->stats.bytes_requested += size;
+    arena->stats.num_allocations++;
+    size_t in_use = arena->used_before + ((char*)region->current - (char*)region->start);
+    if (in_use > arena->stats.high_water) {
+        arena->stats.high_water = in_use;
+    }
     return result;
 }
 
 
+/**
+ * @brief Free every allocation. Chained regions are released, the first region is kept (and stays committed)
+ * for reuse.
+ */
 void reset_arena(Arena* arena) {
     if (!arena) {
          log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
                             "['%s'] : Null pointer provided", __func__);
         return;
     }
-    arena->current = arena->start;
+    while (arena->region->prev) {
+        ArenaRegion* region = arena->region;
+        arena->region = region->prev;
+        if (!release_region(region)) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                            "['%s'] : Failed to unmap arena region", __func__);
+        }
+    }
+    arena->region->current = arena->region->start;
+    arena->used_before = 0;
+}
+
+ArenaStats arena_stats(const Arena* arena) {
+    return arena->stats;
+}
+
+static void add_stats(ArenaStats* total, const ArenaStats* stats) {
+    total->bytes_reserved += stats->bytes_reserved;
+    total->bytes_requested += stats->bytes_requested;
+    total->bytes_committed += stats->bytes_committed;
+    total->num_allocations += stats->num_allocations;
+    total->num_commits += stats->num_commits;
+    total->num_regions += stats->num_regions;
+    total->alignment_waste += stats->alignment_waste;
+    if (stats->high_water > total->high_water) {
+        total->high_water = stats->high_water;
+    }
+}
+
+// Must be called with the registry lock held
+static ArenaRegistryEntry* find_registry_entry(const char* name) {
+    for (int i = 0; i < vector_size(arena_registry); ++i) {
+        ArenaRegistryEntry* entry = vector_get(arena_registry, i);
+        if (strcmp(entry->name, name) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Report `arena` under `name` in `print_arena_stats`. Arenas sharing a name are reported together,
+ * `name` must outlive the registry (a string literal).
+ */
+void arena_register(Arena* arena, const char* name) {
+    if (!arena || !name) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
+                            "['%s'] : Null pointer provided", __func__);
+        return;
+    }
+
+    pthread_mutex_lock(&arena_registry_lock);
+    if (!arena_registry) {
+        arena_registry = vector_create();
+    }
+    ArenaRegistryEntry* entry = find_registry_entry(name);
+    if (!entry) {
+        entry = calloc(1, sizeof(ArenaRegistryEntry));
+        entry->name = name;
+        entry->live = vector_create();
+        vector_push(arena_registry, entry);
+    }
+    entry->num_arenas++;
+    vector_push(entry->live, arena);
+    arena->name = name;
+    pthread_mutex_unlock(&arena_registry_lock);
+}
+
+static void retire_arena(Arena* arena) {
+    pthread_mutex_lock(&arena_registry_lock);
+    ArenaRegistryEntry* entry = find_registry_entry(arena->name);
+    for (int i = 0; entry && i < vector_size(entry->live); ++i) {
+        if (vector_get(entry->live, i) == arena) {
+            vector_remove(entry->live, i);
+            add_stats(&entry->retired, &arena->stats);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&arena_registry_lock);
+}
+
+/**
+ * @brief Print the stats of every registered arena name to stderr : the number of arenas, the sum of their
+ * counters, and the largest high-water mark of a single arena - the figure to size its reservation by.
+ */
+void print_arena_stats() {
+    pthread_mutex_lock(&arena_registry_lock);
+    fprintf(stderr, "===================================== Arena Statistics ======================================\n");
+    fprintf(stderr, "%-10s %7s %8s %12s %12s %12s %9s %8s %10s %12s\n", "arena", "count", "regions", "reserved",
+            "requested", "committed", "allocs", "commits", "waste", "high-water");
+    for (int i = 0; arena_registry && i < vector_size(arena_registry); ++i) {
+        ArenaRegistryEntry* entry = vector_get(arena_registry, i);
+        ArenaStats total = entry->retired;
+        for (int j = 0; j < vector_size(entry->live); ++j) {
+            add_stats(&total, &((Arena*) vector_get(entry->live, j))->stats);
+        }
+        fprintf(stderr, "%-10s %7zu %8zu %12zu %12zu %12zu %9zu %8zu %10zu %12zu\n", entry->name, entry->num_arenas,
+                total.num_regions, total.bytes_reserved, total.bytes_requested, total.bytes_committed, total.num_allocations,
+                total.num_commits, total.alignment_waste, total.high_water);
+    }
+    fprintf(stderr, "=============================================================================================\n");
+    pthread_mutex_unlock(&arena_registry_lock);
 }
 
 void destroy_arena(Arena* arena) {
@@ -118,17 +348,18 @@ void destroy_arena(Arena* arena) {
         return;
     }
 
-    #ifdef _WIN32
-        if (!VirtualFree(arena->start, 0, MEM_RELEASE)) {
-            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
-                            "['%s'] : Failed to free reserved memory from the arena", __func__);
-        }
-    #else
-        if (munmap(arena->start, (char*)arena->reserved_end - (char*)arena->start) == -1) {
+    if (arena->name) {
+        retire_arena(arena);
+    }
+
+    while (arena->region) {
+        ArenaRegion* prev = arena->region->prev;
+        if (!release_region(arena->region)) {
             log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
                             "['%s'] : Failed to unmap memory arena", __func__);
         }
-    #endif
+        arena->region = prev;
+    }
     free(arena);
 }
 
@@ -174,4 +405,18 @@ char* arena_strdup(Arena* arena, const char* src) {
 
     strcpy(buffer, src);
     return buffer;
-}
\ No newline at end of file
+}
+
+/**
+ * Copy `len` bytes of `src`, which need not be NUL terminated, as a NUL terminated string.
+ */
+char* arena_strndup(Arena* arena, const char* src, size_t len) {
+    char* buffer = (char*)arena_alloc(arena, len + 1);
+    if (!buffer) {
+        return NULL;
+    }
+
+    memcpy(buffer, src, len);
+    buffer[len] = '\0';
+    return buffer;
+}
@@ -0,0 +1,190 @@
+#include "intern.h"
+#include "arena.h"
+#include "logger.h"
+#include "safer.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+/**
+ * The strings of all atoms are kept in chunks of a fixed size, indexed by the atom. A chunk never moves once
+ * it is published, so `atom_str` reads it without taking a lock.
+ */
+#define ATOM_CHUNK_BITS 12
+#define ATOM_CHUNK_SIZE ((size_t) 1 << ATOM_CHUNK_BITS)
+#define MAX_ATOM_CHUNKS 4096
+
+/**
+ * The map from a string to its atom is split into shards by the top bits of the hash, each an open addressing
+ * table behind its own lock, so threads interning different names rarely wait on each other.
+ */
+#define NUM_SHARDS 16
+#define SHARD_BITS 4
+#define INITIAL_SHARD_CAPACITY 256
+#define INTERN_ARENA_PAGES 16
+
+#define FNV32_OFFSET_BASIS 0x811c9dc5u
+#define FNV32_PRIME 0x01000193u
+
+typedef struct {
+    uint32_t hash;
+    uint32_t length;
+    Atom atom;      // ATOM_NONE if the slot is free
+} InternSlot;
+
+typedef struct {
+    pthread_mutex_t lock;
+    InternSlot* slots;
+    size_t capacity;    // a power of 2
+    size_t count;
+    Arena* strings;
+} InternShard;
+
+static _Atomic(const char**) atom_chunks[MAX_ATOM_CHUNKS];
+static atomic_uint next_atom = ATOM_NONE + 1;
+static pthread_mutex_t chunk_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static InternShard shards[NUM_SHARDS];
+static pthread_once_t intern_once = PTHREAD_ONCE_INIT;
+
+static uint32_t hash_name(const char* str, size_t len) {
+    uint32_t hash = FNV32_OFFSET_BASIS;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (unsigned char) str[i];
+        hash *= FNV32_PRIME;
+    }
+    return hash;
+}
+
+static const char** atom_chunk(Atom atom) {
+    size_t index = atom >> ATOM_CHUNK_BITS;
+    const char** chunk = atomic_load_explicit(&atom_chunks[index], memory_order_acquire);
+    if (chunk != NULL) {
+        return chunk;
+    }
+
+    pthread_mutex_lock(&chunk_lock);
+    chunk = atomic_load_explicit(&atom_chunks[index], memory_order_relaxed);
+    if (chunk == NULL) {
+        chunk = safer_malloc(sizeof(const char*) * ATOM_CHUNK_SIZE);
+        atomic_store_explicit(&atom_chunks[index], chunk, memory_order_release);
+    }
+    pthread_mutex_unlock(&chunk_lock);
+    return chunk;
+}
+
+static bool grow_shard(InternShard* shard) {
+    size_t capacity = shard->capacity * 2;
+    InternSlot* slots = calloc(capacity, sizeof(InternSlot));
+    if (slots == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < shard->capacity; ++i) {
+        InternSlot slot = shard->slots[i];
+        if (slot.atom == ATOM_NONE) {
+            continue;
+        }
+        size_t index = slot.hash & (capacity - 1);
+        while (slots[index].atom != ATOM_NONE) {
+            index = (index + 1) & (capacity - 1);
+        }
+        slots[index] = slot;
+    }
+
+    free(shard->slots);
+    shard->slots = slots;
+    shard->capacity = capacity;
+    return true;
+}
+
+static Atom intern_hashed(const char* str, size_t len, uint32_t hash) {
+    InternShard* shard = &shards[hash >> (32 - SHARD_BITS)];
+    pthread_mutex_lock(&shard->lock);
+
+    size_t mask = shard->capacity - 1;
+    size_t index = hash & mask;
+    for (InternSlot* slot = &shard->slots[index]; slot->atom != ATOM_NONE; slot = &shard->slots[index]) {
+        if (slot->hash == hash && slot->length == len) {
+            const char* existing = atom_chunk(slot->atom)[slot->atom & (ATOM_CHUNK_SIZE - 1)];
+            if (memcmp(existing, str, len) == 0) {
+                pthread_mutex_unlock(&shard->lock);
+                return slot->atom;
+            }
+        }
+        index = (index + 1) & mask;
+    }
+
+    Atom atom = atomic_fetch_add(&next_atom, 1);
+    if ((atom >> ATOM_CHUNK_BITS) >= MAX_ATOM_CHUNKS) {
+        pthread_mutex_unlock(&shard->lock);
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                            "['%s'] : Too many distinct names", __func__);
+        return ATOM_NONE;
+    }
+
+    atom_chunk(atom)[atom & (ATOM_CHUNK_SIZE - 1)] = arena_strndup(shard->strings, str, len);
+    shard->slots[index] = (InternSlot) {hash, (uint32_t) len, atom};
+    shard->count++;
+
+    // Keep the load factor at most 1/2
+    if (shard->count * 2 > shard->capacity && !grow_shard(shard)) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                            "['%s'] : Failed to grow the intern table", __func__);
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+    return atom;
+}
+
+static void init_intern_table() {
+    for (int i = 0; i < NUM_SHARDS; ++i) {
+        pthread_mutex_init(&shards[i].lock, NULL);
+        shards[i].slots = calloc(INITIAL_SHARD_CAPACITY, sizeof(InternSlot));
+        shards[i].capacity = INITIAL_SHARD_CAPACITY;
+        shards[i].count = 0;
+        shards[i].strings = init_arena(INTERN_ARENA_PAGES);
+        arena_register(shards[i].strings, "intern");
+        if (shards[i].slots == NULL || shards[i].strings == NULL) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                                "['%s'] : Failed to allocate the intern table", __func__);
+        }
+    }
+
+    // Interned in the order of atoms.def, so they get the ids of their enum constants
+#define ATOM(name, str_repr) intern_hashed(str_repr, sizeof(str_repr) - 1, hash_name(str_repr, sizeof(str_repr) - 1));
+    #include PATH_TO_ATOM_DEF_FILE
+#undef ATOM
+}
+
+/**
+ * @brief The atom of the `len` bytes at `str`, which need not be NUL terminated. The bytes are copied the
+ * first time the name is seen.
+ */
+Atom intern(const char* str, size_t len) {
+    pthread_once(&intern_once, init_intern_table);
+    return intern_hashed(str, len, hash_name(str, len));
+}
+
+Atom intern_str(const char* str) {
+    if (str == NULL) {
+        return ATOM_NONE;
+    }
+    return intern(str, strlen(str));
+}
+
+/**
+ * @brief The name `atom` stands for, NUL terminated. NULL for ATOM_NONE.
+ */
+const char* atom_str(Atom atom) {
+    if (atom == ATOM_NONE) {
+        return NULL;
+    }
+    const char** chunk = atomic_load_explicit(&atom_chunks[atom >> ATOM_CHUNK_BITS], memory_order_acquire);
+    return chunk[atom & (ATOM_CHUNK_SIZE - 1)];
+}
+
+size_t interned_count() {
+    return atomic_load(&next_atom) - 1;
+}
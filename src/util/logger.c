@@ -1,6 +1,8 @@
 #include "logger.h"
+#include "source_buffer.h"
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 
 
 
@@ -13,9 +15,16 @@ LogLevel current_log_level = LOG_LEVEL_INFO;
 Arena* loggerArena = NULL;
 static FILE *log_file = NULL;
 
+// Workers in the front end and code generator report concurrently; both the log file
+// and the (arena backed) error vector must only be touched by one thread at a time.
+static pthread_mutex_t log_file_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t error_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool exiting = false;
+
 void initialize_logger_arena() {
     if (!loggerArena) {
         loggerArena = init_arena(4);
+        arena_register(loggerArena, "logger");
         init_error_vec();
     }
 }
@@ -38,11 +47,13 @@ void log_message(LogLevel level, ErrorCode code, const char *format, ...)
         return;
     }
 
+    pthread_mutex_lock(&log_file_lock);
     if (log_file == NULL)
     {
         log_file = fopen(LOG_FILE, "a");
         if (log_file == NULL)
         {
+            pthread_mutex_unlock(&log_file_lock);
             perror("Failed to open log file");
             return;
         }
@@ -62,10 +73,13 @@ void log_message(LogLevel level, ErrorCode code, const char *format, ...)
     vfprintf(log_file, format, args);
     va_end(args);
     fflush(log_file);
+    pthread_mutex_unlock(&log_file_lock);
 }
 
-void log_error_internal(ErrorPhase phase, ErrorCode code, const char* filepath, int line, size_t byte_offset, char* format, ...) {
+void log_error_internal(ErrorPhase phase, ErrorCode code, const SourceBuffer* source, const char* filepath, int line,
+                        size_t byte_offset, char* format, ...) {
 
+    pthread_mutex_lock(&error_lock);
     char* message = arena_alloc(loggerArena, 256 * sizeof (char));
     va_list args;
     va_start(args, format);
@@ -82,13 +96,17 @@ void log_error_internal(ErrorPhase phase, ErrorCode code, const char* filepath,
 
     error->code = code;
     error->phase = phase;
-    error->file = filepath;
+    // The lexer frees its file name before the errors are printed
+    error->file = arena_strdup(loggerArena, filepath);
     error->line = line;
-    error->name = get_filename_from_path(filepath);
+    error->name = get_filename_from_path(error->file);
     error->msg = message;
 
     if(error->severity == ERROR_SEV_WARN) {
-        error->offending_code = get_line_from_file(filepath, byte_offset + 1, loggerArena);
+        // Once the lexer is gone, or if it only kept the lexemes, the line is read from the file again
+        error->offending_code = source && !source->lexemes_only
+                                    ? get_line_from_source(source, byte_offset + 1, loggerArena)
+                                    : get_line_from_file(filepath, byte_offset + 1, loggerArena);
         error->suggestion = error_code_to_suggestion(code);
     }
 
@@ -97,47 +115,70 @@ void log_error_internal(ErrorPhase phase, ErrorCode code, const char* filepath,
 
     push_error(error);
 
-    if(error->severity == ERROR_SEV_ERROR) {
+    // Only the first fatal error prints the report and exits, exit must not run twice
+    bool fatal = error->severity == ERROR_SEV_ERROR && !exiting;
+    if (fatal) {
+        exiting = true;
         print_all_errors();
         print_error_summary();
+    }
+    pthread_mutex_unlock(&error_lock);
+
+    // Not under the lock : a thread reporting at the same time, or an atexit handler, must not wait on it forever
+    if (fatal) {
         exit(EXIT_FAILURE);
     }
+}
 
+/**
+ * Errors come in bursts for the same file, the last file a diagnostic quoted stays mapped.
+ * Only touched with `error_lock` held.
+ */
+static SourceBuffer* diagnostic_source = NULL;
+static char* diagnostic_path = NULL;
+
+void release_diagnostic_source() {
+    close_source_buffer(diagnostic_source);
+    free(diagnostic_path);
+    diagnostic_source = NULL;
+    diagnostic_path = NULL;
 }
 
 char* get_line_from_file(const char* filepath, size_t byte_offset, Arena* arena) {
-    FILE* file = fopen(filepath, "r");
-    if (!file) {
-        return NULL;
+    if (!diagnostic_path || strcmp(diagnostic_path, filepath) != 0) {
+        release_diagnostic_source();
+        diagnostic_source = open_source_buffer(filepath);
+        if (!diagnostic_source) {
+            return NULL;
+        }
+        diagnostic_path = strdup(filepath);
     }
+    return get_line_from_source(diagnostic_source, byte_offset, arena);
+}
 
-    fseek(file, byte_offset, SEEK_SET);
-
-    char buffer[256];
-    int index = 0;
-    char c;
-
-    bool leading_spaces = true;
+/**
+ * @brief The line of `source` from `byte_offset` on, without its leading and trailing blanks, copied to `arena`.
+ */
+char* get_line_from_source(const SourceBuffer* source, size_t byte_offset, Arena* arena) {
+    const char* c = source->data + (byte_offset < source->length ? byte_offset : source->length);
+    // Skip leading spaces/tabs
+    while (*c == ' ' || *c == '\t') {
+        c++;
+    }
 
-    while ((c = fgetc(file)) != '\n' && c != EOF && index < 255) {
-        if (leading_spaces && (c == ' ' || c == '\t')) {
-            continue;  // Skip leading spaces/tabs
-        } else {
-            leading_spaces = false;
-            buffer[index++] = c;
-        }
+    size_t index = 0;
+    while (c[index] != '\n' && c[index] != '\0' && index < 255) {
+        index++;
     }
 
     // Strip trailing spaces/tabs/carriage returns
-    while (index > 0 && (buffer[index - 1] == ' ' || buffer[index - 1] == '\t' || buffer[index - 1] == '\r')) {
+    while (index > 0 && (c[index - 1] == ' ' || c[index - 1] == '\t' || c[index - 1] == '\r')) {
         index--;
     }
-    buffer[index] = '\0';
-
-    fclose(file);
 
     char* line = (char*) arena_alloc(arena, index + 1);
-    strcpy(line, buffer);
+    memcpy(line, c, index);
+    line[index] = '\0';
 
     return line;
 }
@@ -154,12 +195,15 @@ const char* get_filename_from_path(const char* filepath) {
 
 void close_log_file()
 {
+    pthread_mutex_lock(&log_file_lock);
     if (log_file != NULL)
     {
         fclose(log_file);
         log_file = NULL;
     }
+    pthread_mutex_unlock(&log_file_lock);
 
+    release_diagnostic_source();
     destroy_error_vector();
     destroy_logger_arena();
 }
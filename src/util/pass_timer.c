@@ -0,0 +1,181 @@
+#include "pass_timer.h"
+#include "safer.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+bool pass_timer_enabled = false;
+
+typedef struct {
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+} PassTime;
+
+static const char* pass_names[PASS_COUNT] = {
+#define PASS(name, str_repr) [name] = str_repr,
+    #include PATH_TO_PASS_DEF_FILE
+#undef PASS
+};
+
+// Times of passes that belong to no file, they survive `pass_timer_reset`
+static PassTime program_times[PASS_COUNT];
+// PASS_COUNT entries per file, every (file, pass) slot is only written by the thread running that pass
+static PassTime* file_times = NULL;
+static size_t num_files = 0;
+
+static _Thread_local size_t current_file = PASS_TIMER_NO_FILE;
+
+static uint64_t compile_start_wall;
+static uint64_t compile_start_cpu;
+
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+void init_pass_timer() {
+    pass_timer_enabled = true;
+    memset(program_times, 0, sizeof(program_times));
+}
+
+/**
+ * @brief Start timing a new compilation of `num_files` files, dropping the per-file times of the previous one.
+ */
+void pass_timer_reset(size_t files) {
+    if (!pass_timer_enabled) {
+        return;
+    }
+
+    free(file_times);
+    num_files = files;
+    file_times = safer_malloc(sizeof(PassTime) * PASS_COUNT * (files ? files : 1));
+    memset(file_times, 0, sizeof(PassTime) * PASS_COUNT * (files ? files : 1));
+
+    compile_start_wall = clock_ns(CLOCK_MONOTONIC);
+    compile_start_cpu = clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+/**
+ * @brief Attribute the passes run by the calling thread to file `file_index` of the compilation.
+ */
+void pass_timer_set_file(size_t file_index) {
+    current_file = file_index;
+}
+
+size_t pass_timer_current_file() {
+    return current_file;
+}
+
+PassSample pass_timer_start() {
+    PassSample sample = {0, 0};
+    if (pass_timer_enabled) {
+        sample.wall_ns = clock_ns(CLOCK_MONOTONIC);
+        sample.cpu_ns = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    }
+    return sample;
+}
+
+void pass_timer_stop(Pass pass, PassSample start) {
+    if (!pass_timer_enabled) {
+        return;
+    }
+
+    PassTime* slot = current_file < num_files ? &file_times[current_file * PASS_COUNT + pass] : &program_times[pass];
+    slot->wall_ns += clock_ns(CLOCK_MONOTONIC) - start.wall_ns;
+    slot->cpu_ns += clock_ns(CLOCK_THREAD_CPUTIME_ID) - start.cpu_ns;
+}
+
+static double to_ms(uint64_t ns) {
+    return (double) ns / 1e6;
+}
+
+static void print_json_string(FILE* out, const char* str) {
+    fputc('"', out);
+    for (const char* c = str; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        } else if ((unsigned char) *c < ' ') {
+            fprintf(out, "\\u%04x", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void print_json_passes(FILE* out, const PassTime* times) {
+    fprintf(out, "{");
+    for (int pass = 0; pass < PASS_COUNT; ++pass) {
+        fprintf(out, "%s\"%s\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f}", pass ? ", " : "", pass_names[pass],
+                to_ms(times[pass].wall_ns), to_ms(times[pass].cpu_ns));
+    }
+    fprintf(out, "}");
+}
+
+static void print_text_passes(FILE* out, const PassTime* times) {
+    for (int pass = 0; pass < PASS_COUNT; ++pass) {
+        if (times[pass].wall_ns || times[pass].cpu_ns) {
+            fprintf(out, "  %-10s %12.3f %12.3f\n", pass_names[pass], to_ms(times[pass].wall_ns), to_ms(times[pass].cpu_ns));
+        }
+    }
+}
+
+/**
+ * @brief Report the times of the current compilation. The text report goes to stderr next to the error summary,
+ * the JSON report goes to stdout so it can be piped into other tools.
+ *
+ * @param files - paths of the compiled files, indexed like `pass_timer_set_file`
+ */
+void print_pass_times(vector files, TimePassesFormat format) {
+    if (!pass_timer_enabled || format == TIME_PASSES_NONE) {
+        return;
+    }
+
+    uint64_t wall_ns = clock_ns(CLOCK_MONOTONIC) - compile_start_wall;
+    uint64_t cpu_ns = clock_ns(CLOCK_PROCESS_CPUTIME_ID) - compile_start_cpu;
+
+    PassTime totals[PASS_COUNT];
+    memcpy(totals, program_times, sizeof(totals));
+    for (size_t file = 0; file < num_files; ++file) {
+        for (int pass = 0; pass < PASS_COUNT; ++pass) {
+            totals[pass].wall_ns += file_times[file * PASS_COUNT + pass].wall_ns;
+            totals[pass].cpu_ns += file_times[file * PASS_COUNT + pass].cpu_ns;
+        }
+    }
+
+    if (format == TIME_PASSES_JSON) {
+        FILE* out = stdout;
+        fprintf(out, "{\"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"passes\": ", to_ms(wall_ns), to_ms(cpu_ns));
+        print_json_passes(out, totals);
+        fprintf(out, ", \"files\": [");
+        for (size_t file = 0; file < num_files; ++file) {
+            fprintf(out, "%s{\"file\": ", file ? ", " : "");
+            print_json_string(out, vector_get(files, (int) file));
+            fprintf(out, ", \"passes\": ");
+            print_json_passes(out, &file_times[file * PASS_COUNT]);
+            fprintf(out, "}");
+        }
+        fprintf(out, "]}\n");
+        fflush(out);
+        return;
+    }
+
+    FILE* out = stderr;
+    fprintf(out, "=========== Pass Timings ===========\n");
+    fprintf(out, "Total: %.3f ms wall, %.3f ms CPU\n", to_ms(wall_ns), to_ms(cpu_ns));
+    fprintf(out, "  %-10s %12s %12s\n", "pass", "wall (ms)", "cpu (ms)");
+    print_text_passes(out, totals);
+    for (size_t file = 0; file < num_files; ++file) {
+        fprintf(out, "%s\n", get_filename_from_path(vector_get(files, (int) file)));
+        print_text_passes(out, &file_times[file * PASS_COUNT]);
+    }
+    fprintf(out, "====================================\n");
+}
+
+void destroy_pass_timer() {
+    free(file_times);
+    file_times = NULL;
+    num_files = 0;
+    pass_timer_enabled = false;
+}
@@ -1,5 +1,19 @@
 #include "ringbuffer.h"
 #include "logger.h"
+#include <sched.h>
+
+#define RINGBUFFER_MASK (RINGBUFFER_SIZE - 1)
+#define RINGBUFFER_SPINS 64
+
+/**
+ * Back off while the other side catches up. Neither side ever takes a lock, a waiting
+ * thread spins for a short while and then gives its time slice away.
+ */
+static void ringbuffer_wait(unsigned* spins) {
+    if (++(*spins) > RINGBUFFER_SPINS) {
+        sched_yield();
+    }
+}
 
 RingBuffer* init_ringbuffer() {
     RingBuffer* buffer = malloc(sizeof(RingBuffer));
@@ -8,53 +22,113 @@ RingBuffer* init_ringbuffer() {
                             "['%s'] :  Could not allocate memory for the ringbuffer", __func__);
         return NULL;
     }
-    buffer->write_idx = 0;
-    buffer->read_idx = 0;
+    atomic_init(&buffer->write_idx, 0);
+    atomic_init(&buffer->read_idx, 0);
+    atomic_init(&buffer->release_idx, 0);
+    atomic_init(&buffer->closed, false);
+    atomic_init(&buffer->cancelled, false);
     return buffer;
 }
 
-bool ringbuffer_push(RingBuffer* rb, Token* value) {
-    size_t next_write_idx = rb->write_idx + 1;
-    if (next_write_idx >= RINGBUFFER_SIZE) {
-        next_write_idx = 0;
+/**
+ * @brief Producer side. Copies the token into the ring, waiting while the ring is full.
+ *
+ * @return false if the consumer cancelled the ring, the token was not stored
+ */
+bool ringbuffer_push(RingBuffer* rb, const Token* value) {
+    size_t write_idx = atomic_load_explicit(&rb->write_idx, memory_order_relaxed);
+    unsigned spins = 0;
+
+    while (write_idx - atomic_load_explicit(&rb->release_idx, memory_order_acquire) >= RINGBUFFER_SIZE) {
+        if (atomic_load_explicit(&rb->cancelled, memory_order_relaxed)) {
+            return false;
+        }
+        ringbuffer_wait(&spins);
     }
-    if (next_write_idx == rb->read_idx) {
-        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_BUFFER_FULL, __FILE__, __LINE__,
-                            "['%s'] : Ringbuffer full, cannot push", __func__);
+    if (atomic_load_explicit(&rb->cancelled, memory_order_relaxed)) {
         return false;
     }
 
-    rb->data[rb->write_idx] = value;
-    rb->write_idx = next_write_idx;
+    rb->data[write_idx & RINGBUFFER_MASK] = *value;
+    atomic_store_explicit(&rb->write_idx, write_idx + 1, memory_order_release);
     return true;
 }
 
+/**
+ * Wait until the token at `idx` is published. Returns false if the producer closed the ring before.
+ */
+static bool ringbuffer_wait_for(RingBuffer* rb, size_t idx) {
+    unsigned spins = 0;
+    while (atomic_load_explicit(&rb->write_idx, memory_order_acquire) <= idx) {
+        if (atomic_load_explicit(&rb->closed, memory_order_acquire)) {
+            // Everything pushed before the close is visible now
+            return atomic_load_explicit(&rb->write_idx, memory_order_acquire) > idx;
+        }
+        ringbuffer_wait(&spins);
+    }
+    return true;
+}
 
+/**
+ * @brief Consumer side. Hands out a pointer to the next token, which stays valid until the next
+ * successful pop. Popping releases the previously popped token back to the producer.
+ *
+ * @return false once the producer closed the ring and every token was consumed
+ */
 bool ringbuffer_pop(RingBuffer* rb, Token** value) {
-    if (rb->read_idx == rb->write_idx) {
-        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_BUFFER_EMPTY, __FILE__, __LINE__,
-                            "['%s'] : Ringbuffer empty, cannot pop", __func__);
+    size_t read_idx = atomic_load_explicit(&rb->read_idx, memory_order_relaxed);
+    size_t release_idx = atomic_load_explicit(&rb->release_idx, memory_order_relaxed);
+
+    // The held token keeps its slot, so the producer can still fill all the others meanwhile
+    if (!ringbuffer_wait_for(rb, read_idx)) {
         return false;
     }
 
-    *value = rb->data[rb->read_idx];
-    size_t next_read_idx = rb->read_idx + 1;
-    if (next_read_idx >= RINGBUFFER_SIZE) {
-        next_read_idx = 0;
+    if (release_idx < read_idx) {
+        atomic_store_explicit(&rb->release_idx, read_idx, memory_order_release);
     }
-    rb->read_idx = next_read_idx;
+
+    *value = &rb->data[read_idx & RINGBUFFER_MASK];
+    atomic_store_explicit(&rb->read_idx, read_idx + 1, memory_order_relaxed);
     return true;
 }
 
-Token* ringbuffer_peek(const RingBuffer* rb) {
-    if (rb_is_empty(rb)) {
-        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_BUFFER_EMPTY, __FILE__, __LINE__,
-                            "['%s'] : Ringbuffer empty, cannot peek", __func__);
+/**
+ * @brief Consumer side. Look `offset` tokens past the next one without consuming anything.
+ *
+ * @return the token, or NULL if the producer closed the ring before publishing it
+ */
+Token* ringbuffer_peek(RingBuffer* rb, size_t offset) {
+    if (offset >= RINGBUFFER_SIZE - 1) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_BUFFER_FULL, __FILE__, __LINE__,
+                            "['%s'] : Peek offset %zu exceeds the ringbuffer window", __func__, offset);
+        return NULL;
+    }
+
+    size_t idx = atomic_load_explicit(&rb->read_idx, memory_order_relaxed) + offset;
+    if (!ringbuffer_wait_for(rb, idx)) {
         return NULL;
     }
-    return rb->data[rb->read_idx];
+    return &rb->data[idx & RINGBUFFER_MASK];
+}
+
+/**
+ * Producer side. Signal that no more tokens will be pushed.
+ */
+void ringbuffer_close(RingBuffer* rb) {
+    atomic_store_explicit(&rb->closed, true, memory_order_release);
 }
 
+/**
+ * Consumer side. Signal that no more tokens will be popped, so a producer waiting on a full ring returns.
+ */
+void ringbuffer_cancel(RingBuffer* rb) {
+    atomic_store_explicit(&rb->cancelled, true, memory_order_relaxed);
+}
+
+/**
+ * Must only be called once the producer has stopped.
+ */
 void ringbuffer_destroy(RingBuffer* rb) {
     if (rb == NULL) {
        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
@@ -62,16 +136,10 @@ void ringbuffer_destroy(RingBuffer* rb) {
         return;
     }
 
-    // Free all tokens in the buffer
-    while (rb->read_idx != rb->write_idx) {
-        Token* token;
-        ringbuffer_pop(rb, &token);
-        destroy_token(token);
-    }
-
     free(rb);
 }
 
 bool rb_is_empty(const RingBuffer* rb) {
-    return rb->read_idx == rb->write_idx;
-}
\ No newline at end of file
+    return atomic_load_explicit(&rb->read_idx, memory_order_relaxed) ==
+           atomic_load_explicit(&rb->write_idx, memory_order_acquire);
+}
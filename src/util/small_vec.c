@@ -0,0 +1,47 @@
+#include "small_vec.h"
+#include "logger.h"
+
+void init_small_vec(SmallVec* vec, size_t elem_size, Arena* arena) {
+    vec->data = vec->inline_data;
+    vec->size = 0;
+    vec->elem_size = (uint32_t) elem_size;
+    vec->capacity = (uint32_t) (SMALL_VEC_INLINE_BYTES / elem_size);
+    vec->arena = arena;
+}
+
+/**
+ * @brief Make room for `capacity` elements, doubling the capacity until it fits. The elements are copied
+ * to a new buffer from the arena, the old one is left behind.
+ */
+bool small_vec_reserve(SmallVec* vec, uint32_t capacity) {
+    if (capacity <= vec->capacity) {
+        return true;
+    }
+    uint32_t new_capacity = vec->capacity ? vec->capacity : 1;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+
+    void* data = arena_alloc(vec->arena, (size_t) new_capacity * vec->elem_size);
+    if (!data) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                            "['%s'] : Failed to grow the small vector to %u elements", __func__, new_capacity);
+        return false;
+    }
+    memcpy(data, vec->data, (size_t) vec->size * vec->elem_size);
+    vec->data = data;
+    vec->capacity = new_capacity;
+    return true;
+}
+
+/**
+ * @brief Copy `count` elements to the end of the vector.
+ */
+bool small_vec_append(SmallVec* vec, const void* elems, uint32_t count) {
+    if (!small_vec_reserve(vec, vec->size + count)) {
+        return false;
+    }
+    memcpy(small_vec_at(vec, vec->size), elems, (size_t) count * vec->elem_size);
+    vec->size += count;
+    return true;
+}
@@ -0,0 +1,285 @@
+#include "source_buffer.h"
+#include "safer.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#define INITIAL_LINES 64
+
+static SourceBuffer* init_source_buffer(const char* data, size_t length, size_t map_length) {
+    SourceBuffer* buffer = safer_malloc(sizeof(SourceBuffer));
+    buffer->data = data;
+    buffer->length = length;
+    buffer->map_length = map_length;
+    buffer->line_starts = NULL;
+    buffer->num_lines = 0;
+    buffer->lines_capacity = 0;
+    buffer->lexemes_only = false;
+    return buffer;
+}
+
+#ifdef _WIN32
+
+static SourceBuffer* read_source_buffer(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (length < 0 || (unsigned long) length >= UINT32_MAX) {
+        fclose(file);
+        return NULL;
+    }
+
+    char* data = safer_malloc((size_t) length + 1);
+    size_t bytes_read = fread(data, 1, (size_t) length, file);
+    fclose(file);
+    data[bytes_read] = '\0';
+    return init_source_buffer(data, bytes_read, 0);
+}
+
+#else
+
+/**
+ * The file is mapped over a zeroed anonymous reservation one byte longer than the file. The tail of the
+ * last file page past EOF reads as zeros, and when the file ends on a page boundary the sentinel lands
+ * in the reserved page after it.
+ */
+static SourceBuffer* map_source_buffer(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t) st.st_size >= UINT32_MAX) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t length = (size_t) st.st_size;
+    size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+    size_t map_length = (length + 1 + page_size - 1) / page_size * page_size;
+
+    char* data = mmap(NULL, map_length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    if (length > 0 && mmap(data, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(data, map_length);
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+
+    return init_source_buffer(data, length, map_length);
+}
+
+#endif
+
+/**
+ * @brief Open the file at `path` without copying it.
+ * @return NULL if the file cannot be opened, the caller reports it
+ */
+SourceBuffer* open_source_buffer(const char* path) {
+#ifdef _WIN32
+    return read_source_buffer(path);
+#else
+    return map_source_buffer(path);
+#endif
+}
+
+/**
+ * @brief Wrap a heap allocated, NUL terminated string. The buffer takes ownership of `str`.
+ */
+SourceBuffer* source_buffer_from_string(char* str) {
+    if (str == NULL || strlen(str) >= UINT32_MAX) {
+        free(str);
+        return NULL;
+    }
+    return init_source_buffer(str, strlen(str), 0);
+}
+
+void close_source_buffer(SourceBuffer* buffer) {
+    if (buffer == NULL) {
+        return;
+    }
+    free(buffer->line_starts);
+#ifndef _WIN32
+    if (buffer->map_length > 0) {
+        munmap((void*) buffer->data, buffer->map_length);
+        free(buffer);
+        return;
+    }
+#endif
+    free((char*) buffer->data);
+    free(buffer);
+}
+
+static bool add_line_start(SourceBuffer* buffer, uint32_t start) {
+    if (buffer->num_lines == buffer->lines_capacity) {
+        uint32_t capacity = buffer->lines_capacity ? buffer->lines_capacity * 2 : INITIAL_LINES;
+        uint32_t* starts = realloc(buffer->line_starts, sizeof(uint32_t) * capacity);
+        if (starts == NULL) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                                "['%s'] : Failed to grow the line index", __func__);
+            return false;
+        }
+        buffer->line_starts = starts;
+        buffer->lines_capacity = capacity;
+    }
+    buffer->line_starts[buffer->num_lines++] = start;
+    return true;
+}
+
+/**
+ * Add the lines starting after the newlines of `length` bytes at `data`, which are at offset `base` of the file.
+ * The newlines are found with memchr, which libc vectorises.
+ */
+static void index_lines(SourceBuffer* buffer, const char* data, size_t length, size_t base) {
+    const char* end = data + length;
+    for (const char* nl = memchr(data, '\n', length); nl != NULL; nl = memchr(nl + 1, '\n', (size_t) (end - nl - 1))) {
+        if (!add_line_start(buffer, (uint32_t) (base + (size_t) (nl - data) + 1))) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Record where every line of the buffer starts, in one array.
+ */
+void index_source_lines(SourceBuffer* buffer) {
+    if (buffer->line_starts != NULL) {
+        return;
+    }
+    if (add_line_start(buffer, 0)) {
+        index_lines(buffer, buffer->data, buffer->length, 0);
+    }
+}
+
+/**
+ * @brief Offset of the '\n' ending the line before `line` (0 based), (size_t) -1 for the first line.
+ * This is the `byte_offset` diagnostics quote a line from.
+ */
+size_t source_line_offset(const SourceBuffer* buffer, int line) {
+    if (line <= 0 || buffer->line_starts == NULL) {
+        return (size_t) -1;
+    }
+    uint32_t index = (uint32_t) line < buffer->num_lines ? (uint32_t) line : buffer->num_lines - 1;
+    return (size_t) buffer->line_starts[index] - 1;
+}
+
+/**
+ * @brief The (0 based) line holding the byte at `offset`, by binary search of the line index.
+ */
+int source_line_of(const SourceBuffer* buffer, size_t offset) {
+    uint32_t low = 0;
+    uint32_t high = buffer->num_lines;
+    // Invariant : line_starts[low] <= offset, and offset < line_starts[high] when high < num_lines
+    while (high - low > 1) {
+        uint32_t mid = low + (high - low) / 2;
+        if (buffer->line_starts[mid] <= offset) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return (int) low;
+}
+
+// The vector kernels load the whole aligned block holding the sentinel
+#define WINDOW_SLACK 32
+
+/**
+ * Read on until the window is full or the file ends, indexing the lines read.
+ */
+static void fill_source_window(SourceWindow* window) {
+    size_t wanted = window->capacity - window->end;
+    size_t bytes_read = fread(window->data + window->end, 1, wanted, window->file);
+    if (window->base + window->end + bytes_read >= UINT32_MAX) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_FILE_READ, __FILE__, __LINE__,
+                            "['%s'] : Source files are limited to 4 GiB", __func__);
+        bytes_read = 0;
+    }
+    index_lines(window->lines, window->data + window->end, bytes_read, window->base + window->end);
+
+    window->end += bytes_read;
+    window->data[window->end] = '\0';
+    if (bytes_read < wanted) {
+        if (ferror(window->file)) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_FILE_READ, __FILE__, __LINE__,
+                                "['%s'] : Failed to read the source", __func__);
+        }
+        window->at_eof = true;
+    }
+}
+
+/**
+ * @brief Open the file at `path` for reading through a window of `capacity` bytes, and read the first window.
+ * The line index of the file is built in `lines`, which must not be indexed yet.
+ * @return NULL if the file cannot be opened, the caller reports it
+ */
+SourceWindow* open_source_window(const char* path, size_t capacity, SourceBuffer* lines) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    SourceWindow* window = safer_malloc(sizeof(SourceWindow));
+    window->file = file;
+    window->data = safer_malloc(capacity + 1 + WINDOW_SLACK);
+    window->capacity = capacity;
+    window->end = 0;
+    window->base = 0;
+    window->at_eof = false;
+    window->lines = lines;
+
+    add_line_start(lines, 0);
+    fill_source_window(window);
+    return window;
+}
+
+/**
+ * @brief Drop the bytes before `keep`, move the rest to the front of the window and read on after them.
+ * When the bytes kept take up the whole window it doubles first, so a token never has to be split.
+ * @return how far the bytes kept moved, positions in the window are to be lowered by it
+ */
+size_t slide_source_window(SourceWindow* window, size_t keep) {
+    size_t kept = window->end - keep;
+    memmove(window->data, window->data + keep, kept);
+    window->base += keep;
+    window->end = kept;
+
+    if (kept == window->capacity) {
+        char* data = realloc(window->data, window->capacity * 2 + 1 + WINDOW_SLACK);
+        if (data == NULL) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_MEMORY_ALLOCATION, __FILE__, __LINE__,
+                                "['%s'] : Failed to grow the source window", __func__);
+            return keep;
+        }
+        window->data = data;
+        window->capacity *= 2;
+    }
+
+    fill_source_window(window);
+    return keep;
+}
+
+void close_source_window(SourceWindow* window) {
+    if (window == NULL) {
+        return;
+    }
+    fclose(window->file);
+    free(window->data);
+    free(window);
+}
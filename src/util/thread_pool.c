@@ -0,0 +1,183 @@
+#include "thread_pool.h"
+#include "logger.h"
+#include "safer.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+/**
+ * A fixed set of worker threads that are parked between jobs.
+ * The calling thread always takes part in a job, so a pool of size 1 spawns no threads
+ * and runs every task inline - this is the serial mode of the compiler.
+ */
+struct ThreadPool {
+    pthread_t* workers;
+    size_t num_workers;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+
+    // Current job, only valid while `active` is non-zero
+    ThreadTask task;
+    void* ctx;
+    size_t num_tasks;
+    atomic_size_t next_task;
+
+    unsigned long generation;
+    size_t active;
+    bool shutdown;
+};
+
+/**
+ * Claim and run tasks until the current job is exhausted.
+ */
+static void drain_tasks(ThreadPool* pool) {
+    size_t index;
+    while ((index = atomic_fetch_add(&pool->next_task, 1)) < pool->num_tasks) {
+        pool->task(pool->ctx, index);
+    }
+}
+
+static void* worker_main(void* arg) {
+    ThreadPool* pool = arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        drain_tasks(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * Number of online processors, used when the user does not ask for a specific `-j`.
+ */
+size_t default_thread_count() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t) n : 1;
+}
+
+/**
+ * @brief Create a pool running jobs on `num_threads` threads (including the caller).
+ *
+ * @param num_threads - 0 selects `default_thread_count()`
+ * @return ThreadPool*
+ */
+ThreadPool* init_thread_pool(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = default_thread_count();
+    }
+
+    ThreadPool* pool = safer_malloc(sizeof(ThreadPool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->num_workers = 0;
+    pool->workers = safer_malloc(sizeof(pthread_t) * num_threads);
+    pool->task = NULL;
+    pool->ctx = NULL;
+    pool->num_tasks = 0;
+    atomic_init(&pool->next_task, 0);
+    pool->generation = 0;
+    pool->active = 0;
+    pool->shutdown = false;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    for (size_t i = 0; i + 1 < num_threads; ++i) {
+        if (pthread_create(&pool->workers[i], NULL, worker_main, pool) != 0) {
+            log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_THREAD_CREATE, __FILE__, __LINE__,
+                                "['%s'] : Failed to create worker thread %zu", __func__, i);
+            break;
+        }
+        pool->num_workers++;
+    }
+
+    return pool;
+}
+
+/**
+ * @brief Run `task(ctx, i)` for every i in [0, num_tasks) and wait for all of them to finish.
+ * Tasks are claimed dynamically, so the order in which they *run* is unspecified - callers that
+ * need deterministic output must key their results by index.
+ */
+void thread_pool_run(ThreadPool* pool, size_t num_tasks, ThreadTask task, void* ctx) {
+    if (!pool || !task) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
+                            "['%s'] : Null pool or task provided", __func__);
+        return;
+    }
+
+    if (pool->num_workers == 0 || num_tasks <= 1) {
+        for (size_t i = 0; i < num_tasks; ++i) {
+            task(ctx, i);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->num_tasks = num_tasks;
+    atomic_store(&pool->next_task, 0);
+    pool->active = pool->num_workers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    drain_tasks(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pool->task = NULL;
+    pool->ctx = NULL;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+size_t thread_pool_size(const ThreadPool* pool) {
+    return pool ? pool->num_workers + 1 : 1;
+}
+
+void destroy_thread_pool(ThreadPool* pool) {
+    if (!pool) {
+        log_error_no_offset(ERROR_PHASE_INTERNAL, ERROR_NULL_POINTER, __FILE__, __LINE__,
+                            "['%s'] : Null pointer provided", __func__);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->num_workers; ++i) {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->work_done);
+    free(pool->workers);
+    free(pool);
+}
@@ -0,0 +1,79 @@
+#!/bin/sh
+# A request that fails, fatally or not, must leave the compile server up for the next one.
+#
+# usage: compile_server_test.sh <compiler> <work dir>
+set -u
+
+compiler=$1
+dir=$2
+socket=$dir/server.sock
+
+rm -rf "$dir"
+mkdir -p "$dir"
+
+# An illegal character is a fatal diagnostic, a missing ';' used to crash the parser
+cat > "$dir/Illegal.jack" <<'JACK'
+class Illegal {
+    function int f() {
+        return 1 $ 2;
+    }
+}
+JACK
+cat > "$dir/Semicolon.jack" <<'JACK'
+class Semicolon {
+    function int f() {
+        return 1
+    }
+}
+JACK
+cat > "$dir/Good.jack" <<'JACK'
+class Good {
+    function int f() {
+        return 1;
+    }
+}
+JACK
+
+fail() {
+    echo "FAIL: $1"
+    "$compiler" --connect "$socket" --stop > /dev/null 2>&1
+    exit 1
+}
+
+"$compiler" --server "$socket" &
+server=$!
+tries=0
+while [ ! -S "$socket" ]; do
+    tries=$((tries + 1))
+    [ $tries -le 50 ] || fail "the server did not start"
+    sleep 0.1
+done
+
+for bad in Illegal Semicolon; do
+    if "$compiler" --connect "$socket" "$dir/$bad.jack" > "$dir/$bad.out" 2>&1; then
+        fail "$bad.jack compiled"
+    fi
+    grep -q "^status failed$" "$dir/$bad.out" || fail "no status for $bad.jack"
+done
+
+"$compiler" --connect "$socket" "$dir/Good.jack" > "$dir/Good.out" 2>&1 || fail "Good.jack did not compile after the failed requests"
+grep -q "^function Good.f 0$" "$dir/Good.vm" || fail "Good.vm was not written"
+
+"$compiler" --connect "$socket" --stop > /dev/null 2>&1 || fail "the server did not stop"
+wait $server
+[ ! -e "$socket" ] || fail "the socket was left behind"
+
+# A server killed by a signal removes its socket too
+"$compiler" --server "$socket" &
+server=$!
+tries=0
+while [ ! -S "$socket" ]; do
+    tries=$((tries + 1))
+    [ $tries -le 50 ] || fail "the server did not restart"
+    sleep 0.1
+done
+kill -TERM $server
+wait $server
+[ ! -e "$socket" ] || fail "the socket was left behind by SIGTERM"
+
+echo "PASS"
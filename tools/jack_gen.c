@@ -0,0 +1,279 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/**
+ * Generates a synthetic Jack project for benchmarking the compiler on inputs far larger than the samples.
+ *
+ * usage: jack_gen [options] <output dir>
+ *   --classes N       classes besides Main (default 100)
+ *   --subroutines N   functions per class (default 20)
+ *   --locals N        local variables per function (default 8)
+ *   --depth N         nesting depth of expressions (default 3)
+ *   --strings N       string literals per function (default 2)
+ *   --calls N         calls into other classes per function (default 4)
+ *   --comments N      lines of doc comment before every function, and of // comment in its body (default 0)
+ *   --seed N          seed of the generator, the same options and seed give the same project (default 1)
+ *
+ * Every class `C<i>` has a static, a field, a constructor, a method and `--subroutines` functions
+ * `f<j>(int a, int b)`. Functions only call functions of lower numbered classes, so every call resolves.
+ * `Main.main` calls `f0` of every class.
+ */
+
+typedef struct {
+    int classes;
+    int subroutines;
+    int locals;
+    int depth;
+    int strings;
+    int calls;
+    int comments;
+    uint64_t seed;
+} Options;
+
+static uint64_t rng_state;
+
+static uint32_t next_random() {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t) ((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static int random_below(int n) {
+    return n > 0 ? (int) (next_random() % (uint32_t) n) : 0;
+}
+
+/**
+ * An int valued expression over the arguments and the locals declared so far.
+ */
+static void write_expression(FILE* out, int depth, int num_locals) {
+    if (depth <= 0) {
+        int leaf = random_below(3);
+        if (leaf == 0 || num_locals == 0) {
+            fprintf(out, "%d", random_below(1000));
+        } else if (leaf == 1) {
+            fprintf(out, "l%d", random_below(num_locals));
+        } else {
+            fprintf(out, "%c", random_below(2) ? 'a' : 'b');
+        }
+        return;
+    }
+
+    // `&` and `|` only take booleans in this compiler
+    static const char* operators[] = {"+", "-", "*", "/"};
+    int op = random_below(4);
+    fprintf(out, "(");
+    write_expression(out, depth - 1, num_locals);
+    fprintf(out, " %s ", operators[op]);
+    if (op == 3) {
+        // Never divide by zero when the program is run
+        fprintf(out, "%d", 1 + random_below(9));
+    } else {
+        write_expression(out, depth - 1, num_locals);
+    }
+    fprintf(out, ")");
+}
+
+// Comment lines take no random numbers, the code around them is the same whatever `--comments`
+static const char* comment_lines[] = {
+    "Computes a value from the arguments and the locals, every branch returns it unchanged",
+    "The expressions below only exist to give the parser and the code generator some work",
+    "Calls only go to functions of lower numbered classes, so every one of them resolves",
+    "Nothing here is meant to be read, it is as long as a comment in a real project",
+};
+#define NUM_COMMENT_LINES (sizeof(comment_lines) / sizeof(comment_lines[0]))
+
+static void write_function(FILE* out, const Options* opts, int class_index, int sub_index) {
+    if (opts->comments > 0) {
+        fprintf(out, "    /**\n");
+        for (int i = 0; i < opts->comments; ++i) {
+            fprintf(out, "     * %s\n", comment_lines[(sub_index + i) % NUM_COMMENT_LINES]);
+        }
+        fprintf(out, "     */\n");
+    }
+    fprintf(out, "    function int f%d(int a, int b) {\n", sub_index);
+    fprintf(out, "        var int ");
+    for (int i = 0; i < opts->locals; ++i) {
+        fprintf(out, "%sl%d", i ? ", " : "", i);
+    }
+    fprintf(out, ";\n");
+    fprintf(out, "        var C%d obj;\n", class_index);
+
+    for (int i = 0; i < opts->locals; ++i) {
+        fprintf(out, "        let l%d = ", i);
+        write_expression(out, opts->depth, i);
+        fprintf(out, ";\n");
+    }
+
+    for (int i = 0; i < opts->strings; ++i) {
+        fprintf(out, "        do Output.printString(\"C%d.f%d string %d\");\n", class_index, sub_index, i);
+    }
+
+    for (int i = 0; i < opts->calls && class_index > 0; ++i) {
+        int callee = random_below(class_index);
+        fprintf(out, "        let l%d = C%d.f%d(", random_below(opts->locals), callee, random_below(opts->subroutines));
+        write_expression(out, opts->depth > 0 ? opts->depth - 1 : 0, opts->locals);
+        fprintf(out, ", ");
+        write_expression(out, 0, opts->locals);
+        fprintf(out, ");\n");
+    }
+
+    for (int i = 0; i < opts->comments; ++i) {
+        fprintf(out, "        // %s\n", comment_lines[(sub_index + i) % NUM_COMMENT_LINES]);
+    }
+    fprintf(out, "        let obj = C%d.new(a);\n", class_index);
+    fprintf(out, "        if ((a > b) & (l0 < 100)) {\n");
+    fprintf(out, "            let s = s + obj.get();\n");
+    fprintf(out, "        } else {\n");
+    fprintf(out, "            let s = s - 1;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        while (l0 > 0) {\n");
+    fprintf(out, "            let l0 = l0 / 2;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        do obj.dispose();\n");
+    fprintf(out, "        return l0;\n");
+    fprintf(out, "    }\n\n");
+}
+
+static int write_class(const char* dir, const Options* opts, int class_index) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/C%d.jack", dir, class_index);
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "jack_gen: could not write '%s'\n", path);
+        return 0;
+    }
+
+    fprintf(out, "// Generated by tools/jack_gen.c\n");
+    fprintf(out, "class C%d {\n", class_index);
+    fprintf(out, "    static int s;\n");
+    fprintf(out, "    field int value;\n\n");
+    fprintf(out, "    constructor C%d new(int v) {\n", class_index);
+    fprintf(out, "        let value = v;\n");
+    fprintf(out, "        return this;\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    method int get() {\n");
+    fprintf(out, "        return value;\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    method void dispose() {\n");
+    fprintf(out, "        do Memory.deAlloc(this);\n");
+    fprintf(out, "        return;\n");
+    fprintf(out, "    }\n\n");
+    for (int j = 0; j < opts->subroutines; ++j) {
+        write_function(out, opts, class_index, j);
+    }
+    fprintf(out, "}\n");
+    fclose(out);
+    return 1;
+}
+
+static int write_main(const char* dir, const Options* opts) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/Main.jack", dir);
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "jack_gen: could not write '%s'\n", path);
+        return 0;
+    }
+
+    fprintf(out, "// Generated by tools/jack_gen.c\n");
+    fprintf(out, "class Main {\n");
+    fprintf(out, "    function void main() {\n");
+    fprintf(out, "        var int result;\n");
+    fprintf(out, "        let result = 0;\n");
+    for (int i = 0; i < opts->classes; ++i) {
+        if (opts->subroutines > 0) {
+            fprintf(out, "        let result = result + C%d.f0(%d, %d);\n", i, i, random_below(100));
+        }
+    }
+    fprintf(out, "        do Output.printInt(result);\n");
+    fprintf(out, "        return;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "}\n");
+    fclose(out);
+    return 1;
+}
+
+static void print_usage(const char* prog) {
+    fprintf(stderr, "usage: %s [--classes N] [--subroutines N] [--locals N] [--depth N] [--strings N] [--calls N] "
+                    "[--comments N] [--seed N] <output dir>\n", prog);
+}
+
+int main(int argc, char** argv) {
+    Options opts = {
+        .classes = 100,
+        .subroutines = 20,
+        .locals = 8,
+        .depth = 3,
+        .strings = 2,
+        .calls = 4,
+        .comments = 0,
+        .seed = 1,
+    };
+    const char* dir = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        int* value = NULL;
+        if (strcmp(argv[i], "--classes") == 0) {
+            value = &opts.classes;
+        } else if (strcmp(argv[i], "--subroutines") == 0) {
+            value = &opts.subroutines;
+        } else if (strcmp(argv[i], "--locals") == 0) {
+            value = &opts.locals;
+        } else if (strcmp(argv[i], "--depth") == 0) {
+            value = &opts.depth;
+        } else if (strcmp(argv[i], "--strings") == 0) {
+            value = &opts.strings;
+        } else if (strcmp(argv[i], "--calls") == 0) {
+            value = &opts.calls;
+        } else if (strcmp(argv[i], "--comments") == 0) {
+            value = &opts.comments;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            opts.seed = strtoull(argv[++i], NULL, 10);
+            continue;
+        } else if (argv[i][0] != '-' && !dir) {
+            dir = argv[i];
+            continue;
+        }
+
+        if (!value || i + 1 >= argc) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        *value = atoi(argv[++i]);
+        if (*value < 0) {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!dir) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    // Every function needs l0
+    if (opts.locals < 1) {
+        opts.locals = 1;
+    }
+    rng_state = opts.seed ? opts.seed : 1;
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "jack_gen: could not create '%s'\n", dir);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < opts.classes; ++i) {
+        if (!write_class(dir, &opts, i)) {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!write_main(dir, &opts)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
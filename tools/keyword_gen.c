@@ -0,0 +1,129 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Build step turning keywords.def into a perfect hash table of the Jack keywords, included by token.c.
+ *
+ * usage: keyword_gen <output.h>
+ *
+ * The hash only looks at the length and the first and last characters of a lexeme :
+ *     (first * KEYWORD_HASH_FIRST + last * KEYWORD_HASH_LAST + len) & (KEYWORD_TABLE_SIZE - 1)
+ * The generator searches the smallest table and multipliers for which no two keywords collide, so
+ * classifying an identifier costs one hash and one compare.
+ */
+
+#define STRINGIFY(x) #x
+#define TOSTRING(x) STRINGIFY(x)
+#define PATH_TO_KEYWORD_DEF_FILE TOSTRING(DEF_FILES_DIR/keywords.def)
+
+#define MAX_TABLE_SIZE 256
+#define MAX_MULTIPLIER 64
+
+typedef struct {
+    const char* str;
+    const char* token_type;
+} Keyword;
+
+static const Keyword keywords[] = {
+#define KEYWORD(str_repr, token_type) {str_repr, #token_type},
+    #include PATH_TO_KEYWORD_DEF_FILE
+#undef KEYWORD
+};
+
+#define NUM_KEYWORDS (sizeof(keywords) / sizeof(keywords[0]))
+
+static unsigned keyword_hash(const char* str, unsigned first, unsigned last, unsigned size) {
+    size_t len = strlen(str);
+    return ((unsigned char) str[0] * first + (unsigned char) str[len - 1] * last + (unsigned) len) & (size - 1);
+}
+
+static int is_perfect(unsigned first, unsigned last, unsigned size) {
+    char used[MAX_TABLE_SIZE] = {0};
+    for (size_t i = 0; i < NUM_KEYWORDS; ++i) {
+        unsigned slot = keyword_hash(keywords[i].str, first, last, size);
+        if (used[slot]) {
+            return 0;
+        }
+        used[slot] = 1;
+    }
+    return 1;
+}
+
+/**
+ * Smallest power of two table first, then the smallest multipliers.
+ */
+static int find_perfect_hash(unsigned* size, unsigned* first, unsigned* last) {
+    unsigned min_size = 1;
+    while (min_size < NUM_KEYWORDS) {
+        min_size <<= 1;
+    }
+
+    for (unsigned s = min_size; s <= MAX_TABLE_SIZE; s <<= 1) {
+        for (unsigned f = 1; f <= MAX_MULTIPLIER; ++f) {
+            for (unsigned l = 0; l <= MAX_MULTIPLIER; ++l) {
+                if (is_perfect(f, l, s)) {
+                    *size = s;
+                    *first = f;
+                    *last = l;
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <output.h>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    unsigned size = 0;
+    unsigned first = 0;
+    unsigned last = 0;
+    if (!find_perfect_hash(&size, &first, &last)) {
+        fprintf(stderr, "keyword_gen: no perfect hash for the keywords of keywords.def\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t min_len = SIZE_MAX;
+    size_t max_len = 0;
+    for (size_t i = 0; i < NUM_KEYWORDS; ++i) {
+        size_t len = strlen(keywords[i].str);
+        min_len = len < min_len ? len : min_len;
+        max_len = len > max_len ? len : max_len;
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "keyword_gen: could not write '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "// Generated by tools/keyword_gen.c from keywords.def, do not edit\n");
+    fprintf(out, "#ifndef KEYWORD_TABLE_H\n#define KEYWORD_TABLE_H\n\n");
+    fprintf(out, "#define KEYWORD_MIN_LEN %zu\n", min_len);
+    fprintf(out, "#define KEYWORD_MAX_LEN %zu\n", max_len);
+    fprintf(out, "#define KEYWORD_TABLE_SIZE %u\n", size);
+    fprintf(out, "#define KEYWORD_HASH_FIRST %u\n", first);
+    fprintf(out, "#define KEYWORD_HASH_LAST %u\n", last);
+    fprintf(out, "#define KEYWORD_HASH(str, len) \\\n"
+                 "    (((unsigned char) (str)[0] * KEYWORD_HASH_FIRST + (unsigned char) (str)[(len) - 1] * KEYWORD_HASH_LAST \\\n"
+                 "      + (unsigned) (len)) & (KEYWORD_TABLE_SIZE - 1))\n\n");
+
+    fprintf(out, "static const TokenMapping keywordTable[KEYWORD_TABLE_SIZE] = {\n");
+    for (size_t i = 0; i < NUM_KEYWORDS; ++i) {
+        fprintf(out, "    [%u] = {\"%s\", %s},\n", keyword_hash(keywords[i].str, first, last, size), keywords[i].str,
+                keywords[i].token_type);
+    }
+    fprintf(out, "};\n\n#endif // KEYWORD_TABLE_H\n");
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "keyword_gen: could not write '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
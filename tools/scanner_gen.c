@@ -0,0 +1,237 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "refac_lexer.h"
+
+/**
+ * Build step compiling the lexer DFA of lexer_dfa.def and eq_classes.def into a direct coded scanner,
+ * included by refac_lexer.c.
+ *
+ * usage: scanner_gen <output.h>
+ *
+ * Every state becomes a label and every (state, equivalence class) pair a block of straight line code.
+ * What the table driven loop of `process_input_table` decides per character - whether a token ends,
+ * where the next one starts, whether a comment is entered, which state follows - is decided here once,
+ * so the generated blocks only keep the token pushes and end in a jump to the label of the next state.
+ * With LEXER_COMPUTED_GOTO the class of a character indexes a per state table of label addresses,
+ * otherwise a switch per state dispatches on it. The NUL blocks first ask `refill_input` whether they are
+ * only at the end of the window of a chunked lexer, or of the chunk of a parallel lexer. Blocks that push
+ * tokens suspend the scanner once `max_tokens` are pushed, it resumes at the label of the next state.
+ */
+
+static const int transition[NUM_STATES][NUM_EQ_CLASSES] = {
+#define LEXER_TRANSITION(from_state, eq_class, to_state) [from_state][eq_class] = to_state,
+#define LEXER_SKIP(state, run)
+    #include PATH_TO_DFA_DEF_FILE
+#undef LEXER_TRANSITION
+#undef LEXER_SKIP
+};
+
+static const char* skip_runs[NUM_STATES] = {
+#define LEXER_TRANSITION(from_state, eq_class, to_state)
+#define LEXER_SKIP(state, run) [state] = #run,
+    #include PATH_TO_DFA_DEF_FILE
+#undef LEXER_TRANSITION
+#undef LEXER_SKIP
+};
+
+#define NAME(x) [x] = #x
+
+static const char* state_names[NUM_STATES] = {
+    NAME(START), NAME(IN_ID), NAME(IN_NUM), NAME(IN_STRING), NAME(COMMENT_START), NAME(IN_COMMENT_SINGLE),
+    NAME(IN_COMMENT_MULTI), NAME(SEEN_STAR_IN_COMMENT), NAME(IN_SYMBOL), NAME(IN_ERROR),
+};
+
+static const char* class_names[NUM_EQ_CLASSES] = {
+    NAME(C_white), NAME(C_newline), NAME(C_alpha), NAME(C_digit), NAME(C_double_quote),
+    NAME(C_slash), NAME(C_star), NAME(C_symbol), NAME(C_other), NAME(C_eof),
+};
+
+static bool is_comment(int state) {
+    return state >= IN_COMMENT_SINGLE && state <= SEEN_STAR_IN_COMMENT;
+}
+
+/**
+ * Classes of all 256 byte values. Bytes outside of ASCII are C_other.
+ */
+static void build_eq_classes(int classes[256]) {
+    for (int i = 0; i < 256; ++i) {
+        classes[i] = C_other;
+    }
+#define EQ_CLASS_DEF_RANGE(start_char, end_char, class_val) \
+    for (int c = start_char; c <= end_char; ++c) {            \
+        classes[c] = class_val;                               \
+    }
+#define EQ_CLASS_DEF_SINGLE(char_val, class_val) classes[(unsigned char) (char_val)] = class_val;
+    #include PATH_TO_EQ_DEF_FILE
+#undef EQ_CLASS_DEF_RANGE
+#undef EQ_CLASS_DEF_SINGLE
+}
+
+static void emit_dispatch(FILE* out, int state) {
+    fprintf(out, "#if LEXER_COMPUTED_GOTO\n");
+    fprintf(out, "    goto *%s_targets[direct_eq_classes[(unsigned char) c]];\n", state_names[state]);
+    fprintf(out, "#else\n");
+    fprintf(out, "    switch (direct_eq_classes[(unsigned char) c]) {\n");
+    for (int cls = 0; cls < NUM_EQ_CLASSES; ++cls) {
+        fprintf(out, "        case %s: goto %s_%s;\n", class_names[cls], state_names[state], class_names[cls]);
+    }
+    fprintf(out, "    }\n#endif\n");
+}
+
+/**
+ * The block for `state` reading a character of `cls`, the same steps as one iteration of
+ * `process_input_table` with every condition on the states and the class folded.
+ */
+static void emit_transition(FILE* out, int state, int cls) {
+    int next = transition[state][cls];
+    bool in_comment = is_comment(next);
+
+    fprintf(out, "%s_%s:\n", state_names[state], class_names[cls]);
+    if (cls == C_eof) {
+        // The NUL may only end the window of a chunked lexer, then the same state goes on in the next one,
+        // or the chunk of a parallel lexer
+        bool holds_token = state_holds_token(state);
+        fprintf(out, "    if ((shift = refill_input(lexer, pos, %s, %s)) != NO_REFILL) {\n",
+                holds_token ? "token_start" : "pos", state_names[state]);
+        fprintf(out, "        if (shift == END_OF_CHUNK) {\n            goto done;\n        }\n");
+        fprintf(out, "        input = lexer->input;\n");
+        fprintf(out, "        pos -= shift;\n");
+        if (holds_token) {
+            fprintf(out, "        token_start -= shift;\n");
+        }
+        fprintf(out, "        goto %s;\n    }\n", state_names[state]);
+    }
+    if (cls == C_newline) {
+        fprintf(out, "    line++;\n");
+    }
+
+    bool pushes = false;
+    if (!is_comment(state) && next != state && !in_comment) {
+        if (state != START && state != IN_SYMBOL) {
+            pushes = true;
+            if (state == IN_STRING && next == START) {
+                fprintf(out, "    create_token(lexer, %s, token_start + 1, pos - token_start - 1, line);\n",
+                        state_names[state]);
+            } else {
+                fprintf(out, "    create_token(lexer, %s, token_start, pos - token_start, line);\n",
+                        state_names[state]);
+            }
+            fprintf(out, "    token_count++;\n");
+        }
+        if (state == START || state == COMMENT_START) {
+            fprintf(out, "    token_start = pos;\n");
+        }
+    }
+
+    if ((cls == C_symbol || cls == C_star) && next != IN_STRING && !in_comment) {
+        pushes = true;
+        fprintf(out, "    create_token(lexer, IN_SYMBOL, pos, 1, line);\n");
+        fprintf(out, "    token_count++;\n");
+        fprintf(out, "    token_start = pos + 1;\n");
+    }
+
+    if (next == IN_ERROR) {
+        fprintf(out, "    lexer->position = pos;\n");
+        fprintf(out, "    return lexer_error(lexer, %s, c, line, __func__);\n", state_names[state]);
+        return;
+    }
+
+    if (pushes && cls != C_eof) {
+        fprintf(out, "    if (token_count >= max_tokens) {\n");
+        fprintf(out, "        resume_state = %s;\n        goto suspend;\n    }\n", state_names[next]);
+    }
+    fprintf(out, "    pos++;\n");
+    fprintf(out, "    goto %s;\n", cls == C_eof ? "done" : state_names[next]);
+}
+
+static void emit_state(FILE* out, int state) {
+    fprintf(out, "\n%s:\n", state_names[state]);
+    if (skip_runs[state] != NULL) {
+        fprintf(out, "    pos = scan_%s(input, pos);\n", skip_runs[state]);
+    }
+    fprintf(out, "    c = input[pos];\n");
+    emit_dispatch(out, state);
+    for (int cls = 0; cls < NUM_EQ_CLASSES; ++cls) {
+        emit_transition(out, state, cls);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <output.h>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "scanner_gen: could not write '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    int classes[256];
+    build_eq_classes(classes);
+
+    fprintf(out, "// Generated by tools/scanner_gen.c from lexer_dfa.def and eq_classes.def, do not edit\n");
+    fprintf(out, "#ifndef LEXER_DIRECT_H\n#define LEXER_DIRECT_H\n\n");
+
+    fprintf(out, "static const unsigned char direct_eq_classes[256] = {");
+    for (int i = 0; i < 256; ++i) {
+        fprintf(out, "%s%d,", i % 16 == 0 ? "\n    " : " ", classes[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    // Labels share the names of the states, they live in a namespace of their own
+    fprintf(out, "static ErrorCode process_input_direct(Lexer *lexer) {\n");
+    fprintf(out, "    const char *input = lexer->input;\n");
+    fprintf(out, "    size_t pos = lexer->position;\n");
+    fprintf(out, "    size_t token_start = lexer->token_start;\n");
+    fprintf(out, "    int line = lexer->line;\n");
+    fprintf(out, "    int token_count = 0;\n");
+    fprintf(out, "    const int max_tokens = lexer->max_tokens;\n");
+    fprintf(out, "    int resume_state;\n");
+    fprintf(out, "    size_t shift;\n");
+    fprintf(out, "    char c;\n");
+
+    fprintf(out, "#if LEXER_COMPUTED_GOTO\n");
+    for (int state = START; state < IN_ERROR; ++state) {
+        fprintf(out, "    static void *const %s_targets[NUM_EQ_CLASSES] = {", state_names[state]);
+        for (int cls = 0; cls < NUM_EQ_CLASSES; ++cls) {
+            fprintf(out, "%s&&%s_%s", cls ? ", " : "", state_names[state], class_names[cls]);
+        }
+        fprintf(out, "};\n");
+    }
+    fprintf(out, "#endif\n");
+
+    // Resume in the state the last run stopped in, START is entered by falling through
+    fprintf(out, "    switch (lexer->state) {\n");
+    for (int state = START + 1; state < IN_ERROR; ++state) {
+        fprintf(out, "        case %s: goto %s;\n", state_names[state], state_names[state]);
+    }
+    fprintf(out, "        default: break;\n    }\n");
+
+    // IN_ERROR is the last state and is never entered, the transitions into it return
+    for (int state = START; state < IN_ERROR; ++state) {
+        emit_state(out, state);
+    }
+
+    fprintf(out, "\nsuspend:\n");
+    fprintf(out, "    lexer->state = resume_state;\n");
+    fprintf(out, "    lexer->token_start = token_start;\n");
+    fprintf(out, "    lexer->line = line;\n");
+    fprintf(out, "    lexer->position = pos + 1;\n");
+    fprintf(out, "    lexer->suspended = true;\n");
+    fprintf(out, "    return ERROR_NONE;\n");
+
+    fprintf(out, "\ndone:\n");
+    fprintf(out, "    lexer->position = pos;\n");
+    fprintf(out, "    log_message(LOG_LEVEL_DEBUG, ERROR_NONE, \"Lexer processed %%d tokens\\n\", token_count);\n");
+    fprintf(out, "    return ERROR_NONE;\n");
+    fprintf(out, "}\n\n#endif // LEXER_DIRECT_H\n");
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "scanner_gen: could not write '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
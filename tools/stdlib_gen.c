@@ -0,0 +1,149 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+
+/**
+ * Build step turning stdlib.json into the C table declared in stdlib_table.h.
+ *
+ * usage: stdlib_gen <stdlib.json> <output.c>
+ */
+
+static char* read_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* data = malloc((size_t) size + 1);
+    *length = fread(data, 1, (size_t) size, file);
+    data[*length] = '\0';
+    fclose(file);
+    return data;
+}
+
+static uint64_t fnv1a(const char* data, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (unsigned char) data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static const char* get_string(const cJSON* object, const char* key) {
+    const cJSON* item = cJSON_GetObjectItem(object, key);
+    if (!cJSON_IsString(item)) {
+        fprintf(stderr, "stdlib_gen: expected string field '%s'\n", key);
+        exit(EXIT_FAILURE);
+    }
+    for (const char* c = item->valuestring; *c; ++c) {
+        if (*c == '"' || *c == '\\' || (unsigned char) *c < ' ') {
+            fprintf(stderr, "stdlib_gen: invalid character in '%s'\n", item->valuestring);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return item->valuestring;
+}
+
+static const char* get_kind(const cJSON* function) {
+    const char* kind = get_string(function, "kind");
+    if (strcmp(kind, "KIND_FUNCTION") != 0 && strcmp(kind, "KIND_METHOD") != 0
+        && strcmp(kind, "KIND_CONSTRUCTOR") != 0) {
+        fprintf(stderr, "stdlib_gen: invalid kind '%s'\n", kind);
+        exit(EXIT_FAILURE);
+    }
+    return kind;
+}
+
+// Functions and methods are one list, functions first
+static int num_subroutines(const cJSON* class_item) {
+    return cJSON_GetArraySize(cJSON_GetObjectItem(class_item, "functions"))
+         + cJSON_GetArraySize(cJSON_GetObjectItem(class_item, "methods"));
+}
+
+static const cJSON* get_subroutine(const cJSON* class_item, int index) {
+    int num_functions = cJSON_GetArraySize(cJSON_GetObjectItem(class_item, "functions"));
+    return index < num_functions ? cJSON_GetArrayItem(cJSON_GetObjectItem(class_item, "functions"), index)
+                                 : cJSON_GetArrayItem(cJSON_GetObjectItem(class_item, "methods"), index - num_functions);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <stdlib.json> <output.c>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t length = 0;
+    char* json = read_file(argv[1], &length);
+    cJSON* root = json ? cJSON_Parse(json) : NULL;
+    if (!cJSON_IsArray(root)) {
+        fprintf(stderr, "stdlib_gen: could not parse '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "stdlib_gen: could not write '%s'\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "// Generated from stdlib.json by tools/stdlib_gen.c, do not edit.\n");
+    fprintf(out, "#include \"stdlib_table.h\"\n\n");
+
+    int num_classes = cJSON_GetArraySize(root);
+    for (int c = 0; c < num_classes; ++c) {
+        const cJSON* class_item = cJSON_GetArrayItem(root, c);
+        for (int f = 0; f < num_subroutines(class_item); ++f) {
+            const cJSON* params = cJSON_GetObjectItem(get_subroutine(class_item, f), "parameters");
+            if (cJSON_GetArraySize(params) == 0) {
+                continue;
+            }
+            fprintf(out, "static const ParameterInfo params_%d_%d[] = {\n", c, f);
+            const cJSON* param = NULL;
+            cJSON_ArrayForEach(param, params) {
+                fprintf(out, "    {\"%s\", \"%s\"},\n", get_string(param, "name"), get_string(param, "type"));
+            }
+            fprintf(out, "};\n");
+        }
+
+        if (num_subroutines(class_item) == 0) {
+            continue;
+        }
+        fprintf(out, "\nstatic const FunctionInfo functions_%d[] = {\n", c);
+        for (int f = 0; f < num_subroutines(class_item); ++f) {
+            const cJSON* function = get_subroutine(class_item, f);
+            int num_params = cJSON_GetArraySize(cJSON_GetObjectItem(function, "parameters"));
+            fprintf(out, "    {\"%s\", \"%s\", %s, ", get_string(function, "name"),
+                    get_string(function, "return_type"), get_kind(function));
+            if (num_params > 0) {
+                fprintf(out, "params_%d_%d, %d},\n", c, f, num_params);
+            } else {
+                fprintf(out, "NULL, 0},\n");
+            }
+        }
+        fprintf(out, "};\n\n");
+    }
+
+    fprintf(out, "const ClassInfo stdlib_classes[] = {\n");
+    for (int c = 0; c < num_classes; ++c) {
+        const cJSON* class_item = cJSON_GetArrayItem(root, c);
+        if (num_subroutines(class_item) > 0) {
+            fprintf(out, "    {\"%s\", functions_%d, %d},\n", get_string(class_item, "name"), c, num_subroutines(class_item));
+        } else {
+            fprintf(out, "    {\"%s\", NULL, 0},\n", get_string(class_item, "name"));
+        }
+    }
+    fprintf(out, "};\n\n");
+    fprintf(out, "const int stdlib_num_classes = %d;\n", num_classes);
+    fprintf(out, "const uint64_t stdlib_hash = 0x%016llxULL;\n", (unsigned long long) fnv1a(json, length));
+
+    fclose(out);
+    cJSON_Delete(root);
+    free(json);
+    return EXIT_SUCCESS;
+}